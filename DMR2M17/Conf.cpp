@@ -33,7 +33,8 @@ enum SECTION {
   SECTION_M17_NETWORK,
   SECTION_DMR_NETWORK,
   SECTION_DMRID_LOOKUP,
-  SECTION_LOG
+  SECTION_LOG,
+  SECTION_METRICS
 };
 
 CConf::CConf(const std::string& file) :
@@ -53,13 +54,18 @@ m_m17DstPort(0U),
 m_m17LocalAddress(),
 m_m17LocalPort(0U),
 m_m17GainAdjDb(),
+m_m17AGC(false),
 m_m17NetworkDebug(false),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
 m_logFilePath(),
-m_logFileRoot()
+m_logFileRoot(),
+m_metricsEnabled(false),
+m_metricsAddress("127.0.0.1"),
+m_metricsPort(9102U),
+m_metricsSummaryTime(0U)
 {
 }
 
@@ -91,6 +97,8 @@ bool CConf::read()
 		  section = SECTION_DMRID_LOOKUP;
 	  else if (::strncmp(buffer, "[Log]", 5U) == 0)
 		  section = SECTION_LOG;
+	  else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+		  section = SECTION_METRICS;
 	  else
         section = SECTION_NONE;
 
@@ -129,6 +137,8 @@ bool CConf::read()
 			m_m17DstPort = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "GainAdjustdB") == 0)
 			m_m17GainAdjDb = value;
+		else if (::strcmp(key, "AGC") == 0)
+			m_m17AGC = ::atoi(value) == 1;
 		else if (::strcmp(key, "Debug") == 0)
 			m_m17NetworkDebug = ::atoi(value) == 1;
 	} else if (section == SECTION_DMR_NETWORK) {
@@ -158,6 +168,15 @@ bool CConf::read()
 			m_logFileLevel = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "DisplayLevel") == 0)
 			m_logDisplayLevel = (unsigned int)::atoi(value);
+	} else if (section == SECTION_METRICS) {
+		if (::strcmp(key, "Enable") == 0)
+			m_metricsEnabled = ::atoi(value) == 1;
+		else if (::strcmp(key, "Address") == 0)
+			m_metricsAddress = value;
+		else if (::strcmp(key, "Port") == 0)
+			m_metricsPort = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "SummaryTime") == 0)
+			m_metricsSummaryTime = (unsigned int)::atoi(value);
 	}
   }
 
@@ -201,6 +220,11 @@ std::string CConf::getM17GainAdjDb() const
 	return m_m17GainAdjDb;
 }
 
+bool CConf::getM17AGC() const
+{
+	return m_m17AGC;
+}
+
 bool CConf::getM17NetworkDebug() const
 {
 	return m_m17NetworkDebug;
@@ -270,3 +294,23 @@ std::string CConf::getLogFileRoot() const
 {
   return m_logFileRoot;
 }
+
+bool CConf::getMetricsEnabled() const
+{
+  return m_metricsEnabled;
+}
+
+std::string CConf::getMetricsAddress() const
+{
+  return m_metricsAddress;
+}
+
+unsigned int CConf::getMetricsPort() const
+{
+  return m_metricsPort;
+}
+
+unsigned int CConf::getMetricsSummaryTime() const
+{
+  return m_metricsSummaryTime;
+}
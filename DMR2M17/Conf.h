@@ -42,6 +42,7 @@ public:
   std::string  getM17LocalAddress() const;
   unsigned int getM17LocalPort() const;
   std::string  getM17GainAdjDb() const;
+  bool         getM17AGC() const;
   bool         getM17NetworkDebug() const;
   
   // The DMR Network section
@@ -62,6 +63,12 @@ public:
   std::string  getLogFilePath() const;
   std::string  getLogFileRoot() const;
 
+  // The Metrics section
+  bool         getMetricsEnabled() const;
+  std::string  getMetricsAddress() const;
+  unsigned int getMetricsPort() const;
+  unsigned int getMetricsSummaryTime() const;
+
 private:
   std::string  m_file;
   std::string  m_callsign;
@@ -81,6 +88,7 @@ private:
   std::string  m_m17LocalAddress;
   unsigned int m_m17LocalPort;
   std::string  m_m17GainAdjDb;
+  bool         m_m17AGC;
   bool         m_m17NetworkDebug;
 
   std::string  m_dmrIdLookupFile;
@@ -91,6 +99,11 @@ private:
   std::string  m_logFilePath;
   std::string  m_logFileRoot;
 
+  bool         m_metricsEnabled;
+  std::string  m_metricsAddress;
+  unsigned int m_metricsPort;
+  unsigned int m_metricsSummaryTime;
+
 };
 
 #endif
@@ -134,6 +134,8 @@ m_conf(configFile),
 m_dmrNetwork(NULL),
 m_m17Network(NULL),
 m_dmrlookup(NULL),
+m_m17Identities(),
+m_dmrIdentities(),
 m_conv(),
 m_colorcode(1U),
 m_dstid(1U),
@@ -150,7 +152,14 @@ m_EmbeddedLC(),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
 m_config(NULL),
-m_configLen(0U)
+m_configLen(0U),
+m_metrics(NULL),
+m_m17Queue(NULL),
+m_dmrQueue(NULL),
+m_m17ConvertTime(NULL),
+m_dmrConvertTime(NULL),
+m_profiler(NULL),
+m_networkStage(0U)
 {
 	m_m17Frame = new unsigned char[100U];
 	m_dmrFrame  = new unsigned char[50U];
@@ -262,6 +271,7 @@ int CDMR2M17::run()
 	bool m17_debug               = m_conf.getM17NetworkDebug();
 	
 	m_conv.setM17GainAdjDb(m_conf.getM17GainAdjDb());
+	m_conv.setM17AGC(m_conf.getM17AGC());
 	
 	uint16_t streamid = 0;
 	unsigned char m17_src[10];
@@ -281,8 +291,10 @@ int CDMR2M17::run()
 	}
 	
 	ret = createMMDVM();
-	if (!ret)
+	if (!ret) {
+		::LogFinalise();
 		return 1;
+	}
 
 	LogMessage("Waiting for MMDVM to connect.....");
 
@@ -299,6 +311,7 @@ int CDMR2M17::run()
 	if (m_killed) {
 		m_dmrNetwork->close();
 		delete m_dmrNetwork;
+		::LogFinalise();
 		return 0;
 	}
 
@@ -310,6 +323,8 @@ int CDMR2M17::run()
 	m_dmrlookup = new CDMRLookup(lookupFile, reloadTime);
 	m_dmrlookup->read();
 
+	createMetrics();
+
 	m_dmrflco = FLCO_GROUP;
 
 	CTimer networkWatchdog(100U, 0U, 1500U);
@@ -376,7 +391,9 @@ int CDMR2M17::run()
 				buffer[34] = m17_cnt >> 8;
 				buffer[35] = m17_cnt & 0xff;
 				memcpy(buffer+36, m_m17Frame, 16);
+				m_profiler->begin(m_networkStage);
 				m_m17Network->writeData(buffer, 54U);
+				m_profiler->end(m_networkStage);
 				m17Watch.start();
 			}
 			else if(m17FrameType == TAG_DATA) {
@@ -421,18 +438,32 @@ int CDMR2M17::run()
 					m_conv.putM17EOT();
 				}
 				else{
+					unsigned long long start = CMetrics::getMicroseconds();
 					m_conv.putM17(m_m17Frame);
+					m_m17ConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
+				}
+				// The stream id and the encoded source identify the caller for the whole stream
+				unsigned int streamId = (m_m17Frame[4U] << 8) | m_m17Frame[5U];
+
+				CIdentity identity;
+				if (!m_m17Identities.find(streamId, m_m17Frame + 12U, 6U, identity)) {
+					uint8_t cs[10];
+					memcpy(cs, m_m17Frame+12, 6);
+					decode_callsign(cs);
+					std::string css((char *)cs);
+					css = css.substr(0, css.find(' '));
+
+					identity.m_id = m_dmrlookup->findID(css);
+					m_m17Identities.add(streamId, m_m17Frame + 12U, 6U, identity);
 				}
-				uint8_t cs[10];
-				memcpy(cs, m_m17Frame+12, 6);
-				decode_callsign(cs);
-				std::string css((char *)cs);
-				css = css.substr(0, css.find(' '));
-				 
-				int dmrid = m_dmrlookup->findID(css);
-				if(dmrid){
-					m_dmrSrc = dmrid;
+
+				if(identity.m_id){
+					m_dmrSrc = identity.m_id;
 				}
+
+				if (m_m17Frame[34U] & 0x80U)
+					m_m17Identities.remove(streamId);
+
 				m_m17Frames++;
 			}
 		}
@@ -586,7 +617,9 @@ int CDMR2M17::run()
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
+				m_profiler->begin(m_networkStage);
 				m_dmrNetwork->write(rx_dmrdata);
+				m_profiler->end(m_networkStage);
 
 				dmr_cnt++;
 				dmrWatch.start();
@@ -597,12 +630,25 @@ int CDMR2M17::run()
 			m_dmrSrc = tx_dmrdata.getSrcId();
 			m_dmrDst = tx_dmrdata.getDstId();
 			
-			memset(m17_src, 0, 10);
-			std::string css = m_dmrlookup->findCS(m_dmrSrc);
-			memcpy(m17_src, css.c_str(), css.size());
-			m17_src[css.size()] = ' ';
-			m17_src[css.size()+1] = 'D';
-			encode_callsign(m17_src);
+			unsigned char source[3U];
+			source[0U] = m_dmrSrc >> 16;
+			source[1U] = m_dmrSrc >> 8;
+			source[2U] = m_dmrSrc >> 0;
+
+			CIdentity identity;
+			if (!m_dmrIdentities.find(tx_dmrdata.getStreamId(), source, 3U, identity)) {
+				memset(m17_src, 0, 10);
+				std::string css = m_dmrlookup->findCS(m_dmrSrc);
+				memcpy(m17_src, css.c_str(), css.size());
+				m17_src[css.size()] = ' ';
+				m17_src[css.size()+1] = 'D';
+				encode_callsign(m17_src);
+
+				memcpy(identity.m_encoded, m17_src, 10);
+				m_dmrIdentities.add(tx_dmrdata.getStreamId(), source, 3U, identity);
+			} else {
+				memcpy(m17_src, identity.m_encoded, 10);
+			}
 			//fprintf(stderr, "M17 Callsign info %s : %s : %d\n", m17_src, css.c_str(), m_dmrSrc);
 			
 			FLCO netflco = tx_dmrdata.getFLCO();
@@ -611,6 +657,9 @@ int CDMR2M17::run()
 			if (!tx_dmrdata.isMissing()) {
 				networkWatchdog.start();
 
+				if (DataType == DT_TERMINATOR_WITH_LC)
+					m_dmrIdentities.remove(tx_dmrdata.getStreamId());
+
 				if(DataType == DT_TERMINATOR_WITH_LC && m_dmrFrames > 0U) {
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
@@ -635,7 +684,9 @@ int CDMR2M17::run()
 				if(DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
 					unsigned char dmr_frame[50];
 					tx_dmrdata.getData(dmr_frame);
+					unsigned long long start = CMetrics::getMicroseconds();
 					m_conv.putDMR(dmr_frame);
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 			}
@@ -654,7 +705,9 @@ int CDMR2M17::run()
 						m_dmrinfo = true;
 					}
 
+					unsigned long long start = CMetrics::getMicroseconds();
 					m_conv.putDMR(dmr_frame);
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 
@@ -672,7 +725,15 @@ int CDMR2M17::run()
 
 		stopWatch.start();
 
+		m_profiler->begin(m_networkStage);
 		m_dmrNetwork->clock(ms);
+		m_profiler->end(m_networkStage);
+
+		m_m17Queue->set(m_conv.getM17Depth());
+		m_dmrQueue->set(m_conv.getDMRDepth());
+
+		m_profiler->clock(ms);
+
 		pollTimer.clock(ms);
 		if (pollTimer.isRunning() && pollTimer.hasExpired()) {
 			m_m17Network->writePoll();
@@ -682,16 +743,53 @@ int CDMR2M17::run()
 		if (ms < 5U) CThread::sleep(5U);
 	}
 
+	// The metrics refer to the networks
+	m_metrics->stop();
+
 	m_m17Network->close();
 	m_dmrNetwork->close();
 	delete m_dmrNetwork;
 	delete m_m17Network;
 
+	delete m_metrics;
+	delete m_profiler;
+
+	LogMessage("Identity cache, M17 sources: %u hits, %u misses, DMR sources: %u hits, %u misses", m_m17Identities.getHits(), m_m17Identities.getMisses(), m_dmrIdentities.getHits(), m_dmrIdentities.getMisses());
+
 	::LogFinalise();
 
 	return 0;
 }
 
+void CDMR2M17::createMetrics()
+{
+	m_metrics = new CMetrics("dmr2m17_");
+
+	// The stages are only measured when the metrics are served or summarised in the log
+	m_profiler     = new CProfiler(m_conf.getMetricsEnabled() || m_conf.getMetricsSummaryTime() > 0U, m_conf.getMetricsSummaryTime());
+	m_networkStage = m_profiler->addStage("network");
+	m_conv.setProfiler(m_profiler);
+
+	m_metrics->addCounter("packets_total{network=\"M17\",direction=\"in\"}", "Data packets through each network", m_m17Network->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"M17\",direction=\"out\"}", "Data packets through each network", m_m17Network->getPacketsOut());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"in\"}", "Data packets through each network", m_dmrNetwork->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"out\"}", "Data packets through each network", m_dmrNetwork->getPacketsOut());
+
+	m_m17ConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"M17-DMR\"}", "Time taken to convert a voice frame, including the vocoders, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+	m_dmrConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"DMR-M17\"}", "Time taken to convert a voice frame, including the vocoders, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+
+	m_m17Queue = m_metrics->addGauge("queue_frames{queue=\"M17\"}", "Frames waiting in the converter");
+	m_dmrQueue = m_metrics->addGauge("queue_frames{queue=\"DMR\"}", "Frames waiting in the converter");
+
+	m_metrics->addCounter("lookups_total{result=\"hit\"}", "DMR Id lookups", m_dmrlookup->getHits());
+	m_metrics->addCounter("lookups_total{result=\"miss\"}", "DMR Id lookups", m_dmrlookup->getMisses());
+
+	m_profiler->addMetrics(m_metrics);
+
+	if (m_conf.getMetricsEnabled())
+		m_metrics->open(m_conf.getMetricsAddress(), m_conf.getMetricsPort());
+}
+
 bool CDMR2M17::createMMDVM()
 {
 	std::string rptAddress   = m_conf.getDMRRptAddress();
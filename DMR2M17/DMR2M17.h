@@ -29,7 +29,10 @@
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
+#include "IdentityCache.h"
 #include "M17Network.h"
+#include "Metrics.h"
+#include "Profiler.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
 #include "Version.h"
@@ -58,6 +61,8 @@ private:
 	CMMDVMNetwork*   m_dmrNetwork;
 	CM17Network*     m_m17Network;
 	CDMRLookup*      m_dmrlookup;
+	CIdentityCache   m_m17Identities;
+	CIdentityCache   m_dmrIdentities;
 	CModeConv        m_conv;
 	unsigned int     m_colorcode;
 	unsigned int     m_dstid;
@@ -75,9 +80,17 @@ private:
 	bool             m_dmrinfo;
 	unsigned char*   m_config;
 	unsigned int     m_configLen;
+	CMetrics*        m_metrics;
+	CMetricGauge*    m_m17Queue;
+	CMetricGauge*    m_dmrQueue;
+	CMetricHistogram* m_m17ConvertTime;
+	CMetricHistogram* m_dmrConvertTime;
+	CProfiler*       m_profiler;
+	unsigned int     m_networkStage;
 
 	unsigned int truncID(unsigned int id);
 	bool createMMDVM();
+	void createMetrics();
 
 };
 
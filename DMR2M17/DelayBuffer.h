@@ -39,6 +39,12 @@ public:
 
 	void clock(unsigned int ms);
 
+	// The number of blocks waiting
+	unsigned int getDepth() const;
+
+	// When the block last returned by getData() was added, zero for a missing block
+	unsigned long long getAdded() const;
+
 private:
 	std::string  m_name;
 	unsigned int m_blockSize;
@@ -48,6 +54,8 @@ private:
 	CStopWatch   m_stopWatch;
 	bool         m_running;
 	CRingBuffer<unsigned char> m_buffer;
+	CRingBuffer<unsigned long long> m_times;
+	unsigned long long m_added;
 	unsigned int m_outputCount;
 
 	unsigned char* m_lastData;
@@ -0,0 +1,72 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef	IdentityCache_H
+#define	IdentityCache_H
+
+#include <string>
+
+const unsigned int IDENTITY_SOURCE_LENGTH  = 16U;
+const unsigned int IDENTITY_ENCODED_LENGTH = 10U;
+
+// What a source resolved to, the fields used depend on the bridge
+class CIdentity {
+public:
+	CIdentity();
+
+	unsigned int  m_id;
+	std::string   m_callsign;
+	unsigned char m_encoded[IDENTITY_ENCODED_LENGTH];	// The source as sent to the other mode
+};
+
+// Remembers who is behind a stream, so that the Id and callsign lookups are done
+// once per call rather than for every frame. An entry is keyed on the stream id and
+// the source exactly as received, a new call never matches an older entry because
+// either the stream id or the source differs.
+class CIdentityCache {
+public:
+	CIdentityCache(unsigned int size = 4U);
+	~CIdentityCache();
+
+	bool find(unsigned int stream, const unsigned char* source, unsigned int length, CIdentity& identity);
+	void add(unsigned int stream, const unsigned char* source, unsigned int length, const CIdentity& identity);
+
+	// At the end of a stream
+	void remove(unsigned int stream);
+
+	unsigned int getHits() const;
+	unsigned int getMisses() const;
+
+private:
+	struct CIdentityEntry {
+		bool          m_valid;
+		unsigned int  m_stream;
+		unsigned char m_source[IDENTITY_SOURCE_LENGTH];
+		unsigned int  m_length;
+		unsigned int  m_used;
+		CIdentity     m_identity;
+	};
+
+	CIdentityEntry* m_entries;
+	unsigned int    m_size;
+	unsigned int    m_count;
+	unsigned int    m_hits;
+	unsigned int    m_misses;
+};
+
+#endif
@@ -30,7 +30,9 @@ m_address(),
 m_port(gatewayPort),
 //m_socket(localAddress, localPort),
 m_socket(localPort),
-m_debug(debug)
+m_debug(debug),
+m_packetsIn(0U),
+m_packetsOut(0U)
 {
 	memcpy(m_callsign, callsign, 6);
 	m_address = CUDPSocket::lookup(gatewayAddress);
@@ -55,6 +57,8 @@ bool CM17Network::writeData(const unsigned char* data, unsigned int length)
 	if (m_debug)
 		CUtils::dump(1U, "M17 Network Data Sent", data, length);
 
+	m_packetsOut.fetch_add(1U, std::memory_order_relaxed);
+
 	return m_socket.write(data, length, m_address, m_port);
 }
 
@@ -118,6 +122,8 @@ unsigned int CM17Network::readData(unsigned char* data, unsigned int length)
 	if (m_debug)
 		CUtils::dump(1U, "M17 Network Data Received", data, len);
 
+	m_packetsIn.fetch_add(1U, std::memory_order_relaxed);
+
 	return len;
 }
 
@@ -127,3 +133,13 @@ void CM17Network::close()
 
 	LogInfo("Closing P25 network connection");
 }
+
+const std::atomic<unsigned long long>& CM17Network::getPacketsIn() const
+{
+	return m_packetsIn;
+}
+
+const std::atomic<unsigned long long>& CM17Network::getPacketsOut() const
+{
+	return m_packetsOut;
+}
@@ -23,6 +23,7 @@
 
 #include <cstdint>
 #include <string>
+#include <atomic>
 
 class CM17Network {
 public:
@@ -36,12 +37,19 @@ public:
 	bool writeLink(char m);
 	bool writeUnlink();
 	void close();
+
+	// Data frames through the network, for the metrics
+	const std::atomic<unsigned long long>& getPacketsIn() const;
+	const std::atomic<unsigned long long>& getPacketsOut() const;
+
 private:
 	in_addr      m_address;
 	unsigned int m_port;
 	CUDPSocket   m_socket;
 	bool         m_debug;
 	unsigned char  m_callsign[6];
+	std::atomic<unsigned long long> m_packetsIn;
+	std::atomic<unsigned long long> m_packetsOut;
 };
 
 #endif
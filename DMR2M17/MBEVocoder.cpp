@@ -18,7 +18,9 @@
 *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 #include <cstring>
+#if !defined(NATIVE_AMBE)
 #include <md380_vocoder.h>
+#endif
 #include "MBEVocoder.h"
 
 
@@ -31,17 +33,38 @@ MBEVocoder::MBEVocoder(void)
 	m_mbeenc = new MBEEncoder();
 	m_mbeenc->set_dmr_mode();
 	m_mbeenc->set_gain_adjust(2.5);
+#if defined(NATIVE_AMBE)
+	m_mbeenc49 = new MBEEncoder();
+	m_mbeenc49->set_49bit_mode();
+	m_mbeenc49->set_gain_adjust(2.5);
+	m_mbedec = new MBEDecoder();
+#else
 	md380_init();
+#endif
 }
 
 void MBEVocoder::decode_2450(int16_t *pcm, uint8_t *ambe49)
 {
+#if defined(NATIVE_AMBE)
+	m_mbedec->decode(pcm, ambe49);
+#else
 	md380_decode(ambe49, pcm);
+#endif
 }
 
 void MBEVocoder::encode_2450(int16_t *pcm, uint8_t *ambe49)
 {
+#if defined(NATIVE_AMBE)
+	uint8_t bits[72U];
+	::memset(bits, 0, sizeof(bits));
+	m_mbeenc49->encode(pcm, bits);
+
+	::memset(ambe49, 0, 7U);
+	for (unsigned int i = 0U; i < 49U; i++)
+		WRITE_BIT8(ambe49, i, bits[i]);
+#else
 	md380_encode(ambe49, pcm);
+#endif
 }
 
 void MBEVocoder::encode_dmr(int16_t *pcm, uint8_t *ambe)
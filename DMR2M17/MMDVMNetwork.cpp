@@ -46,7 +46,9 @@ m_configLen(0U),
 m_positionData(NULL),
 m_positionLen(0U),
 m_talkerAliasData(NULL),
-m_talkerAliasLen(0U)
+m_talkerAliasLen(0U),
+m_packetsIn(0U),
+m_packetsOut(0U)
 {
 	assert(!rptAddress.empty());
 	assert(rptPort > 0U);
@@ -158,6 +160,8 @@ bool CMMDVMNetwork::read(CDMRData& data)
 		data.setN(n);
 	}
 
+	m_packetsIn.fetch_add(1U, std::memory_order_relaxed);
+
 	return true;
 }
 
@@ -215,6 +219,8 @@ bool CMMDVMNetwork::write(const CDMRData& data)
 
 	m_socket.write(buffer, HOMEBREW_DATA_PACKET_LENGTH, m_rptAddress, m_rptPort);
 
+	m_packetsOut.fetch_add(1U, std::memory_order_relaxed);
+
 	return true;
 }
 
@@ -340,3 +346,13 @@ void CMMDVMNetwork::clock(unsigned int ms)
 		}
 	}
 }
+
+const std::atomic<unsigned long long>& CMMDVMNetwork::getPacketsIn() const
+{
+	return m_packetsIn;
+}
+
+const std::atomic<unsigned long long>& CMMDVMNetwork::getPacketsOut() const
+{
+	return m_packetsOut;
+}
@@ -25,6 +25,7 @@
 #include "DMRData.h"
 
 #include <string>
+#include <atomic>
 #include <cstdint>
 
 class CMMDVMNetwork
@@ -55,6 +56,10 @@ public:
 
 	void close();
 
+	// Data frames through the network, for the metrics
+	const std::atomic<unsigned long long>& getPacketsIn() const;
+	const std::atomic<unsigned long long>& getPacketsOut() const;
+
 private: 
 	in_addr                    m_rptAddress;
 	unsigned int               m_rptPort;
@@ -71,6 +76,8 @@ private:
 	unsigned int               m_positionLen;
 	unsigned char*             m_talkerAliasData;
 	unsigned int               m_talkerAliasLen;
+	std::atomic<unsigned long long> m_packetsIn;
+	std::atomic<unsigned long long> m_packetsOut;
 };
 
 #endif
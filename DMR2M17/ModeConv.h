@@ -20,7 +20,9 @@
 
 #include "Defines.h"
 #include "RingBuffer.h"
+#include "PCMGain.h"
 #include "MBEVocoder.h"
+#include "Profiler.h"
 #include "codec2/codec2.h"
 
 #if !defined(MODECONV_H)
@@ -32,6 +34,11 @@ public:
 	~CModeConv();
 
 	void setM17GainAdjDb(std::string dbstring);
+	void setM17AGC(bool enabled);
+
+	// Accounts for the CPU time of each vocoder
+	void setProfiler(CProfiler* profiler);
+
 	void putDMR(unsigned char* data);
 	void putDMRHeader();
 	void putDMREOT();
@@ -43,6 +50,10 @@ public:
 	unsigned int getM17(unsigned char* data);
 	unsigned int getDMR(unsigned char* data);
 
+	// The number of frames waiting
+	unsigned int getM17Depth() const;
+	unsigned int getDMRDepth() const;
+
 private:
 	unsigned int m_m17N;
 	unsigned int m_dmrN;
@@ -50,8 +61,17 @@ private:
 	CRingBuffer<unsigned char> m_DMR;
 	MBEVocoder *m_mbe;
 	CCodec2 *m_c2;
-	uint16_t m_m17GainMultiplier;
-	bool m_m17Attenuate;
+	CPCMGain m_m17Gain;
+	unsigned int m_dmrFrames;
+	unsigned int m_dmrSilence;
+	unsigned int m_m17Frames;
+	unsigned int m_m17Silence;
+	CProfiler* m_profiler;
+	unsigned int m_mbeStage;
+	unsigned int m_codec2Stage;
+	void beginStage(unsigned int stage);
+	void endStage(unsigned int stage);
+	void putDMRFrame(const unsigned char* data);
 	void encode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 	void decode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 };
@@ -0,0 +1,325 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Profiler.h"
+#include "StopWatch.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <ctime>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+const char* PROFILER_COUNTER_NAMES[] = { "stage_cycles_total", "stage_instructions_total", "stage_cache_misses_total" };
+
+CProfilerStage::CProfilerStage(const std::string& name) :
+m_name(name),
+m_calls(0ULL),
+m_cpu(0ULL),
+m_startCPU(0ULL),
+m_lastCalls(0ULL),
+m_lastCPU(0ULL)
+{
+	for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++) {
+		m_counts[i]      = 0ULL;
+		m_startCounts[i] = 0ULL;
+		m_lastCounts[i]  = 0ULL;
+	}
+}
+
+CProfiler::CProfiler(bool enabled, unsigned int summaryTime) :
+m_enabled(enabled),
+m_stages(),
+m_counters(false),
+m_summaryTime(summaryTime),
+m_summaryTimer(1000U, summaryTime * 60U),
+m_logTimer(1000U, 1U),
+m_lastTime(0ULL),
+m_lastProcessCPU(0ULL)
+{
+	for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++)
+		m_fds[i] = -1;
+
+	addStage("log");
+
+	if (!enabled)
+		return;
+
+	openCounters();
+
+	m_lastTime       = CStopWatch::getMicroseconds();
+	m_lastProcessCPU = getProcessCPU();
+
+	if (summaryTime > 0U)
+		m_summaryTimer.start();
+
+	m_logTimer.start();
+}
+
+CProfiler::~CProfiler()
+{
+#if defined(__linux__)
+	for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++) {
+		if (m_fds[i] >= 0)
+			::close(m_fds[i]);
+	}
+#endif
+
+	for (std::vector<CProfilerStage*>::iterator it = m_stages.begin(); it != m_stages.end(); ++it)
+		delete *it;
+}
+
+unsigned int CProfiler::addStage(const std::string& name)
+{
+	m_stages.push_back(new CProfilerStage(name));
+
+	return m_stages.size() - 1U;
+}
+
+void CProfiler::begin(unsigned int stage)
+{
+	assert(stage > PROFILER_LOG && stage < m_stages.size());
+
+	if (!m_enabled)
+		return;
+
+	CProfilerStage* s = m_stages[stage];
+
+	s->m_startCPU = getThreadCPU();
+
+	if (m_counters)
+		readCounters(s->m_startCounts);
+}
+
+unsigned long long CProfiler::end(unsigned int stage)
+{
+	assert(stage > PROFILER_LOG && stage < m_stages.size());
+
+	if (!m_enabled)
+		return 0U;
+
+	CProfilerStage* s = m_stages[stage];
+
+	if (m_counters) {
+		unsigned long long counts[PROFILER_COUNTERS];
+		readCounters(counts);
+
+		for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++)
+			s->m_counts[i].fetch_add(counts[i] - s->m_startCounts[i], std::memory_order_relaxed);
+	}
+
+	unsigned long long cpu = getThreadCPU() - s->m_startCPU;
+
+	s->m_cpu.fetch_add(cpu, std::memory_order_relaxed);
+	s->m_calls.fetch_add(1U, std::memory_order_relaxed);
+
+	return cpu;
+}
+
+void CProfiler::addMetrics(CMetrics* metrics) const
+{
+	assert(metrics != NULL);
+
+	// The stages of each family are kept together
+	for (std::vector<CProfilerStage*>::const_iterator it = m_stages.begin(); it != m_stages.end(); ++it)
+		metrics->addCounter("stage_cpu_nanoseconds_total{stage=\"" + (*it)->m_name + "\"}", "CPU time used by each stage", (*it)->m_cpu);
+
+	for (std::vector<CProfilerStage*>::const_iterator it = m_stages.begin(); it != m_stages.end(); ++it)
+		metrics->addCounter("stage_calls_total{stage=\"" + (*it)->m_name + "\"}", "Times each stage was run, the log is not counted", (*it)->m_calls);
+
+	if (!m_counters)
+		return;
+
+	for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++) {
+		for (std::vector<CProfilerStage*>::const_iterator it = m_stages.begin(); it != m_stages.end(); ++it)
+			metrics->addCounter(std::string(PROFILER_COUNTER_NAMES[i]) + "{stage=\"" + (*it)->m_name + "\"}", "Hardware counters of each stage, in user space", (*it)->m_counts[i]);
+	}
+}
+
+void CProfiler::clock(unsigned int ms)
+{
+	if (!m_enabled)
+		return;
+
+	// The log is written by a thread of its own, so its total is only copied in
+	m_logTimer.clock(ms);
+	if (m_logTimer.hasExpired()) {
+		m_stages[PROFILER_LOG]->m_cpu.store(::LogGetCPUTime(), std::memory_order_relaxed);
+		m_logTimer.start();
+	}
+
+	m_summaryTimer.clock(ms);
+	if (m_summaryTimer.isRunning() && m_summaryTimer.hasExpired()) {
+		writeSummary();
+		m_summaryTimer.start();
+	}
+}
+
+void CProfiler::openCounters()
+{
+#if defined(__linux__)
+	const unsigned long long EVENTS[] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+
+	// One group, so that a single read gets all of the counters of this thread
+	for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++) {
+		struct perf_event_attr attr;
+		::memset(&attr, 0x00U, sizeof(struct perf_event_attr));
+		attr.type           = PERF_TYPE_HARDWARE;
+		attr.size           = sizeof(struct perf_event_attr);
+		attr.config         = EVENTS[i];
+		attr.disabled       = i == 0U ? 1U : 0U;
+		attr.exclude_kernel = 1U;
+		attr.exclude_hv     = 1U;
+		attr.read_format    = PERF_FORMAT_GROUP;
+
+		m_fds[i] = ::syscall(__NR_perf_event_open, &attr, 0, -1, i == 0U ? -1 : m_fds[0U], 0UL);
+		if (m_fds[i] < 0) {
+			for (unsigned int j = 0U; j < i; j++) {
+				::close(m_fds[j]);
+				m_fds[j] = -1;
+			}
+
+			LogInfo("The hardware counters are not available, only the CPU time of each stage is measured");
+			return;
+		}
+	}
+
+	::ioctl(m_fds[0U], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	::ioctl(m_fds[0U], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	m_counters = true;
+
+	LogInfo("Measuring the CPU time and the hardware counters of each stage");
+#else
+	LogInfo("Measuring the CPU time of each stage");
+#endif
+}
+
+void CProfiler::readCounters(unsigned long long* counts) const
+{
+	assert(counts != NULL);
+
+#if defined(__linux__)
+	// The number of counters followed by their values
+	unsigned long long buffer[PROFILER_COUNTERS + 1U];
+	if (::read(m_fds[0U], buffer, sizeof(buffer)) == (ssize_t)sizeof(buffer)) {
+		::memcpy(counts, buffer + 1U, PROFILER_COUNTERS * sizeof(unsigned long long));
+		return;
+	}
+#endif
+
+	::memset(counts, 0x00U, PROFILER_COUNTERS * sizeof(unsigned long long));
+}
+
+void CProfiler::writeSummary()
+{
+	m_stages[PROFILER_LOG]->m_cpu.store(::LogGetCPUTime(), std::memory_order_relaxed);
+
+	unsigned long long now = CStopWatch::getMicroseconds();
+	unsigned long long cpu = getProcessCPU();
+
+	double elapsed = double(now - m_lastTime) * 1000.0;
+	if (elapsed <= 0.0)
+		return;
+
+	LogMessage("CPU use over the last %u minutes, %.2f%% in total", m_summaryTime, 100.0 * double(cpu - m_lastProcessCPU) / elapsed);
+
+	for (std::vector<CProfilerStage*>::iterator it = m_stages.begin(); it != m_stages.end(); ++it) {
+		CProfilerStage* s = *it;
+
+		unsigned long long calls  = s->m_calls.load(std::memory_order_relaxed);
+		unsigned long long total  = s->m_cpu.load(std::memory_order_relaxed);
+		unsigned long long counts[PROFILER_COUNTERS];
+		for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++)
+			counts[i] = s->m_counts[i].load(std::memory_order_relaxed);
+
+		double percent = 100.0 * double(total - s->m_lastCPU) / elapsed;
+		unsigned long long n = calls - s->m_lastCalls;
+
+		if (n == 0ULL) {
+			LogMessage("    %s: %.2f%%", s->m_name.c_str(), percent);
+		} else if (m_counters) {
+			unsigned long long cycles = counts[0U] - s->m_lastCounts[0U];
+			double ipc = cycles > 0ULL ? double(counts[1U] - s->m_lastCounts[1U]) / double(cycles) : 0.0;
+			LogMessage("    %s: %.2f%%, %llu calls of %.1f us, %.2f instructions per cycle, %.1f cache misses per call", s->m_name.c_str(), percent, n, double(total - s->m_lastCPU) / double(n) / 1000.0, ipc, double(counts[2U] - s->m_lastCounts[2U]) / double(n));
+		} else {
+			LogMessage("    %s: %.2f%%, %llu calls of %.1f us", s->m_name.c_str(), percent, n, double(total - s->m_lastCPU) / double(n) / 1000.0);
+		}
+
+		s->m_lastCalls = calls;
+		s->m_lastCPU   = total;
+		for (unsigned int i = 0U; i < PROFILER_COUNTERS; i++)
+			s->m_lastCounts[i] = counts[i];
+	}
+
+	m_lastTime       = now;
+	m_lastProcessCPU = cpu;
+}
+
+unsigned long long CProfiler::getThreadCPU()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME creation, exit, kernel, user;
+	::GetThreadTimes(::GetCurrentThread(), &creation, &exit, &kernel, &user);
+
+	ULARGE_INTEGER k, u;
+	k.LowPart  = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart  = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+
+	return (k.QuadPart + u.QuadPart) * 100ULL;
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+unsigned long long CProfiler::getProcessCPU()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME creation, exit, kernel, user;
+	::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user);
+
+	ULARGE_INTEGER k, u;
+	k.LowPart  = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart  = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+
+	return (k.QuadPart + u.QuadPart) * 100ULL;
+#else
+	struct timespec now;
+	::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
@@ -0,0 +1,92 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef	Profiler_H
+#define	Profiler_H
+
+#include "Metrics.h"
+#include "Timer.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+// Cycles, instructions and cache misses, when the hardware counters are available
+const unsigned int PROFILER_COUNTERS = 3U;
+
+// The thread writing the log is always the first stage
+const unsigned int PROFILER_LOG = 0U;
+
+struct CProfilerStage {
+	CProfilerStage(const std::string& name);
+
+	std::string                     m_name;
+	std::atomic<unsigned long long> m_calls;
+	std::atomic<unsigned long long> m_cpu;			// Nanoseconds
+	std::atomic<unsigned long long> m_counts[PROFILER_COUNTERS];
+
+	unsigned long long m_startCPU;
+	unsigned long long m_startCounts[PROFILER_COUNTERS];
+
+	// The totals at the last summary
+	unsigned long long m_lastCalls;
+	unsigned long long m_lastCPU;
+	unsigned long long m_lastCounts[PROFILER_COUNTERS];
+};
+
+// Accounts for the CPU time, and where the kernel allows it the hardware counters, used
+// by each stage of a bridge. The stages are measured on the thread that created the
+// profiler, a summary goes to the log every few minutes and the totals to the metrics.
+// When it is not enabled the stages are still added, but nothing is measured.
+class CProfiler {
+public:
+	CProfiler(bool enabled, unsigned int summaryTime);
+	~CProfiler();
+
+	unsigned int addStage(const std::string& name);
+
+	void begin(unsigned int stage);
+
+	// The CPU time of this run of the stage in nanoseconds, zero when not enabled
+	unsigned long long end(unsigned int stage);
+
+	// Once all of the stages are added
+	void addMetrics(CMetrics* metrics) const;
+
+	void clock(unsigned int ms);
+
+private:
+	bool                         m_enabled;
+	std::vector<CProfilerStage*> m_stages;
+	int                          m_fds[PROFILER_COUNTERS];
+	bool                         m_counters;
+	unsigned int                 m_summaryTime;
+	CTimer                       m_summaryTimer;
+	CTimer                       m_logTimer;
+	unsigned long long           m_lastTime;
+	unsigned long long           m_lastProcessCPU;
+
+	void openCounters();
+	void readCounters(unsigned long long* counts) const;
+	void writeSummary();
+
+	static unsigned long long getThreadCPU();
+	static unsigned long long getProcessCPU();
+};
+
+#endif
@@ -0,0 +1,80 @@
+/* -*- c++ -*- */
+/*
+ * AMBE halfrate decoder for the 49 bit (2450 bps) DMR voice frames
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <cstring>
+
+#include "mbedec.h"
+
+const uint8_t  BIT_MASK_TABLE8[]  = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
+#define READ_BIT8(p,i)     (p[(i)>>3] & BIT_MASK_TABLE8[(i)&7])
+
+MBEDecoder::MBEDecoder()
+	: d_uvquality(3)
+{
+	mbe_initMbeParms (&cur_mp, &prev_mp, &prev_mp_enhanced);
+}
+
+MBEDecoder::~MBEDecoder()
+{
+}
+
+// inverse of encode_49bit() in mbeenc.cc
+void MBEDecoder::decode_49bit(int b[9], const uint8_t inp[49])
+{
+	b[0] = (inp[0] << 6) | (inp[1] << 5) | (inp[2] << 4) | (inp[3] << 3) | (inp[37] << 2) | (inp[38] << 1) | inp[39];
+	b[1] = (inp[4] << 4) | (inp[5] << 3) | (inp[6] << 2) | (inp[7] << 1) | inp[35];
+	b[2] = (inp[8] << 4) | (inp[9] << 3) | (inp[10] << 2) | (inp[11] << 1) | inp[36];
+	b[3] = (inp[12] << 8) | (inp[13] << 7) | (inp[14] << 6) | (inp[15] << 5) | (inp[16] << 4) | (inp[17] << 3) | (inp[18] << 2) | (inp[19] << 1) | inp[40];
+	b[4] = (inp[20] << 6) | (inp[21] << 5) | (inp[22] << 4) | (inp[23] << 3) | (inp[41] << 2) | (inp[42] << 1) | inp[43];
+	b[5] = (inp[24] << 4) | (inp[25] << 3) | (inp[26] << 2) | (inp[27] << 1) | inp[44];
+	b[6] = (inp[28] << 3) | (inp[29] << 2) | (inp[30] << 1) | inp[45];
+	b[7] = (inp[31] << 3) | (inp[32] << 2) | (inp[33] << 1) | inp[46];
+	b[8] = (inp[34] << 2) | (inp[47] << 1) | inp[48];
+}
+
+// given a 49-bit codeword packed MSB first into 7 bytes (the md380_decode
+// input format), generate 160 audio samples (S16_LE)
+void MBEDecoder::decode(int16_t samples[], const uint8_t codeword[])
+{
+	uint8_t bits[49];
+	float aout_buf[160];
+	int b[9];
+
+	for (unsigned int i = 0U; i < 49U; i++)
+		bits[i] = READ_BIT8(codeword, i) ? 1U : 0U;
+
+	decode_49bit(b, bits);
+
+	int rc = mbe_dequantizeAmbe2250Parms (&cur_mp, &prev_mp, b);
+
+	if (rc == 0) {
+		cur_mp.repeat = 0;
+		mbe_moveMbeParms (&cur_mp, &prev_mp);
+		mbe_spectralAmpEnhance (&cur_mp);
+		mbe_synthesizeSpeechf (aout_buf, &cur_mp, &prev_mp_enhanced, d_uvquality);
+		mbe_moveMbeParms (&cur_mp, &prev_mp_enhanced);
+	} else {
+		// erasure and tone frames are muted, as mbelib does
+		mbe_synthesizeSilencef (aout_buf);
+		mbe_initMbeParms (&cur_mp, &prev_mp, &prev_mp_enhanced);
+	}
+
+	mbe_floattoshort (aout_buf, samples);
+}
@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2010 mbelib Author
+ * GPG Key ID: 0xEA5EFE2C (9E7A 5527 9CDC EBF7 BF1B  D772 4F98 E863 EA5E FE2C)
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS.  IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/*
+ * Native MBE parameter handling and speech synthesis, used in place of the
+ * external mbelib when building with NATIVE_AMBE. Only the functions needed
+ * by ambe.c, mbeenc.cc and mbedec.cc are provided.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "mbelib.h"
+
+#define MBE_N 160
+
+/*
+ * Trapezoidal synthesis window, 1.0 within +-55 samples of the frame
+ * centre and falling linearly to 0.0 at +-105 samples.
+ */
+static inline float
+mbe_synthesisWindow (int n)
+{
+  if (n < 0)
+    n = -n;
+
+  if (n <= 55)
+    return (float) 1;
+  else if (n <= 105)
+    return (float) (105 - n) / (float) 50;
+  else
+    return (float) 0;
+}
+
+static inline float
+mbe_randPhase (void)
+{
+  return (((float) rand () / (float) RAND_MAX) * ((float) 2 * M_PI)) - (float) M_PI;
+}
+
+static inline float
+mbe_wrapPhase (float phase)
+{
+  phase = fmodf (phase, (float) 2 * M_PI);
+  if (phase > (float) M_PI)
+    phase -= (float) 2 * M_PI;
+  else if (phase < -(float) M_PI)
+    phase += (float) 2 * M_PI;
+
+  return phase;
+}
+
+void
+mbe_printVersion (char *str)
+{
+  sprintf (str, "%s", MBELIB_VERSION);
+}
+
+void
+mbe_moveMbeParms (mbe_parms * cur_mp, mbe_parms * prev_mp)
+{
+  int l;
+
+  prev_mp->w0 = cur_mp->w0;
+  prev_mp->L = cur_mp->L;
+  prev_mp->K = cur_mp->K;
+  prev_mp->Ml[0] = (float) 0;
+  prev_mp->gamma = cur_mp->gamma;
+  prev_mp->repeat = cur_mp->repeat;
+  for (l = 0; l <= 56; l++)
+    {
+      prev_mp->Ml[l] = cur_mp->Ml[l];
+      prev_mp->Vl[l] = cur_mp->Vl[l];
+      prev_mp->log2Ml[l] = cur_mp->log2Ml[l];
+      prev_mp->PHIl[l] = cur_mp->PHIl[l];
+      prev_mp->PSIl[l] = cur_mp->PSIl[l];
+    }
+}
+
+void
+mbe_useLastMbeParms (mbe_parms * cur_mp, mbe_parms * prev_mp)
+{
+  int l;
+
+  cur_mp->w0 = prev_mp->w0;
+  cur_mp->L = prev_mp->L;
+  cur_mp->K = prev_mp->K;
+  cur_mp->Ml[0] = (float) 0;
+  cur_mp->gamma = prev_mp->gamma;
+  cur_mp->repeat = prev_mp->repeat;
+  for (l = 0; l <= 56; l++)
+    {
+      cur_mp->Ml[l] = prev_mp->Ml[l];
+      cur_mp->Vl[l] = prev_mp->Vl[l];
+      cur_mp->log2Ml[l] = prev_mp->log2Ml[l];
+      cur_mp->PHIl[l] = prev_mp->PHIl[l];
+      cur_mp->PSIl[l] = prev_mp->PSIl[l];
+    }
+}
+
+void
+mbe_initMbeParms (mbe_parms * cur_mp, mbe_parms * prev_mp, mbe_parms * prev_mp_enhanced)
+{
+  int l;
+
+  prev_mp->w0 = 0.09378;
+  prev_mp->L = 30;
+  prev_mp->K = 10;
+  prev_mp->gamma = (float) 0;
+  for (l = 0; l <= 56; l++)
+    {
+      prev_mp->Ml[l] = (float) 0;
+      prev_mp->Vl[l] = 0;
+      prev_mp->log2Ml[l] = (float) 0;
+      prev_mp->PHIl[l] = (float) 0;
+      prev_mp->PSIl[l] = (M_PI / (float) 2);
+    }
+  prev_mp->repeat = 0;
+  mbe_moveMbeParms (prev_mp, cur_mp);
+  mbe_moveMbeParms (prev_mp, prev_mp_enhanced);
+}
+
+void
+mbe_spectralAmpEnhance (mbe_parms * cur_mp)
+{
+  float Rm0, Rm1, R2m0, R2m1, Wl;
+  float sum, gamma, M;
+  int l;
+
+  Rm0 = 0;
+  Rm1 = 0;
+  for (l = 1; l <= cur_mp->L; l++)
+    {
+      Rm0 = Rm0 + (cur_mp->Ml[l] * cur_mp->Ml[l]);
+      Rm1 = Rm1 + ((cur_mp->Ml[l] * cur_mp->Ml[l]) * cosf (cur_mp->w0 * (float) l));
+    }
+
+  R2m0 = (Rm0 * Rm0);
+  R2m1 = (Rm1 * Rm1);
+
+  // nothing to weight, and avoids a division by zero below
+  if ((Rm0 == (float) 0) || (R2m0 == R2m1))
+    return;
+
+  for (l = 1; l <= cur_mp->L; l++)
+    {
+      if (cur_mp->Ml[l] != 0)
+        {
+          Wl = sqrtf (cur_mp->Ml[l]) * powf ((((float) 0.96 * M_PI * ((R2m0 + R2m1) - ((float) 2 * Rm0 * Rm1 * cosf (cur_mp->w0 * (float) l)))) / (cur_mp->w0 * Rm0 * (R2m0 - R2m1))), (float) 0.25);
+
+          if ((8 * l) <= cur_mp->L)
+            {
+            }
+          else if (Wl > 1.2)
+            {
+              cur_mp->Ml[l] = 1.2 * cur_mp->Ml[l];
+            }
+          else if (Wl < 0.5)
+            {
+              cur_mp->Ml[l] = 0.5 * cur_mp->Ml[l];
+            }
+          else
+            {
+              cur_mp->Ml[l] = Wl * cur_mp->Ml[l];
+            }
+        }
+    }
+
+  // generate scaling factor
+  sum = 0;
+  for (l = 1; l <= cur_mp->L; l++)
+    {
+      M = cur_mp->Ml[l];
+      sum += (M * M);
+    }
+
+  if (sum == 0)
+    gamma = (float) 1;
+  else
+    gamma = sqrtf (Rm0 / sum);
+
+  // apply scaling factor
+  for (l = 1; l <= cur_mp->L; l++)
+    {
+      cur_mp->Ml[l] = gamma * cur_mp->Ml[l];
+    }
+}
+
+void
+mbe_synthesizeSilencef (float *aout_buf)
+{
+  int n;
+
+  for (n = 0; n < MBE_N; n++)
+    aout_buf[n] = (float) 0;
+}
+
+void
+mbe_synthesizeSilence (short *aout_buf)
+{
+  memset (aout_buf, 0, MBE_N * sizeof (short));
+}
+
+void
+mbe_synthesizeSpeechf (float *aout_buf, mbe_parms * cur_mp, mbe_parms * prev_mp, int uvquality)
+{
+  int i, l, n, maxl, numUv;
+  float cw0, pw0, cw0l, pw0l, dw0;
+  float uvstep, uvoffset, qfactor;
+  float deltaphil, deltawl, aln, thetaln;
+  float rphase[64];
+
+  if ((uvquality < 1) || (uvquality > 64))
+    uvquality = 3;
+
+  // unvoiced bands are built from uvquality sines spread across the band
+  uvstep = (float) 1 / (float) uvquality;
+  uvoffset = (uvstep * (float) (uvquality - 1)) / (float) 2;
+  if (uvquality == 1)
+    qfactor = (float) 1 / (float) M_E;
+  else
+    qfactor = logf ((float) uvquality) / (float) uvquality;
+
+  numUv = 0;
+  for (l = 1; l <= cur_mp->L; l++)
+    {
+      if (cur_mp->Vl[l] == 0)
+        numUv++;
+    }
+
+  cw0 = cur_mp->w0;
+  pw0 = prev_mp->w0;
+  dw0 = cw0 - pw0;
+
+  mbe_synthesizeSilencef (aout_buf);
+
+  // eq 128 and 129, harmonics missing from one frame have zero amplitude
+  if (cur_mp->L > prev_mp->L)
+    {
+      maxl = cur_mp->L;
+      for (l = prev_mp->L + 1; l <= maxl; l++)
+        {
+          prev_mp->Ml[l] = (float) 0;
+          prev_mp->Vl[l] = 1;
+        }
+    }
+  else
+    {
+      maxl = prev_mp->L;
+      for (l = cur_mp->L + 1; l <= maxl; l++)
+        {
+          cur_mp->Ml[l] = (float) 0;
+          cur_mp->Vl[l] = 1;
+        }
+    }
+
+  // eq 139 and 140, phase evolution of the voiced harmonics
+  for (l = 1; l <= 56; l++)
+    {
+      cur_mp->PSIl[l] = mbe_wrapPhase (prev_mp->PSIl[l] + ((pw0 + cw0) * ((float) (l * MBE_N) / (float) 2)));
+      if (l <= (cur_mp->L / 4))
+        cur_mp->PHIl[l] = cur_mp->PSIl[l];
+      else
+        cur_mp->PHIl[l] = cur_mp->PSIl[l] + (((float) numUv * mbe_randPhase ()) / (float) cur_mp->L);
+    }
+
+  for (l = 1; l <= maxl; l++)
+    {
+      cw0l = cw0 * (float) l;
+      pw0l = pw0 * (float) l;
+
+      // voiced components
+      if ((cur_mp->Vl[l] == 1) && (prev_mp->Vl[l] == 1) && (l < 8) && (fabsf (dw0) < ((float) 0.1 * cw0)))
+        {
+          // eq 133 to 138, amplitude and phase interpolation across the frame
+          deltaphil = cur_mp->PHIl[l] - prev_mp->PHIl[l] - ((pw0 + cw0) * ((float) (l * MBE_N) / (float) 2));
+          deltawl = ((float) 1 / (float) MBE_N) * (deltaphil - ((float) 2 * M_PI * floorf ((deltaphil + M_PI) / ((float) 2 * M_PI))));
+          for (n = 0; n < MBE_N; n++)
+            {
+              aln = prev_mp->Ml[l] + (((float) n / (float) MBE_N) * (cur_mp->Ml[l] - prev_mp->Ml[l]));
+              thetaln = prev_mp->PHIl[l] + ((pw0l + deltawl) * (float) n) + ((dw0 * (float) l * (float) (n * n)) / (float) (2 * MBE_N));
+              aout_buf[n] += aln * cosf (thetaln);
+            }
+        }
+      else
+        {
+          // eq 131 and 132, windowed overlap-add of the two frames
+          if ((prev_mp->Vl[l] == 1) && (prev_mp->Ml[l] != (float) 0))
+            {
+              for (n = 0; n < MBE_N; n++)
+                aout_buf[n] += mbe_synthesisWindow (n) * prev_mp->Ml[l] * cosf ((pw0l * (float) n) + prev_mp->PHIl[l]);
+            }
+          if ((cur_mp->Vl[l] == 1) && (cur_mp->Ml[l] != (float) 0))
+            {
+              for (n = 0; n < MBE_N; n++)
+                aout_buf[n] += mbe_synthesisWindow (n - MBE_N) * cur_mp->Ml[l] * cosf ((cw0l * (float) (n - MBE_N)) + cur_mp->PHIl[l]);
+            }
+        }
+
+      // unvoiced components, a multisine with random phases per band
+      if ((prev_mp->Vl[l] == 0) && (prev_mp->Ml[l] != (float) 0))
+        {
+          for (i = 0; i < uvquality; i++)
+            rphase[i] = mbe_randPhase ();
+          for (n = 0; n < MBE_N; n++)
+            {
+              float C3 = 0;
+              for (i = 0; i < uvquality; i++)
+                C3 += cosf ((pw0 * (float) n * ((float) l + ((float) i * uvstep) - uvoffset)) + rphase[i]);
+              aout_buf[n] += mbe_synthesisWindow (n) * prev_mp->Ml[l] * qfactor * C3;
+            }
+        }
+      if ((cur_mp->Vl[l] == 0) && (cur_mp->Ml[l] != (float) 0))
+        {
+          for (i = 0; i < uvquality; i++)
+            rphase[i] = mbe_randPhase ();
+          for (n = 0; n < MBE_N; n++)
+            {
+              float C3 = 0;
+              for (i = 0; i < uvquality; i++)
+                C3 += cosf ((cw0 * (float) (n - MBE_N) * ((float) l + ((float) i * uvstep) - uvoffset)) + rphase[i]);
+              aout_buf[n] += mbe_synthesisWindow (n - MBE_N) * cur_mp->Ml[l] * qfactor * C3;
+            }
+        }
+    }
+}
+
+void
+mbe_synthesizeSpeech (short *aout_buf, mbe_parms * cur_mp, mbe_parms * prev_mp, int uvquality)
+{
+  float float_buf[MBE_N];
+
+  mbe_synthesizeSpeechf (float_buf, cur_mp, prev_mp, uvquality);
+  mbe_floattoshort (float_buf, aout_buf);
+}
+
+void
+mbe_floattoshort (float *float_buf, short *aout_buf)
+{
+  float audio;
+  int i;
+
+  for (i = 0; i < MBE_N; i++)
+    {
+      audio = float_buf[i] * (float) 7;
+      if (audio > (float) 32760)
+        audio = (float) 32760;
+      else if (audio < (float) -32760)
+        audio = (float) -32760;
+      aout_buf[i] = (short) audio;
+    }
+}
@@ -103,6 +103,8 @@ m_dmrNetwork(NULL),
 m_nxdnNetwork(NULL),
 m_dmrlookup(NULL),
 m_nxdnlookup(NULL),
+m_dmrIdentities(),
+m_nxdnIdentities(),
 m_conv(),
 m_colorcode(1U),
 m_defsrcid(1U),
@@ -249,8 +251,10 @@ int CDMR2NXDN::run()
 	}
 
 	ret = createMMDVM();
-	if (!ret)
+	if (!ret) {
+		::LogFinalise();
 		return 1;
+	}
 
 	LogMessage("Waiting for MMDVM to connect.....");
 
@@ -267,6 +271,7 @@ int CDMR2NXDN::run()
 	if (m_killed) {
 		m_dmrNetwork->close();
 		delete m_dmrNetwork;
+		::LogFinalise();
 		return 0;
 	}
 
@@ -331,11 +336,12 @@ int CDMR2NXDN::run()
 			if (usc == NXDN_LICH_USC_SACCH_NS) {
 				if (end) {
 					LogMessage("NXDN received end of voice transmission, %.1f seconds", float(m_nxdnFrames) / 12.5F);
+					m_nxdnIdentities.remove(0U);
 					m_conv.putNXDNEOT();
 					m_nxdnFrames = 0U;
 					m_nxdninfo = false;
 				} else {
-					std::string netSrc = m_nxdnlookup->findCS(m_nxdnSrc);
+					std::string netSrc = findNXDNCS(m_nxdnSrc);
 					std::string netDst = m_nxdnlookup->findCS(m_nxdnDst);
 					LogMessage("Received NXDN header from %s to %s%s", netSrc.c_str(), grp ? "TG " : "", netDst.c_str());
 
@@ -346,7 +352,7 @@ int CDMR2NXDN::run()
 			} else {
 				if (opt == NXDN_LICH_STEAL_NONE) {
 					if (!m_nxdninfo) {
-						std::string netSrc = m_nxdnlookup->findCS(m_nxdnSrc);
+						std::string netSrc = findNXDNCS(m_nxdnSrc);
 						std::string netDst = m_nxdnlookup->findCS(m_nxdnDst);
 						LogMessage("Received NXDN late entry from %s to %s%s", netSrc.c_str(), grp ? "TG " : "", netDst.c_str());
 						m_conv.putNXDNHeader();
@@ -528,6 +534,9 @@ int CDMR2NXDN::run()
 			if (!tx_dmrdata.isMissing()) {
 				networkWatchdog.start();
 
+				if (DataType == DT_TERMINATOR_WITH_LC)
+					m_dmrIdentities.remove(tx_dmrdata.getStreamId());
+
 				if(DataType == DT_TERMINATOR_WITH_LC && m_dmrFrames > 0U) {
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
@@ -538,7 +547,7 @@ int CDMR2NXDN::run()
 				}
 
 				if((DataType == DT_VOICE_LC_HEADER) && (DataType != m_dmrLastDT)) {
-					std::string netSrc = m_dmrlookup->findCS(m_dmrSrc);
+					std::string netSrc = findDMRCS(tx_dmrdata.getStreamId(), m_dmrSrc);
 					std::string netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_dmrlookup->findCS(m_dmrDst);
 
 					m_conv.putDMRHeader();
@@ -562,7 +571,7 @@ int CDMR2NXDN::run()
 					tx_dmrdata.getData(dmr_frame);
 
 					if (!m_dmrinfo) {
-						std::string netSrc = m_dmrlookup->findCS(m_dmrSrc);
+						std::string netSrc = findDMRCS(tx_dmrdata.getStreamId(), m_dmrSrc);
 						std::string netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_dmrlookup->findCS(m_dmrDst);
 
 						m_conv.putDMRHeader();
@@ -720,11 +729,46 @@ int CDMR2NXDN::run()
 	delete m_dmrNetwork;
 	delete m_nxdnNetwork;
 
+	LogMessage("Identity cache, DMR sources: %u hits, %u misses, NXDN sources: %u hits, %u misses", m_dmrIdentities.getHits(), m_dmrIdentities.getMisses(), m_nxdnIdentities.getHits(), m_nxdnIdentities.getMisses());
+
 	::LogFinalise();
 
 	return 0;
 }
 
+// The callsign of a DMR source, looked up once per stream
+std::string CDMR2NXDN::findDMRCS(unsigned int stream, unsigned int id)
+{
+	unsigned char source[3U];
+	source[0U] = id >> 16;
+	source[1U] = id >> 8;
+	source[2U] = id >> 0;
+
+	CIdentity identity;
+	if (!m_dmrIdentities.find(stream, source, 3U, identity)) {
+		identity.m_callsign = m_dmrlookup->findCS(id);
+		m_dmrIdentities.add(stream, source, 3U, identity);
+	}
+
+	return identity.m_callsign;
+}
+
+// NXDN has no stream id, the entry is dropped at the end of each transmission instead
+std::string CDMR2NXDN::findNXDNCS(unsigned int id)
+{
+	unsigned char source[2U];
+	source[0U] = id >> 8;
+	source[1U] = id >> 0;
+
+	CIdentity identity;
+	if (!m_nxdnIdentities.find(0U, source, 2U, identity)) {
+		identity.m_callsign = m_nxdnlookup->findCS(id);
+		m_nxdnIdentities.add(0U, source, 2U, identity);
+	}
+
+	return identity.m_callsign;
+}
+
 unsigned int CDMR2NXDN::findNXDNID(unsigned int dmrid)
 {
 	std::string dmrCS = m_dmrlookup->findCS(dmrid);
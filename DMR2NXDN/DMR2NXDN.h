@@ -29,6 +29,7 @@
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
+#include "IdentityCache.h"
 #include "NXDNConvolution.h"
 #include "NXDNCRC.h"
 #include "NXDNLayer3.h"
@@ -64,6 +65,8 @@ private:
 	CNXDNNetwork*    m_nxdnNetwork;
 	CDMRLookup*      m_dmrlookup;
 	CNXDNLookup*     m_nxdnlookup;
+	CIdentityCache   m_dmrIdentities;
+	CIdentityCache   m_nxdnIdentities;
 	CModeConv        m_conv;
 	unsigned int     m_colorcode;
 	unsigned int     m_defsrcid;
@@ -85,6 +88,8 @@ private:
 	unsigned int     m_configLen;
 	unsigned int     m_defaultID;
 
+	std::string findDMRCS(unsigned int stream, unsigned int id);
+	std::string findNXDNCS(unsigned int id);
 	unsigned int findNXDNID(unsigned int dmrid);
 	unsigned int findDMRID(unsigned int nxdnid);
 	unsigned int truncID(unsigned int id);
@@ -17,6 +17,8 @@
 */
 
 #include "NXDNLookup.h"
+#include "FileWatcher.h"
+#include "StopWatch.h"
 #include "Timer.h"
 #include "Log.h"
 
@@ -24,6 +26,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <vector>
 
 CNXDNLookup::CNXDNLookup(const std::string& filename, unsigned int reloadTime) :
 CThread(),
@@ -54,14 +57,34 @@ void CNXDNLookup::entry()
 {
 	LogInfo("Started the NXDN Id lookup reload thread");
 
-	CTimer timer(1U, 3600U * m_reloadTime);
+	// A change to the file is picked up at once, the timer remains for file systems that inotify cannot watch
+	CFileWatcher watcher(m_filename);
+	watcher.open();
+
+	CTimer timer(1000U, 3600U * m_reloadTime);
 	timer.start();
 
+	// A wait can return early or late, so the timer goes by the time that has passed
+	CStopWatch stopWatch;
+	stopWatch.start();
+
 	while (!m_stop) {
-		sleep(1000U);
+		bool changed = false;
+		if (watcher.isOpen()) {
+			changed = watcher.wait(1000U);
+
+			// Let a file that is still being written settle first
+			while (changed && !m_stop && watcher.wait(1000U))
+				;
+		} else {
+			sleep(1000U);
+		}
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
 
-		timer.clock();
-		if (timer.hasExpired()) {
+		timer.clock(ms);
+		if ((changed || timer.hasExpired()) && !m_stop) {
 			load();
 			timer.start();
 		}
@@ -140,11 +163,9 @@ bool CNXDNLookup::load()
 		return false;
 	}
 
-	m_mutex.lock();
-
-	// Remove the old entries
-	m_table.clear();
-	m_cstable.clear();
+	// The file is parsed without the lock, the readers only wait while the differences are applied
+	std::unordered_map<unsigned int, std::string> table;
+	std::unordered_map<std::string, unsigned int> cstable;
 
 	char buffer[100U];
 	while (::fgets(buffer, 100U, fp) != NULL) {
@@ -160,21 +181,78 @@ bool CNXDNLookup::load()
 				for (char* p = p2; *p != 0x00U; p++)
 					*p = ::toupper(*p);
 
-				m_table[id] = std::string(p2);
-				m_cstable[p2] = id;
+				table[id] = std::string(p2);
+				cstable[p2] = id;
 			}
 		}
 	}
 
-	m_mutex.unlock();
-
 	::fclose(fp);
 
-	size_t size = m_table.size();
+	size_t size = table.size();
 	if (size == 0U)
 		return false;
 
-	LogInfo("Loaded %u Ids to the NXDN callsign lookup table", size);
+	// Only this thread changes the tables, so they can be compared without the lock. What is
+	// left in table and cstable afterwards are the new and changed entries.
+	bool initial = m_table.empty();
+
+	std::vector<unsigned int> removedIds;
+	for (std::unordered_map<unsigned int, std::string>::const_iterator it = m_table.begin(); it != m_table.end(); ++it) {
+		if (table.count(it->first) == 0U)
+			removedIds.push_back(it->first);
+	}
+
+	std::vector<std::string> removedCSs;
+	for (std::unordered_map<std::string, unsigned int>::const_iterator it = m_cstable.begin(); it != m_cstable.end(); ++it) {
+		if (cstable.count(it->first) == 0U)
+			removedCSs.push_back(it->first);
+	}
+
+	unsigned int added   = 0U;
+	unsigned int changed = 0U;
+	for (std::unordered_map<unsigned int, std::string>::iterator it = table.begin(); it != table.end();) {
+		std::unordered_map<unsigned int, std::string>::const_iterator old = m_table.find(it->first);
+		if (old == m_table.end()) {
+			added++;
+			++it;
+		} else if (old->second != it->second) {
+			changed++;
+			++it;
+		} else {
+			it = table.erase(it);
+		}
+	}
+
+	for (std::unordered_map<std::string, unsigned int>::iterator it = cstable.begin(); it != cstable.end();) {
+		std::unordered_map<std::string, unsigned int>::const_iterator old = m_cstable.find(it->first);
+		if (old != m_cstable.end() && old->second == it->second)
+			it = cstable.erase(it);
+		else
+			++it;
+	}
+
+	if (table.empty() && cstable.empty() && removedIds.empty() && removedCSs.empty())
+		return true;
+
+	m_mutex.lock();
+
+	for (std::vector<unsigned int>::const_iterator it = removedIds.begin(); it != removedIds.end(); ++it)
+		m_table.erase(*it);
+	for (std::vector<std::string>::const_iterator it = removedCSs.begin(); it != removedCSs.end(); ++it)
+		m_cstable.erase(*it);
+
+	for (std::unordered_map<unsigned int, std::string>::const_iterator it = table.begin(); it != table.end(); ++it)
+		m_table[it->first] = it->second;
+	for (std::unordered_map<std::string, unsigned int>::const_iterator it = cstable.begin(); it != cstable.end(); ++it)
+		m_cstable[it->first] = it->second;
+
+	m_mutex.unlock();
+
+	if (initial)
+		LogInfo("Loaded %u Ids to the NXDN callsign lookup table", size);
+	else
+		LogInfo("Updated the NXDN callsign lookup table, %u Ids, %u added, %u removed, %u changed", size, added, (unsigned int)removedIds.size(), changed);
 
 	return true;
-}
\ No newline at end of file
+}
@@ -51,6 +51,7 @@ m_p25DstPort(0U),
 m_p25LocalAddress(),
 m_p25LocalPort(0U),
 m_p25NetworkDebug(false),
+m_p25DirectTranscode(false),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_logDisplayLevel(0U),
@@ -124,6 +125,8 @@ bool CConf::read()
 			m_p25DstPort = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "Debug") == 0)
 			m_p25NetworkDebug = ::atoi(value) == 1;
+		else if (::strcmp(key, "DirectTranscode") == 0)
+			m_p25DirectTranscode = ::atoi(value) == 1;
 	} else if (section == SECTION_DMR_NETWORK) {
 		if (::strcmp(key, "Id") == 0)
 			m_dmrId = (unsigned int)::atoi(value);
@@ -189,6 +192,11 @@ bool CConf::getP25NetworkDebug() const
 	return m_p25NetworkDebug;
 }
 
+bool CConf::getP25DirectTranscode() const
+{
+	return m_p25DirectTranscode;
+}
+
 bool CConf::getDaemon() const
 {
 	return m_daemon;
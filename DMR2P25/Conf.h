@@ -40,6 +40,7 @@ public:
   std::string  getP25LocalAddress() const;
   unsigned int getP25LocalPort() const;
   bool         getP25NetworkDebug() const;
+  bool         getP25DirectTranscode() const;
   
   // The DMR Network section
   unsigned int getDMRId() const;
@@ -77,6 +78,7 @@ private:
   std::string  m_p25LocalAddress;
   unsigned int m_p25LocalPort;
   bool         m_p25NetworkDebug;
+  bool         m_p25DirectTranscode;
 
   std::string  m_dmrIdLookupFile;
   unsigned int m_dmrIdLookupTime;
@@ -277,6 +277,10 @@ int CDMR2P25::run()
 	std::string p25_localAddress = m_conf.getP25LocalAddress();
 	unsigned int p25_localPort   = m_conf.getP25LocalPort();
 	bool p25_debug               = m_conf.getP25NetworkDebug();
+	bool p25_direct              = m_conf.getP25DirectTranscode();
+
+	LogMessage("P25 to DMR transcoding: %s", p25_direct ? "direct (parameter domain)" : "tandem (PCM)");
+	m_conv.setDirectTranscode(p25_direct);
 	::fprintf(stderr, "%s : %s\n", p25_dstAddress.c_str(), p25_localAddress.c_str());
 	 
 	m_p25Network = new CP25Network(p25_localAddress, p25_localPort, p25_dstAddress, p25_dstPort, m_callsign, p25_debug);
@@ -289,8 +293,10 @@ int CDMR2P25::run()
 	}
 	m_p25Network->writePoll();
 	ret = createMMDVM();
-	if (!ret)
+	if (!ret) {
+		::LogFinalise();
 		return 1;
+	}
 
 	LogMessage("Waiting for MMDVM to connect.....");
 
@@ -307,6 +313,7 @@ int CDMR2P25::run()
 	if (m_killed) {
 		m_dmrNetwork->close();
 		delete m_dmrNetwork;
+		::LogFinalise();
 		return 0;
 	}
 
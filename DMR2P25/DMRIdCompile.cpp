@@ -0,0 +1,228 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Compiles DMRIds.dat into the binary format that CDMRLookup maps directly,
+// see DMRLookup.h for the layout. The output is written to a temporary file
+// and renamed into place, so running bridges keep their current mapping until
+// their next reload.
+
+#include "DMRLookup.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+const unsigned int MAX_SEED = 1000000U;
+
+static unsigned int align(unsigned int offset)
+{
+	return (offset + 7U) & ~7U;
+}
+
+struct CBucketOrder {
+	CBucketOrder(const std::vector<std::vector<unsigned int> >& members) :
+	m_members(members)
+	{
+	}
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		return m_members[a].size() > m_members[b].size();
+	}
+
+	const std::vector<std::vector<unsigned int> >& m_members;
+};
+
+// Hash and displace: every bucket of callsigns gets the first seed that places all of its keys in free slots
+static bool buildHash(const std::vector<std::string>& keys, const std::vector<CDMRIdRecord>& entries, unsigned int buckets, unsigned int slots, std::vector<unsigned int>& seeds, std::vector<CDMRIdRecord>& table)
+{
+	std::vector<std::vector<unsigned int> > members(buckets);
+	for (unsigned int i = 0U; i < keys.size(); i++)
+		members[DMRIdHash(keys[i].c_str(), 0U) % buckets].push_back(i);
+
+	std::vector<unsigned int> order(buckets);
+	for (unsigned int i = 0U; i < buckets; i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), CBucketOrder(members));
+
+	CDMRIdRecord empty;
+	empty.m_id       = 0U;
+	empty.m_callsign = DMRID_EMPTY;
+
+	seeds.assign(buckets, 1U);
+	table.assign(slots, empty);
+
+	std::vector<bool> used(slots, false);
+	std::vector<unsigned int> positions;
+
+	for (std::vector<unsigned int>::const_iterator b = order.begin(); b != order.end(); ++b) {
+		const std::vector<unsigned int>& bucket = members[*b];
+		if (bucket.empty())
+			break;
+
+		unsigned int seed;
+		for (seed = 1U; seed < MAX_SEED; seed++) {
+			positions.clear();
+
+			bool ok = true;
+			for (std::vector<unsigned int>::const_iterator k = bucket.begin(); k != bucket.end() && ok; ++k) {
+				unsigned int pos = DMRIdHash(keys[*k].c_str(), seed) % slots;
+				if (used[pos] || std::find(positions.begin(), positions.end(), pos) != positions.end())
+					ok = false;
+				else
+					positions.push_back(pos);
+			}
+
+			if (ok)
+				break;
+		}
+
+		if (seed == MAX_SEED)
+			return false;
+
+		seeds[*b] = seed;
+		for (unsigned int i = 0U; i < bucket.size(); i++) {
+			used[positions[i]]  = true;
+			table[positions[i]] = entries[bucket[i]];
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc != 3) {
+		::fprintf(stderr, "Usage: DMRIdCompile <DMRIds.dat> <DMRIds.bin>\n");
+		return 1;
+	}
+
+	FILE* in = ::fopen(argv[1], "rt");
+	if (in == NULL) {
+		::fprintf(stderr, "DMRIdCompile: cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	// Parsed exactly as CDMRLookup reads the text file, later lines win for both directions
+	std::map<unsigned int, std::string> ids;
+	std::map<std::string, unsigned int> callsigns;
+
+	char buffer[100U];
+	while (::fgets(buffer, 100U, in) != NULL) {
+		if (buffer[0U] == '#')
+			continue;
+
+		char* p1 = ::strtok(buffer, " \t\r\n");
+		char* p2 = ::strtok(NULL, " \t\r\n");
+
+		if (p1 != NULL && p2 != NULL) {
+			unsigned int id = (unsigned int)::atoi(p1);
+			for (char* p = p2; *p != 0x00U; p++)
+				*p = ::toupper(*p);
+
+			ids[id] = std::string(p2);
+			callsigns[p2] = id;
+		}
+	}
+
+	::fclose(in);
+
+	if (ids.empty()) {
+		::fprintf(stderr, "DMRIdCompile: no Ids found in %s\n", argv[1]);
+		return 1;
+	}
+
+	// Every distinct callsign is stored once
+	std::string strings;
+	std::map<std::string, unsigned int> offsets;
+	for (std::map<std::string, unsigned int>::const_iterator it = callsigns.begin(); it != callsigns.end(); ++it) {
+		offsets[it->first] = strings.size();
+		strings += it->first;
+		strings += '\0';
+	}
+
+	std::vector<CDMRIdRecord> records;
+	for (std::map<unsigned int, std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it) {
+		CDMRIdRecord record;
+		record.m_id       = it->first;
+		record.m_callsign = offsets[it->second];
+		records.push_back(record);
+	}
+
+	std::vector<std::string> keys;
+	std::vector<CDMRIdRecord> entries;
+	for (std::map<std::string, unsigned int>::const_iterator it = callsigns.begin(); it != callsigns.end(); ++it) {
+		CDMRIdRecord entry;
+		entry.m_id       = it->second;
+		entry.m_callsign = offsets[it->first];
+		keys.push_back(it->first);
+		entries.push_back(entry);
+	}
+
+	unsigned int buckets = keys.size() / 4U + 1U;
+	unsigned int slots   = keys.size() + keys.size() / 8U + 1U;
+
+	std::vector<unsigned int> seeds;
+	std::vector<CDMRIdRecord> table;
+	while (!buildHash(keys, entries, buckets, slots, seeds, table))
+		slots += slots / 8U;
+
+	CDMRIdHeader header;
+	::memset(&header, 0x00U, sizeof(header));
+	::memcpy(header.m_magic, DMRID_MAGIC, DMRID_MAGIC_LENGTH);
+	header.m_records      = records.size();
+	header.m_buckets      = buckets;
+	header.m_slots        = slots;
+	header.m_recordOffset = align(sizeof(header));
+	header.m_bucketOffset = align(header.m_recordOffset + records.size() * sizeof(CDMRIdRecord));
+	header.m_slotOffset   = align(header.m_bucketOffset + buckets * sizeof(unsigned int));
+	header.m_stringOffset = align(header.m_slotOffset + slots * sizeof(CDMRIdRecord));
+	header.m_stringLength = strings.size();
+
+	std::string temp = std::string(argv[2]) + ".tmp";
+	FILE* out = ::fopen(temp.c_str(), "wb");
+	if (out == NULL) {
+		::fprintf(stderr, "DMRIdCompile: cannot create %s\n", temp.c_str());
+		return 1;
+	}
+
+	std::vector<unsigned char> image(header.m_stringOffset + header.m_stringLength, 0x00U);
+	::memcpy(&image[0U], &header, sizeof(header));
+	::memcpy(&image[header.m_recordOffset], &records[0U], records.size() * sizeof(CDMRIdRecord));
+	::memcpy(&image[header.m_bucketOffset], &seeds[0U], buckets * sizeof(unsigned int));
+	::memcpy(&image[header.m_slotOffset], &table[0U], slots * sizeof(CDMRIdRecord));
+	::memcpy(&image[header.m_stringOffset], strings.data(), strings.size());
+
+	bool ok = ::fwrite(&image[0U], 1U, image.size(), out) == image.size();
+	ok = (::fclose(out) == 0) && ok;
+
+	if (!ok || ::rename(temp.c_str(), argv[2]) != 0) {
+		::fprintf(stderr, "DMRIdCompile: cannot write %s\n", argv[2]);
+		::remove(temp.c_str());
+		return 1;
+	}
+
+	::fprintf(stdout, "DMRIdCompile: %u Ids and %u callsigns written to %s, %u bytes\n", header.m_records, (unsigned int)keys.size(), argv[2], (unsigned int)image.size());
+
+	return 0;
+}
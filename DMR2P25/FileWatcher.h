@@ -0,0 +1,51 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef	FileWatcher_H
+#define	FileWatcher_H
+
+#include <string>
+
+// Reports when a file has been rewritten or replaced. The directory is watched
+// rather than the file so that a file replaced by a rename is still seen. When
+// inotify is not available open() fails and the caller keeps its reload timer.
+class CFileWatcher {
+public:
+	CFileWatcher(const std::string& filename);
+	~CFileWatcher();
+
+	bool open();
+
+	// Returns true once for each batch of changes, never blocks
+	bool hasChanged();
+
+	// Waits up to ms milliseconds for a change
+	bool wait(unsigned int ms);
+
+	bool isOpen() const;
+
+	void close();
+
+private:
+	std::string m_directory;
+	std::string m_name;
+	int         m_fd;
+	int         m_wd;
+};
+
+#endif
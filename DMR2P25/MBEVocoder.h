@@ -23,6 +23,10 @@
 
 #include <stdint.h>
 #include <imbe_vocoder_api.h>
+#if defined(NATIVE_AMBE)
+#include "mbeenc.h"
+#include "mbedec.h"
+#endif
 
 class MBEVocoder {
 public:
@@ -30,10 +34,24 @@ public:
 	void encode_4400(int16_t *, uint8_t *);
 	void decode_2450(int16_t *, uint8_t *);
 	void encode_2450(int16_t *, uint8_t *);
+	void transcode_4400_2450(uint8_t *, uint8_t *);
+
+	// Batches of n consecutive frames, e.g. a P25 LDU or a DMR burst. PCM
+	// frames are 160 samples, IMBE frames 11 bytes and AMBE frames 7 bytes.
+	void decode_4400(int16_t *, uint8_t *, unsigned int);
+	void encode_4400(int16_t *, uint8_t *, unsigned int);
+	void decode_2450(int16_t *, uint8_t *, unsigned int);
+	void encode_2450(int16_t *, uint8_t *, unsigned int);
+	void transcode_4400_2450(uint8_t *, uint8_t *, unsigned int);
 	MBEVocoder(void);
 
 private:
 	imbe_vocoder vocoder;
+	void unpack_4400(int16_t *, uint8_t *);
+#if defined(NATIVE_AMBE)
+	MBEEncoder *m_mbeenc49;
+	MBEDecoder *m_mbedec;
+#endif
 };
 
 #endif /* INCLUDED_AMBE_ENCODER_H */
@@ -27,6 +27,7 @@
 #include <cstdio>
 #include <cassert>
 #include <cstring>
+#include <ctime>
 
 const unsigned char BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
 
@@ -455,145 +456,169 @@ const unsigned int C_TABLE[] = { 46U, 50U, 54U, 58U, 62U, 66U, 70U,  3U,  7U, 11
 const unsigned char AMBE_SILENCE[] = {0xB9U, 0xE8U, 0x81U, 0x52U, 0x61U, 0x73U, 0x00U, 0x2AU, 0x6BU};
 const unsigned char IMBE_SILENCE[] = {0x04U, 0x0CU, 0xFDU, 0x7BU, 0xFBU, 0x7DU, 0xF2U, 0x7BU, 0x3DU, 0x9EU, 0x44};
 
+// Offset of the IMBE frame in the P25 network records 0x62 - 0x6A (LDU1) and 0x6B - 0x73 (LDU2)
+const unsigned int IMBE_OFFSET[] = {10U, 1U, 5U, 5U, 5U, 5U, 5U, 5U, 4U, 10U, 1U, 5U, 5U, 5U, 5U, 5U, 5U, 4U};
+
 CModeConv::CModeConv() :
 m_p25N(0U),
 m_dmrN(0U),
 m_P25(5000U, "DMR2P25"),
-m_DMR(5000U, "P252DMR")
+m_DMR(5000U, "P252DMR"),
+m_direct(false),
+m_dmrFrames(0U),
+m_dmrSilence(0U),
+m_dmrCPU(0U),
+m_p25Frames(0U),
+m_p25Silence(0U),
+m_imbeN(0U)
 {
 	m_mbe = new MBEVocoder();
+
+	::memset(m_p25Batches, 0, sizeof(m_p25Batches));
+	::memset(m_p25BatchVoice, 0, sizeof(m_p25BatchVoice));
+	::memset(m_p25BatchCPU, 0, sizeof(m_p25BatchCPU));
 }
 
 CModeConv::~CModeConv()
 {
 }
 
+void CModeConv::setDirectTranscode(bool direct)
+{
+	m_direct = direct;
+}
+
+// CPU time used by this thread, in nanoseconds
+static uint64_t threadCPUTime()
+{
+	struct timespec ts;
+	::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec);
+}
+
 void CModeConv::putDMR(unsigned char* data)
 {
 	assert(data != NULL);
-	
-	int16_t audio[160U];
-	uint8_t ambe[9U];
-	uint8_t v_ambe[9U];
-	uint8_t imbe[11U];
-	
-	::memset(audio, 0, sizeof(audio));
-	::memset(ambe, 0, sizeof(ambe));
-	::memset(v_ambe, 0, sizeof(v_ambe));
-	::memset(imbe, 0, sizeof(imbe));
-	
-	decode(data, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	m_mbe->encode_4400(audio, imbe);
-	m_P25.addData(&TAG_DATA, 1U);
-	m_P25.addData(imbe, 11U);
-	//CUtils::dump(1U, "NXDN Voice:", data, 9U);
-	m_p25N += 1U;
-	
+
+	int16_t audio[DMR_BURST_FRAMES * 160U];
+	uint8_t frames[DMR_BURST_FRAMES * 9U];
+	uint8_t ambe[DMR_BURST_FRAMES * 7U];
+	uint8_t imbe[DMR_BURST_FRAMES * 11U];
+	bool silence[DMR_BURST_FRAMES];
+
+	::memcpy(frames, data, 9U);
+
 	data += 9U;
 	for (unsigned int i = 0U; i < 4U; i++)
-		v_ambe[i] = data[i];
+		frames[i + 9U] = data[i];
 	
-	v_ambe[4U] = data[4U] & 0xF0;
-	v_ambe[4U] |= data[10U] & 0x0F;
+	frames[13U] = data[4U] & 0xF0;
+	frames[13U] |= data[10U] & 0x0F;
 	
 	for (unsigned int i = 0U; i < 4U; i++)
-		v_ambe[i + 5U] = data[i + 11U];
-
-	decode(v_ambe, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	m_mbe->encode_4400(audio, imbe);
-	m_P25.addData(&TAG_DATA, 1U);
-	m_P25.addData(imbe, 11U);
-	//CUtils::dump(1U, "NXDN Voice:", v_ambe, 9U);
-	m_p25N += 1U;
-	
-	data += 15U;;
-	decode(data, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	m_mbe->encode_4400(audio, imbe);
-	m_P25.addData(&TAG_DATA, 1U);
-	m_P25.addData(imbe, 11U);
-	//CUtils::dump(1U, "NXDN Voice:", data, 9U);
-	m_p25N += 1U;
+		frames[i + 14U] = data[i + 11U];
+
+	data += 15U;
+	::memcpy(frames + 18U, data, 9U);
+
+	::memset(ambe, 0, sizeof(ambe));
+	::memset(imbe, 0, sizeof(imbe));
+
+	// Silence maps straight to silence, only speech goes through the vocoders
+	unsigned int voice = 0U;
+	for (unsigned int i = 0U; i < DMR_BURST_FRAMES; i++) {
+		silence[i] = ::memcmp(frames + i * 9U, AMBE_SILENCE, 9U) == 0;
+		if (!silence[i])
+			decode(frames + i * 9U, ambe + voice++ * 7U, 0U);
+	}
+
+	if (voice > 0U) {
+		uint64_t start = threadCPUTime();
+
+		m_mbe->decode_2450(audio, ambe, voice);
+		m_mbe->encode_4400(audio, imbe, voice);
+
+		m_dmrCPU += threadCPUTime() - start;
+	}
+
+	m_dmrFrames += DMR_BURST_FRAMES;
+	m_dmrSilence += DMR_BURST_FRAMES - voice;
+
+	unsigned int n = 0U;
+	for (unsigned int i = 0U; i < DMR_BURST_FRAMES; i++) {
+		m_P25.addData(&TAG_DATA, 1U);
+		m_P25.addData(silence[i] ? IMBE_SILENCE : imbe + n++ * 11U, 11U);
+		m_p25N += 1U;
+	}
 }
 
 void CModeConv::putP25(unsigned char* data)
 {
 	assert(data != NULL);
 
-	int16_t audio[160U];
-	uint8_t ambe[9U];
-	uint8_t imbe[11U];
-	uint8_t vch[10U];
-	::memset(audio, 0, sizeof(audio));
+	// Only the voice records of LDU1 and LDU2 carry IMBE
+	if (data[0U] < 0x62U || data[0U] > 0x73U)
+		return;
+
+	unsigned int n = data[0U] - 0x62U;
+	::memcpy(m_imbe + m_imbeN * 11U, data + IMBE_OFFSET[n], 11U);
+	m_imbeN++;
+
+	// Transcode whole LDUs, nine frames make exactly three DMR bursts
+	if (n == 8U || n == 17U || m_imbeN == P25_LDU_FRAMES)
+		putP25Batch();
+}
+
+void CModeConv::putP25Batch()
+{
+	int16_t audio[P25_LDU_FRAMES * 160U];
+	uint8_t imbe[P25_LDU_FRAMES * 11U];
+	uint8_t ambe[P25_LDU_FRAMES * 7U];
+	bool silence[P25_LDU_FRAMES];
+
 	::memset(ambe, 0, sizeof(ambe));
-	switch (data[0U]) {
-	case 0x62U:
-		::memcpy(imbe, data + 10U, 11U);
-		break;
-	case 0x63U:
-		::memcpy(imbe, data + 1U, 11U);
-		break;
-	case 0x64U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x65U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x66U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x67U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x68U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x69U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x6AU:
-		::memcpy(imbe, data + 4U, 11U);
-		break;
-	case 0x6BU:
-		::memcpy(imbe, data + 10U, 11U);
-		break;
-	case 0x6CU:
-		::memcpy(imbe, data + 1U, 11U);
-		break;
-	case 0x6DU:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x6EU:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x6FU:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x70U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x71U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x72U:
-		::memcpy(imbe, data + 5U, 11U);
-		break;
-	case 0x73U:
-		::memcpy(imbe, data + 4U, 11U);
-		break;
-	default:
-		break;
+
+	// Silence maps straight to silence, only speech goes through the vocoders
+	unsigned int voice = 0U;
+	for (unsigned int i = 0U; i < m_imbeN; i++) {
+		silence[i] = ::memcmp(m_imbe + i * 11U, IMBE_SILENCE, 11U) == 0;
+		if (!silence[i])
+			::memcpy(imbe + voice++ * 11U, m_imbe + i * 11U, 11U);
+	}
+
+	if (voice > 0U) {
+		uint64_t start = threadCPUTime();
+
+		if (m_direct) {
+			m_mbe->transcode_4400_2450(imbe, ambe, voice);
+		} else {
+			m_mbe->decode_4400(audio, imbe, voice);
+			m_mbe->encode_2450(audio, ambe, voice);
+		}
+
+		m_p25BatchCPU[m_imbeN] += threadCPUTime() - start;
+		m_p25BatchVoice[m_imbeN] += voice;
 	}
-	
-	m_mbe->decode_4400(audio, imbe);
-	m_mbe->encode_2450(audio, ambe);
-	
-	encode(ambe, vch, 0U);
-	m_DMR.addData(&TAG_DATA, 1U);
-	m_DMR.addData(vch, 9U);
-	m_dmrN += 1U;
+
+	m_p25Batches[m_imbeN]++;
+	m_p25Frames += m_imbeN;
+	m_p25Silence += m_imbeN - voice;
+
+	unsigned int n = 0U;
+	for (unsigned int i = 0U; i < m_imbeN; i++) {
+		m_DMR.addData(&TAG_DATA, 1U);
+		if (silence[i]) {
+			m_DMR.addData(AMBE_SILENCE, 9U);
+		} else {
+			unsigned char vch[9U];
+			encode(ambe + n++ * 7U, vch, 0U);
+			m_DMR.addData(vch, 9U);
+		}
+		m_dmrN += 1U;
+	}
+
+	m_imbeN = 0U;
 
 	//CUtils::dump(1U, "P25 IMBE unpacked:", imbe, 11U);
 }
@@ -604,6 +629,10 @@ void CModeConv::putP25Header()
 
 	::memset(vch, 0, 11U);
 
+	// Keep the order of anything received before the header
+	if (m_imbeN > 0U)
+		putP25Batch();
+
 	m_DMR.addData(&TAG_HEADER, 1U);
 	m_DMR.addData(vch, 9U);
 	m_dmrN += 1U;
@@ -614,6 +643,10 @@ void CModeConv::putP25EOT()
 	unsigned char imbe[11U];
 
 	::memset(imbe, 0, 11U);
+
+	// A short last LDU
+	if (m_imbeN > 0U)
+		putP25Batch();
 	
 	unsigned int fill = 3U - (m_dmrN % 3U);
 	for (unsigned int i = 0U; i < fill; i++) {
@@ -625,6 +658,20 @@ void CModeConv::putP25EOT()
 	m_DMR.addData(&TAG_EOT, 1U);
 	m_DMR.addData(imbe, 9U);
 	m_dmrN += 1U;
+
+	if (m_p25Frames > 0U) {
+		LogMessage("P25 to DMR: %u frames, %u silent (%.1f%%) not transcoded", m_p25Frames, m_p25Silence, 100.0F * float(m_p25Silence) / float(m_p25Frames));
+		for (unsigned int n = 1U; n <= P25_LDU_FRAMES; n++) {
+			if (m_p25BatchVoice[n] > 0U)
+				LogMessage("P25 to DMR %s transcoding: %u batches of %u frames, %.1f us CPU per frame", m_direct ? "direct" : "tandem", m_p25Batches[n], n, float(m_p25BatchCPU[n]) / float(m_p25BatchVoice[n]) / 1000.0F);
+		}
+	}
+
+	m_p25Frames = 0U;
+	m_p25Silence = 0U;
+	::memset(m_p25Batches, 0, sizeof(m_p25Batches));
+	::memset(m_p25BatchVoice, 0, sizeof(m_p25BatchVoice));
+	::memset(m_p25BatchCPU, 0, sizeof(m_p25BatchCPU));
 }
 
 void CModeConv::putDMRHeader()
@@ -647,6 +694,17 @@ void CModeConv::putDMREOT()
 	m_P25.addData(&TAG_EOT, 1U);
 	m_P25.addData(vch, 11U);
 	m_p25N += 1U;
+
+	if (m_dmrFrames > 0U) {
+		unsigned int voice = m_dmrFrames - m_dmrSilence;
+		LogMessage("DMR to P25: %u frames, %u silent (%.1f%%) not transcoded", m_dmrFrames, m_dmrSilence, 100.0F * float(m_dmrSilence) / float(m_dmrFrames));
+		if (voice > 0U)
+			LogMessage("DMR to P25 transcoding: batches of %u frames, %.1f us CPU per frame", DMR_BURST_FRAMES, float(m_dmrCPU) / float(voice) / 1000.0F);
+	}
+
+	m_dmrFrames = 0U;
+	m_dmrSilence = 0U;
+	m_dmrCPU = 0U;
 }
 
 unsigned int CModeConv::getDMR(unsigned char* data)
@@ -19,10 +19,13 @@
 #if !defined(Reflectors_H)
 #define	Reflectors_H
 
-#include "Timer.h"
+#include "Thread.h"
 
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
 
 class CReflector {
 public:
@@ -38,21 +41,33 @@ public:
 	unsigned int m_startup;
 };
 
-class CReflectors {
+// The reflectors are reloaded on a thread of their own into a new table, which is then
+// published in place of the old one, so that a lookup never waits for the file.
+class CReflectors : public CThread {
 public:
 	CReflectors(const std::string& hostsFile, unsigned int reloadTime);
-	~CReflectors();
+	virtual ~CReflectors();
 
-	bool load();
+	bool read();
+
+	virtual void entry();
 
-	CReflector* find(unsigned int id);
+	bool find(unsigned int id, CReflector& reflector);
 
-    void clock(unsigned int ms);
+	void stop();
 
 private:
-	std::string              m_hostsFile;
-	std::vector<CReflector*> m_reflectors;
-    CTimer                   m_timer;
+	typedef std::unordered_map<unsigned int, CReflector> CReflectorTable;
+
+	std::string                            m_hostsFile;
+	unsigned int                           m_reloadTime;
+	std::shared_ptr<const CReflectorTable> m_reflectors;
+	std::atomic<unsigned int>              m_maxLookup;
+	bool                                   m_started;
+	bool                                   m_stop;
+
+	bool load();
+	void lookupTime(unsigned long long start);
 };
 
 #endif
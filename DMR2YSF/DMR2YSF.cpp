@@ -51,6 +51,7 @@ const char* HEADER4 = "Copyright(C) 2018 by CA6JAU, G4KLX, AD8DP and others";
 
 #include <functional>
 #include <algorithm>
+#include <unordered_map>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -107,6 +108,9 @@ m_callsign(),
 m_conf(configFile),
 m_dmrNetwork(NULL),
 m_ysfNetwork(NULL),
+m_ysfBuilder(NULL),
+m_ysfIdentities(),
+m_dmrIdentities(),
 m_conv(),
 m_colorcode(1U),
 m_srcid(1U),
@@ -264,6 +268,10 @@ int CDMR2YSF::run()
 	m_ysfNetwork = new CYSFNetwork(localAddress, localPort, m_callsign, ysfdebug);
 	m_ysfNetwork->setDestination(dstAddress, dstPort);
 
+	m_ysfBuilder = new CYSFFrameBuilder(m_ysfNetwork->getCallsign(), m_conf.getYsfRadioID());
+	m_ysfBuilder->setFICH(m_conf.getFICHCallSign(), m_conf.getFICHCallMode(), m_conf.getFICHFrameTotal(), m_conf.getFICHMessageRoute(), m_conf.getFICHVOIP(), m_conf.getFICHDataType(), m_conf.getFICHSQLType(), m_conf.getFICHSQLCode());
+	m_ysfBuilder->setDT(m_conf.getYsfDT1(), m_conf.getYsfDT2());
+
 	ret = m_ysfNetwork->open();
 	if (!ret) {
 		::LogError("Cannot open the YSF network port");
@@ -272,8 +280,10 @@ int CDMR2YSF::run()
 	}
 
 	ret = createMMDVM();
-	if (!ret)
+	if (!ret) {
+		::LogFinalise();
 		return 1;
+	}
 
 	LogMessage("Waiting for MMDVM to connect.....");
 
@@ -290,6 +300,7 @@ int CDMR2YSF::run()
 	if (m_killed) {
 		m_dmrNetwork->close();
 		delete m_dmrNetwork;
+		::LogFinalise();
 		return 0;
 	}
 
@@ -309,6 +320,12 @@ int CDMR2YSF::run()
 	CTimer networkWatchdog(100U, 0U, 1500U);
 	CTimer pollTimer(1000U, 5U);
 
+	// An edited TG list is picked up without a restart
+	CFileWatcher tgWatcher(tgFile);
+	CTimer tgTimer(1000U, 1U);
+	if (tgWatcher.open())
+		tgTimer.start();
+
 	CStopWatch stopWatch;
 	CStopWatch ysfWatch;
 	CStopWatch dmrWatch;
@@ -357,6 +374,7 @@ int CDMR2YSF::run()
 							}
 						} else if (fi == YSF_FI_TERMINATOR) {
 							LogMessage("YSF received end of voice transmission, %.1f seconds", float(m_ysfFrames) / 10.0F);
+							m_ysfIdentities.remove(0U);
 							m_conv.putYSFEOT();
 							m_ysfFrames = 0U;
 						} else if (fi == YSF_FI_COMMUNICATIONS) {
@@ -535,6 +553,9 @@ int CDMR2YSF::run()
 			if (!tx_dmrdata.isMissing()) {
 				networkWatchdog.start();
 
+				if (DataType == DT_TERMINATOR_WITH_LC)
+					m_dmrIdentities.remove(tx_dmrdata.getStreamId());
+
 				if(DataType == DT_TERMINATOR_WITH_LC && m_dmrFrames > 0U) {
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
@@ -554,7 +575,7 @@ int CDMR2YSF::run()
 					::memcpy(gps_buffer, dt1_temp, 10U);
 					::memcpy(gps_buffer + 10U, dt2_temp, 10U);
 
-					m_netSrc = m_lookup->findCS(SrcId);
+					m_netSrc = findDMRCS(tx_dmrdata.getStreamId(), SrcId);
 					m_dstid = DstId;
 
 					m_netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(DstId);
@@ -583,7 +604,7 @@ int CDMR2YSF::run()
 					tx_dmrdata.getData(dmr_frame);
 
 					if (!m_dmrinfo) {
-						m_netSrc = m_lookup->findCS(SrcId);
+						m_netSrc = findDMRCS(tx_dmrdata.getStreamId(), SrcId);
 						m_dstid = DstId;
 
 						m_netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(DstId);
@@ -637,40 +658,8 @@ int CDMR2YSF::run()
 			if(ysfFrameType == TAG_HEADER) {
 				ysf_cnt = 0U;
 
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = 0U; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
-				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
-				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH);
- 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->setCall(m_netSrc, m_netDst);
+				m_ysfBuilder->getHeader(m_ysfFrame);
 
 				m_ysfNetwork->write(m_ysfFrame);
 
@@ -678,112 +667,14 @@ int CDMR2YSF::run()
 				ysfWatch.start();
 			}
 			else if (ysfFrameType == TAG_EOT) {
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = ysf_cnt; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
- 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->getTerminator(m_ysfFrame, ysf_cnt);
 
 				m_ysfNetwork->write(m_ysfFrame);
 			}
 			else if (ysfFrameType == TAG_DATA) {
-
-				CYSFFICH fich;
-				CYSFPayload ysfPayload;
-				unsigned char dch[10U];
-
-				unsigned int fn = (ysf_cnt - 1U) % (m_conf.getFICHFrameTotal() + 1);
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-
-				// Add the YSF Sync
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				switch (fn) {
-					case 0:
-						memset(dch, '*', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);
-						break;
-					case 1:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_netSrc.c_str());
-						break;
-					case 2:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_netDst.c_str());
-						break;
-					case 5:
-						memset(dch, ' ', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);	// Rem3/4
- 						break;
-					case 6: {
-							unsigned char dt1[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT1().size() && i < 10U; i++)
-								dt1[i] = m_conf.getYsfDT1()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt1);
-						}
-						break;
-					case 7: {
-							unsigned char dt2[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT2().size() && i < 10U; i++)
-								dt2[i] = m_conf.getYsfDT2()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt2);
-						}
-						break;
-					default:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
-				}
-
-				// Set the FICH
-				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
-				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				// Net frame counter
-				m_ysfFrame[34U] = (ysf_cnt & 0x7FU) << 1;
+				// Only encodes again when a late entry has changed the names
+				m_ysfBuilder->setCall(m_netSrc, m_netDst);
+				m_ysfBuilder->getData(m_ysfFrame, ysf_cnt);
 
 				// Send data
 				m_ysfNetwork->write(m_ysfFrame);
@@ -804,6 +695,13 @@ int CDMR2YSF::run()
 			pollTimer.start();
 		}
 
+		tgTimer.clock(ms);
+		if (tgTimer.isRunning() && tgTimer.hasExpired()) {
+			if (tgWatcher.hasChanged())
+				readTGList(tgFile);
+			tgTimer.start();
+		}
+
 		if (ms < 5U)
 			CThread::sleep(5U);
 	}
@@ -813,56 +711,96 @@ int CDMR2YSF::run()
 
 	delete m_dmrNetwork;
 	delete m_ysfNetwork;
+	delete m_ysfBuilder;
+
+	LogMessage("Identity cache, YSF sources: %u hits, %u misses, DMR sources: %u hits, %u misses", m_ysfIdentities.getHits(), m_ysfIdentities.getMisses(), m_dmrIdentities.getHits(), m_dmrIdentities.getMisses());
 
 	::LogFinalise();
 
 	return 0;
 }
 
+// Pairs still in the file are updated in place, so a reload only touches the ones that were added, removed or changed
 void CDMR2YSF::readTGList(std::string filename)
 {
 	// Load file with TG List
 	FILE* fp = ::fopen(filename.c_str(), "rt");
+	if (fp == NULL) {
+		LogInfo("Loaded %u DMR-TG / YSF-ID pairs", (unsigned int)m_currTGList.size());
+		return;
+	}
 
-	unsigned int count = 0U;
+	std::unordered_multimap<unsigned int, CTGReg*> current;
+	for (std::vector<CTGReg*>::const_iterator it = m_currTGList.begin(); it != m_currTGList.end(); ++it)
+		current.insert(std::make_pair((*it)->m_tg, *it));
 
-	if (fp != NULL) {
-		char buffer[100U];
-		while (::fgets(buffer, 100U, fp) != NULL) {
-			if (buffer[0U] == '#')
-				continue;
-
-			char* p1 = ::strtok(buffer, ";\r\n");
-			char* p2 = ::strtok(NULL, ";\r\n");
-
-			if (p1 != NULL && p2 != NULL) {
-				CTGReg* tgreg = new CTGReg;
-
-				tgreg->m_tg = atoi(p1);
-				int ysf_id = atoi(p2);
-
-				if (ysf_id) {
-					tgreg->m_ysf = ysf_id;
-				} else {
-					for (std::vector<CFCSReg*>::iterator it = m_FCSList.begin(); it != m_FCSList.end(); ++it) {
-						std::string fcsname = p2;
-						if (fcsname == (*it)->m_fcs) {
-							LogInfo("FCS: %d, %s", (*it)->m_id, (*it)->m_fcs.c_str());
-							tgreg->m_ysf = (*it)->m_id;
-						}
+	bool initial = m_currTGList.empty();
+
+	unsigned int added   = 0U;
+	unsigned int changed = 0U;
+
+	std::vector<CTGReg*> list;
+
+	char buffer[100U];
+	while (::fgets(buffer, 100U, fp) != NULL) {
+		if (buffer[0U] == '#')
+			continue;
+
+		char* p1 = ::strtok(buffer, ";\r\n");
+		char* p2 = ::strtok(NULL, ";\r\n");
+
+		if (p1 != NULL && p2 != NULL) {
+			unsigned int tg = atoi(p1);
+			unsigned int ysf = 0U;
+
+			int ysf_id = atoi(p2);
+
+			if (ysf_id) {
+				ysf = ysf_id;
+			} else {
+				for (std::vector<CFCSReg*>::iterator it = m_FCSList.begin(); it != m_FCSList.end(); ++it) {
+					std::string fcsname = p2;
+					if (fcsname == (*it)->m_fcs) {
+						LogInfo("FCS: %d, %s", (*it)->m_id, (*it)->m_fcs.c_str());
+						ysf = (*it)->m_id;
 					}
 				}
+			}
 
-				m_currTGList.push_back(tgreg);
+			CTGReg* tgreg = NULL;
 
-				count++;
+			std::unordered_multimap<unsigned int, CTGReg*>::iterator it = current.find(tg);
+			if (it != current.end()) {
+				tgreg = it->second;
+				current.erase(it);
+
+				if (tgreg->m_ysf != ysf)
+					changed++;
+			} else {
+				tgreg = new CTGReg;
+				added++;
 			}
-		}
 
-		::fclose(fp);
+			tgreg->m_tg  = tg;
+			tgreg->m_ysf = ysf;
+
+			list.push_back(tgreg);
+		}
 	}
 
-	LogInfo("Loaded %u DMR-TG / YSF-ID pairs", count);
+	::fclose(fp);
+
+	for (std::unordered_multimap<unsigned int, CTGReg*>::iterator it = current.begin(); it != current.end(); ++it)
+		delete it->second;
+
+	unsigned int removed = (unsigned int)current.size();
+
+	m_currTGList.swap(list);
+
+	if (initial)
+		LogInfo("Loaded %u DMR-TG / YSF-ID pairs", (unsigned int)m_currTGList.size());
+	else if (added > 0U || removed > 0U || changed > 0U)
+		LogInfo("Updated the DMR-TG / YSF-ID pairs, %u pairs, %u added, %u removed, %u changed", (unsigned int)m_currTGList.size(), added, removed, changed);
 }
 
 void CDMR2YSF::readFCSRoomsFile(const std::string& filename)
@@ -899,26 +837,36 @@ void CDMR2YSF::readFCSRoomsFile(const std::string& filename)
 
 unsigned int CDMR2YSF::findYSFID(std::string cs, bool showdst)
 {
-	std::string cstrim;
 	bool dmrpc = false;
 
-	int first = cs.find_first_not_of(' ');
-	int mid1 = cs.find_last_of('-');
-	int mid2 = cs.find_last_of('/');
-	int last = cs.find_last_not_of(' ');
-
-	if (mid1 == -1 && mid2 == -1 && first == -1 && last == -1)
-		cstrim = "N0CALL";
-	else if (mid1 == -1 && mid2 == -1)
-		cstrim = cs.substr(first, (last - first + 1));
-	else if (mid1 > first)
-		cstrim = cs.substr(first, (mid1 - first));
-	else if (mid2 > first)
-		cstrim = cs.substr(first, (mid2 - first));
-	else
-		cstrim = "N0CALL";
+	// YSF has no stream id, the entry is dropped at the end of each transmission instead
+	CIdentity identity;
+	if (!m_ysfIdentities.find(0U, (const unsigned char*)cs.c_str(), cs.size(), identity)) {
+		std::string cstrim;
+
+		int first = cs.find_first_not_of(' ');
+		int mid1 = cs.find_last_of('-');
+		int mid2 = cs.find_last_of('/');
+		int last = cs.find_last_not_of(' ');
+
+		if (mid1 == -1 && mid2 == -1 && first == -1 && last == -1)
+			cstrim = "N0CALL";
+		else if (mid1 == -1 && mid2 == -1)
+			cstrim = cs.substr(first, (last - first + 1));
+		else if (mid1 > first)
+			cstrim = cs.substr(first, (mid1 - first));
+		else if (mid2 > first)
+			cstrim = cs.substr(first, (mid2 - first));
+		else
+			cstrim = "N0CALL";
 
-	unsigned int id = m_lookup->findID(cstrim);
+		identity.m_id       = m_lookup->findID(cstrim);
+		identity.m_callsign = cstrim;
+		m_ysfIdentities.add(0U, (const unsigned char*)cs.c_str(), cs.size(), identity);
+	}
+
+	const std::string& cstrim = identity.m_callsign;
+	unsigned int id = identity.m_id;
 
 	if (m_dmrflco == FLCO_USER_USER)
 		dmrpc = true;
@@ -942,6 +890,23 @@ unsigned int CDMR2YSF::findYSFID(std::string cs, bool showdst)
 	return id;
 }
 
+// The callsign of a DMR source, looked up once per stream
+std::string CDMR2YSF::findDMRCS(unsigned int stream, unsigned int id)
+{
+	unsigned char source[3U];
+	source[0U] = id >> 16;
+	source[1U] = id >> 8;
+	source[2U] = id >> 0;
+
+	CIdentity identity;
+	if (!m_dmrIdentities.find(stream, source, 3U, identity)) {
+		identity.m_callsign = m_lookup->findCS(id);
+		m_dmrIdentities.add(stream, source, 3U, identity);
+	}
+
+	return identity.m_callsign;
+}
+
 std::string CDMR2YSF::getSrcYSF(const unsigned char* buffer)
 {
 	unsigned char temp[YSF_CALLSIGN_LENGTH + 1U];
@@ -28,11 +28,14 @@
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
+#include "IdentityCache.h"
+#include "FileWatcher.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
 #include "Version.h"
 #include "YSFPayload.h"
 #include "YSFNetwork.h"
+#include "YSFFrameBuilder.h"
 #include "YSFFICH.h"
 #include "Thread.h"
 #include "Timer.h"
@@ -81,7 +84,10 @@ private:
 	CConf                  m_conf;
 	CMMDVMNetwork*         m_dmrNetwork;
 	CYSFNetwork*           m_ysfNetwork;
+	CYSFFrameBuilder*      m_ysfBuilder;
 	CDMRLookup*            m_lookup;
+	CIdentityCache         m_ysfIdentities;
+	CIdentityCache         m_dmrIdentities;
 	CModeConv              m_conv;
 	unsigned int           m_colorcode;
 	unsigned int           m_srcid;
@@ -110,6 +116,7 @@ private:
 	void readTGList(std::string filename);
 	void readFCSRoomsFile(const std::string& filename);
 	unsigned int findYSFID(std::string cs, bool showdst);
+	std::string findDMRCS(unsigned int stream, unsigned int id);
 	std::string getSrcYSF(const unsigned char* source);
 	void connectYSF(unsigned int id);
 	void sendYSFConn(unsigned int id);
@@ -36,6 +36,9 @@ public:
 	unsigned long long start();
 	unsigned int       elapsed();
 
+	// A monotonic time in microseconds, for timestamps compared between classes
+	static unsigned long long getMicroseconds();
+
 private:
 #if defined(_WIN32) || defined(_WIN64)
 	LARGE_INTEGER  m_frequencyS;
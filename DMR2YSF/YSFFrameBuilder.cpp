@@ -0,0 +1,230 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "YSFFrameBuilder.h"
+#include "YSFDefines.h"
+#include "YSFPayload.h"
+#include "YSFFICH.h"
+
+#include <cassert>
+#include <cstring>
+
+const unsigned int YSF_NET_HEADER_LENGTH = 34U;
+const unsigned int YSF_SYNC_FICH_LENGTH  = YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
+const unsigned int YSF_PAYLOAD_LENGTH    = YSF_FRAME_LENGTH_BYTES - YSF_SYNC_FICH_LENGTH;
+
+// The DCH of VD mode 2 is five blocks of five bytes, each followed by voice
+const unsigned int YSF_DCH_BLOCKS       = 5U;
+const unsigned int YSF_DCH_BLOCK_LENGTH = 5U;
+const unsigned int YSF_VD2_BLOCK_LENGTH = 18U;
+
+CYSFFrameBuilder::CYSFFrameBuilder(const std::string& callsign, const std::string& radioID) :
+m_radioID(radioID),
+m_source(),
+m_destination(),
+m_frameTotal(0U)
+{
+	m_radioID.resize(YSF_CALLSIGN_LENGTH / 2U, ' ');
+
+	std::string gateway = callsign;
+	gateway.resize(YSF_CALLSIGN_LENGTH, ' ');
+
+	::memcpy(m_net + 0U, "YSFD", 4U);
+	::memcpy(m_net + 4U, gateway.c_str(), YSF_CALLSIGN_LENGTH);
+	::memcpy(m_net + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
+
+	::memset(m_headerFICH, 0x00U, YSF_SYNC_FICH_LENGTH);
+	::memset(m_terminatorFICH, 0x00U, YSF_SYNC_FICH_LENGTH);
+	::memset(m_dataFICH, 0x00U, YSF_FRAME_NUMBERS * YSF_SYNC_FICH_LENGTH);
+
+	unsigned char dch[YSF_CALLSIGN_LENGTH];
+
+	// Radio ID and Rem3/4
+	::memset(dch, '*', YSF_CALLSIGN_LENGTH / 2U);
+	::memcpy(dch + YSF_CALLSIGN_LENGTH / 2U, m_radioID.c_str(), YSF_CALLSIGN_LENGTH / 2U);
+	encodeDCH(0U, dch);
+
+	::memset(dch, ' ', YSF_CALLSIGN_LENGTH / 2U);
+	encodeDCH(5U, dch);
+
+	::memset(dch, ' ', YSF_CALLSIGN_LENGTH);
+	encodeDCH(3U, dch);
+	encodeDCH(4U, dch);
+
+	::memset(dch, 0x00U, YSF_CALLSIGN_LENGTH);
+	encodeDCH(6U, dch);
+	encodeDCH(7U, dch);
+
+	encodeCall();
+}
+
+CYSFFrameBuilder::~CYSFFrameBuilder()
+{
+}
+
+void CYSFFrameBuilder::setFICH(unsigned char callSign, unsigned char callMode, unsigned char frameTotal, unsigned char messageRoute, bool voip, unsigned char dataType, bool sql, unsigned char sqlCode)
+{
+	if (frameTotal >= YSF_FRAME_NUMBERS)
+		frameTotal = YSF_FRAME_NUMBERS - 1U;
+
+	m_frameTotal = frameTotal;
+
+	// The reserved bits are zero, rather than whatever the FICH was allocated with
+	const unsigned char RESERVED[] = {0x00U, 0x00U, 0x00U, 0x00U};
+
+	CYSFFICH fich;
+	fich.load(RESERVED);
+	fich.setCS(callSign);
+	fich.setCM(callMode);
+	fich.setBN(0U);
+	fich.setBT(0U);
+	fich.setFT(frameTotal);
+	fich.setDev(0U);
+	fich.setMR(messageRoute);
+	fich.setVoIP(voip);
+	fich.setDT(dataType);
+	fich.setSQL(sql);
+	fich.setSQ(sqlCode);
+
+	fich.setFI(YSF_FI_HEADER);
+	fich.setFN(0U);
+	::memcpy(m_headerFICH, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+	fich.encode(m_headerFICH);
+
+	fich.setFI(YSF_FI_TERMINATOR);
+	::memcpy(m_terminatorFICH, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+	fich.encode(m_terminatorFICH);
+
+	fich.setFI(YSF_FI_COMMUNICATIONS);
+	for (unsigned int fn = 0U; fn < YSF_FRAME_NUMBERS; fn++) {
+		fich.setFN(fn);
+		::memcpy(m_dataFICH[fn], YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
+		fich.encode(m_dataFICH[fn]);
+	}
+}
+
+void CYSFFrameBuilder::setDT(const std::vector<unsigned char>& dt1, const std::vector<unsigned char>& dt2)
+{
+	unsigned char dt[YSF_CALLSIGN_LENGTH];
+
+	::memset(dt, 0x00U, YSF_CALLSIGN_LENGTH);
+	for (unsigned int i = 0U; i < dt1.size() && i < YSF_CALLSIGN_LENGTH; i++)
+		dt[i] = dt1[i];
+	encodeDCH(6U, dt);
+
+	::memset(dt, 0x00U, YSF_CALLSIGN_LENGTH);
+	for (unsigned int i = 0U; i < dt2.size() && i < YSF_CALLSIGN_LENGTH; i++)
+		dt[i] = dt2[i];
+	encodeDCH(7U, dt);
+}
+
+void CYSFFrameBuilder::setCall(const std::string& source, const std::string& destination)
+{
+	if (source == m_source && destination == m_destination)
+		return;
+
+	m_source      = source;
+	m_destination = destination;
+
+	encodeCall();
+}
+
+void CYSFFrameBuilder::encodeCall()
+{
+	std::string src = m_source;
+	src.resize(YSF_CALLSIGN_LENGTH, ' ');
+
+	std::string dst = m_destination;
+	dst.resize(YSF_CALLSIGN_LENGTH, ' ');
+
+	::memcpy(m_net + 14U, src.c_str(), YSF_CALLSIGN_LENGTH);
+
+	encodeDCH(1U, (const unsigned char*)src.c_str());
+	encodeDCH(2U, (const unsigned char*)dst.c_str());
+
+	unsigned char csd1[20U], csd2[20U];
+	::memset(csd1, '*', YSF_CALLSIGN_LENGTH / 2U);
+	::memcpy(csd1 + YSF_CALLSIGN_LENGTH / 2U, m_radioID.c_str(), YSF_CALLSIGN_LENGTH / 2U);
+	::memcpy(csd1 + YSF_CALLSIGN_LENGTH, src.c_str(), YSF_CALLSIGN_LENGTH);
+	::memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
+
+	unsigned char frame[YSF_FRAME_LENGTH_BYTES];
+	::memset(frame, 0x00U, YSF_FRAME_LENGTH_BYTES);
+
+	CYSFPayload payload;
+	payload.writeHeader(frame, csd1, csd2);
+
+	::memcpy(m_header, frame + YSF_SYNC_FICH_LENGTH, YSF_PAYLOAD_LENGTH);
+}
+
+void CYSFFrameBuilder::getHeader(unsigned char* data) const
+{
+	assert(data != NULL);
+
+	::memcpy(data, m_net, YSF_NET_HEADER_LENGTH);
+	data[34U] = 0U;			// Net frame counter
+	::memcpy(data + 35U, m_headerFICH, YSF_SYNC_FICH_LENGTH);
+	::memcpy(data + 35U + YSF_SYNC_FICH_LENGTH, m_header, YSF_PAYLOAD_LENGTH);
+}
+
+void CYSFFrameBuilder::getTerminator(unsigned char* data, unsigned int count) const
+{
+	assert(data != NULL);
+
+	::memcpy(data, m_net, YSF_NET_HEADER_LENGTH);
+	data[34U] = count;		// Net frame counter
+	::memcpy(data + 35U, m_terminatorFICH, YSF_SYNC_FICH_LENGTH);
+	::memcpy(data + 35U + YSF_SYNC_FICH_LENGTH, m_header, YSF_PAYLOAD_LENGTH);
+}
+
+void CYSFFrameBuilder::getData(unsigned char* data, unsigned int count) const
+{
+	assert(data != NULL);
+
+	unsigned int fn = (count - 1U) % (m_frameTotal + 1U);
+
+	::memcpy(data, m_net, YSF_NET_HEADER_LENGTH);
+	data[34U] = (count & 0x7FU) << 1;	// Net frame counter
+	::memcpy(data + 35U, m_dataFICH[fn], YSF_SYNC_FICH_LENGTH);
+
+	unsigned char* p1 = data + 35U + YSF_SYNC_FICH_LENGTH;
+	const unsigned char* p2 = m_dch[fn];
+	for (unsigned int i = 0U; i < YSF_DCH_BLOCKS; i++) {
+		::memcpy(p1, p2, YSF_DCH_BLOCK_LENGTH);
+		p1 += YSF_VD2_BLOCK_LENGTH; p2 += YSF_DCH_BLOCK_LENGTH;
+	}
+}
+
+void CYSFFrameBuilder::encodeDCH(unsigned int fn, const unsigned char* dt)
+{
+	assert(fn < YSF_FRAME_NUMBERS);
+	assert(dt != NULL);
+
+	unsigned char frame[YSF_FRAME_LENGTH_BYTES];
+	::memset(frame, 0x00U, YSF_FRAME_LENGTH_BYTES);
+
+	CYSFPayload payload;
+	payload.writeVDMode2Data(frame, dt);
+
+	const unsigned char* p1 = frame + YSF_SYNC_FICH_LENGTH;
+	unsigned char* p2 = m_dch[fn];
+	for (unsigned int i = 0U; i < YSF_DCH_BLOCKS; i++) {
+		::memcpy(p2, p1, YSF_DCH_BLOCK_LENGTH);
+		p1 += YSF_VD2_BLOCK_LENGTH; p2 += YSF_DCH_BLOCK_LENGTH;
+	}
+}
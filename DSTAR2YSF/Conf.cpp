@@ -43,6 +43,9 @@ m_rptr1(),
 m_rptr2(),
 m_suffix(),
 m_userTxt(),
+m_vocoderDevices(1U, "/dev/ttyUSB0"),
+m_vocoderChannels(1U),
+m_vocoderRequests(2U),
 m_dstarDstAddress(),
 m_dstarDstPort(0U),
 m_dstarLocalAddress(),
@@ -66,6 +69,7 @@ m_fichSQLCode(0U),
 m_ysfDT1(),
 m_ysfDT2(),
 m_ysfRadioID("*****"),
+m_ysfSettings(),
 m_ysfDebug(false),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
@@ -162,7 +166,15 @@ bool CConf::read()
 			m_userTxt = value;
 		}
 		else if(::strcmp(key, "VocoderDevice") == 0) {
-			m_vocoderDevice = value;
+			m_vocoderDevices.clear();
+			while ((t = strtok_r(value, ",", &value)) != NULL)
+				m_vocoderDevices.push_back(t);
+		}
+		else if(::strcmp(key, "VocoderChannels") == 0) {
+			m_vocoderChannels = (unsigned int)::atoi(value);
+		}
+		else if(::strcmp(key, "VocoderRequests") == 0) {
+			m_vocoderRequests = (unsigned int)::atoi(value);
 		}
 	} else if (section == SECTION_DSTAR_NETWORK) {
 			if (::strcmp(key, "DstAddress") == 0)
@@ -234,6 +246,8 @@ bool CConf::read()
 
   ::fclose(fp);
 
+  setYSFSettings();
+
   return true;
 }
 
@@ -267,9 +281,19 @@ std::string CConf::getUserTxt() const
   return m_userTxt;
 }
 
-std::string CConf::getVocoderDevice() const
+std::vector<std::string> CConf::getVocoderDevices() const
+{
+  return m_vocoderDevices;
+}
+
+unsigned int CConf::getVocoderChannels() const
+{
+  return m_vocoderChannels;
+}
+
+unsigned int CConf::getVocoderRequests() const
 {
-  return m_vocoderDevice;
+  return m_vocoderRequests;
 }
 
 std::string CConf::getDSTARDstAddress() const
@@ -387,6 +411,35 @@ std::string CConf::getYsfRadioID()
  	return m_ysfRadioID;
 }
 
+const CYSFSettings& CConf::getYSFSettings() const
+{
+	return m_ysfSettings;
+}
+
+void CConf::setYSFSettings()
+{
+	m_ysfSettings.m_callSign     = m_fichCallSign;
+	m_ysfSettings.m_callMode     = m_fichCallMode;
+	m_ysfSettings.m_frameTotal   = m_fichFrameTotal;
+	m_ysfSettings.m_messageRoute = m_fichMessageRoute;
+	m_ysfSettings.m_voip         = m_fichVOIP != 0U;
+	m_ysfSettings.m_dataType     = m_fichDataType;
+	m_ysfSettings.m_sql          = m_fichSQLType != 0U;
+	m_ysfSettings.m_sqlCode      = m_fichSQLCode;
+
+	::memset(m_ysfSettings.m_radioID, ' ', 5U);
+	for (unsigned int i = 0U; i < m_ysfRadioID.size() && i < 5U; i++)
+		m_ysfSettings.m_radioID[i] = m_ysfRadioID[i];
+
+	::memset(m_ysfSettings.m_dt1, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT1.size() && i < 10U; i++)
+		m_ysfSettings.m_dt1[i] = m_ysfDT1[i];
+
+	::memset(m_ysfSettings.m_dt2, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT2.size() && i < 10U; i++)
+		m_ysfSettings.m_dt2[i] = m_ysfDT2[i];
+}
+
 bool CConf::getYSFDebug() const
 {
 	return m_ysfDebug;
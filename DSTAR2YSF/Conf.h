@@ -23,6 +23,22 @@
 #include <string>
 #include <vector>
 
+// The YSF settings used by the per-frame code, typed and padded as they go on air. It is
+// copied out of the file by read(), so the frames are built without strings being made.
+struct CYSFSettings {
+  unsigned char m_callSign;
+  unsigned char m_callMode;
+  unsigned char m_frameTotal;
+  unsigned char m_messageRoute;
+  bool          m_voip;
+  unsigned char m_dataType;
+  bool          m_sql;
+  unsigned char m_sqlCode;
+  unsigned char m_radioID[5U];
+  unsigned char m_dt1[10U];
+  unsigned char m_dt2[10U];
+};
+
 class CConf
 {
 public:
@@ -38,7 +54,9 @@ public:
   std::string  getRptr2() const;
   std::string  getSuffix() const;
   std::string  getUserTxt() const;
-  std::string  getVocoderDevice() const;
+  std::vector<std::string> getVocoderDevices() const;
+  unsigned int getVocoderChannels() const;
+  unsigned int getVocoderRequests() const;
 
  // The DSTAR Network section
   bool         getDaemon() const;
@@ -67,6 +85,7 @@ public:
   std::vector<unsigned char> getYsfDT1();
   std::vector<unsigned char> getYsfDT2();
   std::string  getYsfRadioID();
+  const CYSFSettings& getYSFSettings() const;
   bool 		   getYSFDebug() const;
 
   // The Log section
@@ -83,7 +102,9 @@ private:
   std::string  m_rptr2;
   std::string  m_suffix;
   std::string  m_userTxt;
-  std::string  m_vocoderDevice;
+  std::vector<std::string> m_vocoderDevices;
+  unsigned int m_vocoderChannels;
+  unsigned int m_vocoderRequests;
   std::string  m_dstarDstAddress;
   unsigned int m_dstarDstPort;
   std::string  m_dstarLocalAddress;
@@ -108,12 +129,15 @@ private:
   std::vector<unsigned char> m_ysfDT1;
   std::vector<unsigned char> m_ysfDT2;
   std::string   m_ysfRadioID;
+  CYSFSettings  m_ysfSettings;
   bool			m_ysfDebug;
 
   unsigned int m_logDisplayLevel;
   unsigned int m_logFileLevel;
   std::string  m_logFilePath;
   std::string  m_logFileRoot;
+
+  void setYSFSettings();
 };
 
 #endif
@@ -91,7 +91,7 @@ int main(int argc, char** argv)
 
 CDSTAR2YSF::CDSTAR2YSF(const std::string& configFile) :
 m_conf(configFile),
-m_conv("/dev/ttyUSB0")
+m_conv()
 {
 	m_dstarFrame = new unsigned char[200U];
 	m_ysfFrame = new unsigned char[200U];
@@ -188,6 +188,13 @@ int CDSTAR2YSF::run()
 	LogInfo(HEADER3);
 	LogInfo(HEADER4);
 
+	ret = m_conv.open(m_conf.getVocoderDevices(), m_conf.getVocoderChannels(), m_conf.getVocoderRequests());
+	if (!ret) {
+		::LogError("Cannot open any DVSI vocoder");
+		::LogFinalise();
+		return 1;
+	}
+
 	m_callsign = m_conf.getCallsign();
 	std::string mycall = m_conf.getMycall();
 	std::string urcall = m_conf.getUrcall();
@@ -243,6 +250,9 @@ int CDSTAR2YSF::run()
 	unsigned char dstar_cnt = 0;
 	unsigned char ysf_cnt = 0;
 
+	// Read by reference, nothing is copied out of the configuration for each frame
+	const CYSFSettings& ysf = m_conf.getYSFSettings();
+
 	LogMessage("Starting DSTAR2YSF-%s", VERSION);
 	
 	for (; end == 0;) {
@@ -424,24 +434,24 @@ int CDSTAR2YSF::run()
 				// Set the FICH
 				CYSFFICH fich;
 				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				unsigned char csd1[20U], csd2[20U];
 				memset(csd1, '*', YSF_CALLSIGN_LENGTH);
  				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
 				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_callsign.c_str(), YSF_CALLSIGN_LENGTH);
 				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -466,23 +476,23 @@ int CDSTAR2YSF::run()
 				// Set the FICH
 				CYSFFICH fich;
 				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
  				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
  				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				unsigned char csd1[20U], csd2[20U];
 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
 				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_callsign.c_str(), YSF_CALLSIGN_LENGTH);
 				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -497,7 +507,7 @@ int CDSTAR2YSF::run()
 				CYSFPayload ysfPayload;
 				unsigned char dch[10U];
 
-				unsigned int fn = (ysf_cnt - 1U) % (m_conf.getFICHFrameTotal() + 1);
+				unsigned int fn = (ysf_cnt - 1U) % (ysf.m_frameTotal + 1);
 
 				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
 				::memcpy(m_ysfFrame + 4U, m_callsign.c_str(), YSF_CALLSIGN_LENGTH);
@@ -509,7 +519,7 @@ int CDSTAR2YSF::run()
 				switch (fn) {
 					case 0:
 						memset(dch, '*', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
  						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);
 						break;
 					case 1:
@@ -520,22 +530,14 @@ int CDSTAR2YSF::run()
 						break;
 					case 5:
 						memset(dch, ' ', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
  						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);	// Rem3/4
  						break;
-					case 6: {
-							unsigned char dt1[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT1().size() && i < 10U; i++)
-								dt1[i] = m_conf.getYsfDT1()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt1);
-						}
+					case 6:
+						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, ysf.m_dt1);
 						break;
-					case 7: {
-							unsigned char dt2[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT2().size() && i < 10U; i++)
-								dt2[i] = m_conf.getYsfDT2()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt2);
-						}
+					case 7:
+						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, ysf.m_dt2);
 						break;
 					default:
 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
@@ -543,18 +545,18 @@ int CDSTAR2YSF::run()
 
 				// Set the FICH
 				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
  				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				// Net frame counter
@@ -583,6 +585,8 @@ int CDSTAR2YSF::run()
 			::usleep(5 * 1000);
 	}
 
+	m_conv.close();
+
 	m_dstarNetwork->close();
 
 	delete m_dstarNetwork;
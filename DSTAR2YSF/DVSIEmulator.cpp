@@ -0,0 +1,397 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Emulates a DVSI AMBE-3000 USB dongle, or an AMBE-3003 with -c 3, on a
+// pseudo terminal so DSTAR2YSF can be run and load tested without the
+// hardware. Speech and channel packets are answered with deterministic
+// payloads derived from the request, after a configurable per-packet service
+// time on each channel, and the replies are paced to the configured serial
+// speed.
+
+#include "DVSIFramer.h"
+#include "StopWatch.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/stat.h>
+
+const unsigned char DVSI_FIELD_CHANNEL = 0x40U;
+const unsigned char DVSI_FIELD_CHAND   = 0x01U;
+const unsigned char DVSI_FIELD_SPEECHD = 0x00U;
+const unsigned char DVSI_FIELD_PRODID  = 0x30U;
+const unsigned char DVSI_FIELD_VERSTR  = 0x31U;
+const unsigned char DVSI_FIELD_RESET   = 0x33U;
+const unsigned char DVSI_FIELD_READY   = 0x39U;
+
+const unsigned int DVSI_AMBE_BYTES  = 9U;
+const unsigned int DVSI_PCM_SAMPLES = 160U;
+
+const unsigned int MAX_CHANNELS = 3U;
+
+struct CEmulatorReply {
+	uint64_t                   m_ready;
+	std::vector<unsigned char> m_data;
+};
+
+static volatile bool m_killed = false;
+
+static void sigHandler(int)
+{
+	m_killed = true;
+}
+
+static void usage()
+{
+	::fprintf(stderr, "Usage: DVSIEmulator [-l link] [-s service_us] [-b baud] [-c channels] [-d drop_every] [-v]\n");
+	::fprintf(stderr, "  -l link        create a symlink to the pty slave, e.g. /tmp/ttyDVSI\n");
+	::fprintf(stderr, "  -s service_us  time the emulated chip spends on each packet (default 2000)\n");
+	::fprintf(stderr, "  -b baud        serial speed used to pace replies, 0 for unlimited (default 460800)\n");
+	::fprintf(stderr, "  -c channels    number of channels, packets carry a channel field when above 1 (default 1)\n");
+	::fprintf(stderr, "  -d drop_every  drop every Nth voice reply to exercise the loss handling (default 0)\n");
+	::fprintf(stderr, "  -v             log every packet\n");
+}
+
+// Fields point past the packet header and any channel field, channel is negative on a single channel part
+static void makeHeader(std::vector<unsigned char>& reply, unsigned int length, unsigned char type, int channel)
+{
+	if (channel >= 0)
+		length++;
+
+	reply.push_back(DVSI_START_BYTE);
+	reply.push_back((length >> 8) & 0xFFU);
+	reply.push_back((length >> 0) & 0xFFU);
+	reply.push_back(type);
+
+	if (channel >= 0)
+		reply.push_back(DVSI_FIELD_CHANNEL + channel);
+}
+
+// A decode request carries 72 bits of AMBE, answer with 160 samples that only depend on them
+static bool decodeReply(const unsigned char* fields, unsigned int length, int channel, std::vector<unsigned char>& reply)
+{
+	if (length < 2U + DVSI_AMBE_BYTES || fields[0U] != DVSI_FIELD_CHAND)
+		return false;
+
+	const unsigned char* ambe = fields + 2U;
+
+	makeHeader(reply, 2U + DVSI_PCM_SAMPLES * 2U, DVSI_TYPE_AUDIO, channel);
+	reply.push_back(DVSI_FIELD_SPEECHD);
+	reply.push_back(DVSI_PCM_SAMPLES);
+
+	for (unsigned int i = 0U; i < DVSI_PCM_SAMPLES; i++) {
+		reply.push_back(ambe[i % DVSI_AMBE_BYTES]);
+		reply.push_back(i & 0xFFU);
+	}
+
+	return true;
+}
+
+// An encode request carries 160 big endian samples, fold them into 9 bytes of "AMBE"
+static bool encodeReply(const unsigned char* fields, unsigned int length, int channel, std::vector<unsigned char>& reply)
+{
+	if (length < 2U + DVSI_PCM_SAMPLES * 2U || fields[0U] != DVSI_FIELD_SPEECHD)
+		return false;
+
+	unsigned char ambe[DVSI_AMBE_BYTES];
+	::memset(ambe, 0x00U, DVSI_AMBE_BYTES);
+
+	for (unsigned int i = 0U; i < DVSI_PCM_SAMPLES * 2U; i++)
+		ambe[i % DVSI_AMBE_BYTES] ^= fields[2U + i];
+
+	makeHeader(reply, 2U + DVSI_AMBE_BYTES, DVSI_TYPE_AMBE, channel);
+	reply.push_back(DVSI_FIELD_CHAND);
+	reply.push_back(DVSI_AMBE_BYTES * 8U);
+	reply.insert(reply.end(), ambe, ambe + DVSI_AMBE_BYTES);
+
+	return true;
+}
+
+// Only the first field of a control packet is answered, which covers what the bridges send
+static bool controlReply(const unsigned char* fields, unsigned int length, int channel, std::vector<unsigned char>& reply)
+{
+	if (length == 0U)
+		return false;
+
+	unsigned char field = fields[0U];
+	std::vector<unsigned char> payload;
+
+	switch (field) {
+		case DVSI_FIELD_PRODID: {
+				const char* id = "AMBE3000R";
+				payload.push_back(field);
+				payload.insert(payload.end(), id, id + ::strlen(id) + 1U);
+			}
+			break;
+		case DVSI_FIELD_VERSTR: {
+				const char* version = "V120.E100.XXXX.C106.G514.R009.B0010411.C0020208";
+				payload.push_back(field);
+				payload.insert(payload.end(), version, version + ::strlen(version) + 1U);
+			}
+			break;
+		case DVSI_FIELD_RESET:
+			payload.push_back(DVSI_FIELD_READY);
+			break;
+		default:
+			payload.push_back(field);
+			payload.push_back(0x00U);
+			break;
+	}
+
+	makeHeader(reply, payload.size(), DVSI_TYPE_CONTROL, channel);
+	reply.insert(reply.end(), payload.begin(), payload.end());
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const char* link = NULL;
+	unsigned int service = 2000U;
+	unsigned int baud = 460800U;
+	unsigned int drop = 0U;
+	unsigned int channels = 1U;
+	bool verbose = false;
+
+	int c;
+	while ((c = ::getopt(argc, argv, "l:s:b:c:d:vh")) != -1) {
+		switch (c) {
+			case 'l':
+				link = optarg;
+				break;
+			case 's':
+				service = (unsigned int)::atoi(optarg);
+				break;
+			case 'b':
+				baud = (unsigned int)::atoi(optarg);
+				break;
+			case 'c':
+				channels = (unsigned int)::atoi(optarg);
+				break;
+			case 'd':
+				drop = (unsigned int)::atoi(optarg);
+				break;
+			case 'v':
+				verbose = true;
+				break;
+			default:
+				usage();
+				return 1;
+		}
+	}
+
+	if (channels == 0U || channels > MAX_CHANNELS) {
+		::fprintf(stderr, "DVSIEmulator: between 1 and %u channels are supported\n", MAX_CHANNELS);
+		return 1;
+	}
+
+	int fd = ::posix_openpt(O_RDWR | O_NOCTTY);
+	if (fd < 0 || ::grantpt(fd) != 0 || ::unlockpt(fd) != 0) {
+		::fprintf(stderr, "DVSIEmulator: cannot create a pseudo terminal, errno=%d\n", errno);
+		return 1;
+	}
+
+	std::string slave = ::ptsname(fd);
+
+	// Keep the slave open ourselves, so the master doesn't see EIO between clients, and make it raw
+	int sfd = ::open(slave.c_str(), O_RDWR | O_NOCTTY);
+	if (sfd < 0) {
+		::fprintf(stderr, "DVSIEmulator: cannot open %s, errno=%d\n", slave.c_str(), errno);
+		return 1;
+	}
+
+	termios termios;
+	::tcgetattr(sfd, &termios);
+	::cfmakeraw(&termios);
+	::tcsetattr(sfd, TCSANOW, &termios);
+
+	::fcntl(fd, F_SETFL, O_NONBLOCK);
+
+	if (link != NULL) {
+		struct stat st;
+		if (::lstat(link, &st) == 0 && S_ISLNK(st.st_mode))
+			::unlink(link);
+
+		if (::symlink(slave.c_str(), link) != 0) {
+			::fprintf(stderr, "DVSIEmulator: cannot create the link %s, errno=%d\n", link, errno);
+			return 1;
+		}
+	}
+
+	::signal(SIGINT,  sigHandler);
+	::signal(SIGTERM, sigHandler);
+
+	::fprintf(stdout, "DVSIEmulator: listening on %s (%u channel(s), service %u us, %u baud)\n", link != NULL ? link : slave.c_str(), channels, service, baud);
+	::fflush(stdout);
+
+	CDVSIFramer framer;
+	std::deque<CEmulatorReply> replies;
+	std::vector<unsigned char> tx;
+	unsigned int txPtr = 0U;
+	uint64_t busyUntil[MAX_CHANNELS] = {0U, 0U, 0U};
+	uint64_t nextTx = 0U;
+
+	unsigned int requests = 0U;
+	unsigned int voice = 0U;
+	unsigned int dropped = 0U;
+	unsigned int rxBytes = 0U;
+	unsigned int txBytes = 0U;
+
+	while (!m_killed) {
+		uint64_t now = CStopWatch::getMicroseconds();
+
+		while (!replies.empty() && replies.front().m_ready <= now) {
+			if (txPtr == tx.size()) {
+				tx.clear();
+				txPtr = 0U;
+			}
+			tx.insert(tx.end(), replies.front().m_data.begin(), replies.front().m_data.end());
+			replies.pop_front();
+		}
+
+		if (txPtr < tx.size() && now >= nextTx) {
+			// Send no more than a millisecond's worth of bytes at a time to follow the serial speed
+			unsigned int n = tx.size() - txPtr;
+			if (baud > 0U && n > baud / 10000U + 1U)
+				n = baud / 10000U + 1U;
+
+			ssize_t len = ::write(fd, &tx[txPtr], n);
+			if (len < 0 && errno != EAGAIN) {
+				::fprintf(stderr, "DVSIEmulator: error from write(), errno=%d\n", errno);
+				break;
+			}
+
+			if (len > 0) {
+				txPtr   += len;
+				txBytes += len;
+				if (baud > 0U)
+					nextTx = now + uint64_t(len) * 10000000U / baud;
+			}
+		}
+
+		int timeout = -1;
+		if (txPtr < tx.size())
+			timeout = (nextTx > now) ? int((nextTx - now + 999U) / 1000U) : 0;
+		else if (!replies.empty())
+			timeout = int((replies.front().m_ready - now + 999U) / 1000U);
+
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		int ret = ::poll(&pfd, 1, timeout);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			::fprintf(stderr, "DVSIEmulator: error from poll(), errno=%d\n", errno);
+			break;
+		}
+
+		if ((pfd.revents & POLLIN) == 0)
+			continue;
+
+		unsigned char buffer[DVSI_MAX_LENGTH];
+		ssize_t len = ::read(fd, buffer, sizeof(buffer));
+		if (len <= 0)
+			continue;
+
+		rxBytes += len;
+		framer.addData(buffer, len);
+
+		unsigned int n;
+		while ((n = framer.getPacket(buffer)) > 0U) {
+			requests++;
+
+			const unsigned char* fields = buffer + DVSI_HEADER_LENGTH;
+			unsigned int length = n - DVSI_HEADER_LENGTH;
+
+			int channel = -1;
+			if (channels > 1U && length > 0U && (fields[0U] & 0xF0U) == DVSI_FIELD_CHANNEL && (fields[0U] & 0x0FU) < channels) {
+				channel = fields[0U] & 0x0FU;
+				fields++;
+				length--;
+			}
+
+			CEmulatorReply reply;
+			bool ok = false;
+			switch (buffer[3U]) {
+				case DVSI_TYPE_AMBE:
+					ok = decodeReply(fields, length, channel, reply.m_data);
+					break;
+				case DVSI_TYPE_AUDIO:
+					ok = encodeReply(fields, length, channel, reply.m_data);
+					break;
+				default:
+					ok = controlReply(fields, length, channel, reply.m_data);
+					break;
+			}
+
+			if (!ok) {
+				::fprintf(stderr, "DVSIEmulator: malformed packet of type 0x%02X and %u bytes\n", buffer[3U], n);
+				continue;
+			}
+
+			// Each channel works through its packets one at a time
+			uint64_t& busy = busyUntil[(channel >= 0) ? channel : 0];
+			now = CStopWatch::getMicroseconds();
+			busy = ((busy > now) ? busy : now) + service;
+			reply.m_ready = busy;
+
+			if (buffer[3U] != DVSI_TYPE_CONTROL) {
+				voice++;
+				if (drop > 0U && (voice % drop) == 0U) {
+					dropped++;
+					if (verbose)
+						::fprintf(stdout, "DVSIEmulator: dropping reply to packet %u\n", requests);
+					continue;
+				}
+			}
+
+			if (verbose)
+				::fprintf(stdout, "DVSIEmulator: packet %u type 0x%02X, %u bytes, %u byte reply\n", requests, buffer[3U], n, (unsigned int)reply.m_data.size());
+
+			// Keep the replies in the order they become ready, the channels run in parallel
+			std::deque<CEmulatorReply>::iterator it = replies.end();
+			while (it != replies.begin() && (it - 1)->m_ready > reply.m_ready)
+				--it;
+			replies.insert(it, reply);
+		}
+	}
+
+	::fprintf(stdout, "DVSIEmulator: %u packets (%u voice, %u dropped), %u bytes in, %u bytes out, %u bytes discarded\n", requests, voice, dropped, rxBytes, txBytes, framer.getDiscarded());
+
+	if (link != NULL)
+		::unlink(link);
+
+	::close(sfd);
+	::close(fd);
+
+	return 0;
+}
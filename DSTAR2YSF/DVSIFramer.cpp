@@ -0,0 +1,125 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DVSIFramer.h"
+
+#include <cstring>
+#include <cassert>
+
+CDVSIFramer::CDVSIFramer(unsigned int maxLength) :
+m_maxLength(maxLength),
+m_buffer(NULL),
+m_size(maxLength * 4U),
+m_start(0U),
+m_len(0U),
+m_discarded(0U)
+{
+	assert(maxLength > DVSI_HEADER_LENGTH);
+
+	m_buffer = new unsigned char[m_size];
+}
+
+CDVSIFramer::~CDVSIFramer()
+{
+	delete[] m_buffer;
+}
+
+void CDVSIFramer::addData(const unsigned char* data, unsigned int length)
+{
+	assert(data != NULL);
+
+	while (length > 0U) {
+		// Move the unread bytes back to the start of the buffer when we run out of room at the end
+		if (m_start + m_len == m_size) {
+			if (m_start == 0U) {
+				// A full buffer without a packet in it cannot happen while in sync, start again
+				m_discarded += m_len;
+				m_len = 0U;
+			} else {
+				::memmove(m_buffer, m_buffer + m_start, m_len);
+			}
+			m_start = 0U;
+		}
+
+		unsigned int n = m_size - m_start - m_len;
+		if (n > length)
+			n = length;
+
+		::memcpy(m_buffer + m_start + m_len, data, n);
+		m_len  += n;
+		data   += n;
+		length -= n;
+	}
+}
+
+unsigned int CDVSIFramer::getPacket(unsigned char* packet)
+{
+	assert(packet != NULL);
+
+	while (m_len > 0U) {
+		unsigned char* p = m_buffer + m_start;
+
+		if (p[0U] != DVSI_START_BYTE) {
+			m_start++;
+			m_len--;
+			m_discarded++;
+			continue;
+		}
+
+		if (m_len < DVSI_HEADER_LENGTH)
+			break;
+
+		unsigned int length = DVSI_HEADER_LENGTH + ((p[1U] << 8) | p[2U]);
+		if (p[3U] > DVSI_TYPE_AUDIO || length > m_maxLength) {
+			// Not a real packet start, try again from the next byte
+			m_start++;
+			m_len--;
+			m_discarded++;
+			continue;
+		}
+
+		if (m_len < length)
+			break;
+
+		::memcpy(packet, p, length);
+		m_start += length;
+		m_len   -= length;
+
+		if (m_len == 0U)
+			m_start = 0U;
+
+		return length;
+	}
+
+	if (m_len == 0U)
+		m_start = 0U;
+
+	return 0U;
+}
+
+unsigned int CDVSIFramer::getDiscarded() const
+{
+	return m_discarded;
+}
+
+void CDVSIFramer::reset()
+{
+	m_start     = 0U;
+	m_len       = 0U;
+	m_discarded = 0U;
+}
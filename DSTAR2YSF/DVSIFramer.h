@@ -0,0 +1,59 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DVSIFramer_H)
+#define	DVSIFramer_H
+
+const unsigned char DVSI_START_BYTE   = 0x61U;
+
+const unsigned char DVSI_TYPE_CONTROL = 0x00U;
+const unsigned char DVSI_TYPE_AMBE    = 0x01U;
+const unsigned char DVSI_TYPE_AUDIO   = 0x02U;
+
+const unsigned int  DVSI_HEADER_LENGTH = 4U;
+const unsigned int  DVSI_MAX_LENGTH    = 400U;
+
+// Splits the byte stream coming from an AMBE-3000 dongle into packets. Each
+// packet is 0x61, a big endian payload length and a type byte, so the frame
+// boundary comes from the length field rather than from matching a fixed
+// header. Anything that cannot start a valid packet is skipped a byte at a
+// time until the stream is back in sync.
+class CDVSIFramer {
+public:
+	CDVSIFramer(unsigned int maxLength = DVSI_MAX_LENGTH);
+	~CDVSIFramer();
+
+	void addData(const unsigned char* data, unsigned int length);
+
+	// Returns the length of the packet copied into packet, or 0 if no complete packet is available
+	unsigned int getPacket(unsigned char* packet);
+
+	unsigned int getDiscarded() const;
+
+	void reset();
+
+private:
+	unsigned int   m_maxLength;
+	unsigned char* m_buffer;
+	unsigned int   m_size;
+	unsigned int   m_start;
+	unsigned int   m_len;
+	unsigned int   m_discarded;
+};
+
+#endif
@@ -19,14 +19,19 @@
  */
 
 #include "ModeConv.h"
+#include "StopWatch.h"
 #include "Utils.h"
 #include "Log.h"
 #include <cstdio>
+#include <cstring>
 #include <cassert>
-#include <deque>
-#include <mutex>
+#include <cerrno>
 #include <md380_vocoder.h>
 
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
 const unsigned int INTERLEAVE_TABLE_26_4[] = {
 	0U, 4U,  8U, 12U, 16U, 20U, 24U, 28U, 32U, 36U, 40U, 44U, 48U, 52U, 56U, 60U, 64U, 68U, 72U, 76U, 80U, 84U, 88U, 92U, 96U, 100U,
 	1U, 5U,  9U, 13U, 17U, 21U, 25U, 29U, 33U, 37U, 41U, 45U, 49U, 53U, 57U, 61U, 65U, 69U, 73U, 77U, 81U, 85U, 89U, 93U, 97U, 101U,
@@ -40,170 +45,591 @@ const uint8_t  BIT_MASK_TABLE[]  = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0
 #define WRITE_BIT(p,i,b)   p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 #define READ_BIT(p,i)     (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
 
-std::mutex m;
+// The first field of every packet on a multi-channel part selects the channel
+const unsigned char DVSI_FIELD_CHANNEL = 0x40U;
+
+const unsigned char DVSI_FIELD_SPEECHD = 0x00U;
+const unsigned char DVSI_FIELD_CHAND   = 0x01U;
+const unsigned char DVSI_FIELD_RATEP   = 0x0AU;
+
+const unsigned int DVSI_AMBE_BYTES  = 9U;
+const unsigned int DVSI_PCM_SAMPLES = 160U;
 
-CModeConv::CModeConv(std::string device) :
+// AMBE 2400 with 1200 FEC, the D-Star rate
+const unsigned char DVSI_RATEP_DSTAR[] = {0x01U, 0x30U, 0x07U, 0x63U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x48U};
+
+// A request the dongle has not answered in this time is assumed lost
+const uint64_t DVSI_TIMEOUT_US = 200000U;
+
+CModeConv::CModeConv() :
 m_dstarN(0U),
 m_ysfN(0U),
 m_DSTAR(5000U, "YSF2DSTAR"),
-m_YSF(5000U, "DSTAR2YSF")
+m_YSF(5000U, "DSTAR2YSF"),
+m_thread(NULL),
+m_running(false),
+m_mutex(),
+m_devices(),
+m_channels(),
+m_maxInFlight(1U),
+m_statsStart(0U)
 {
-	uint8_t buf[512];
-	::memset(buf, 0, sizeof(buf));
-	const uint8_t AMBE2000_2400_1200[17] = {0x61, 0x00, 0x0d, 0x00, 0x0a, 0x01U, 0x30U, 0x07U, 0x63U, 0x40U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x00U, 0x48U};
-	fprintf(stderr, "Creating vocoder on %s\n", device.c_str());
-	vocoder = new CSerialController(device, SERIAL_460800);
-	fprintf(stderr, "Opening vocoder on %s\n", device.c_str());
-	vocoder->open();
-	fprintf(stderr, "Opened vocoder on %s\n", device.c_str());
-	int lw = vocoder->write(AMBE2000_2400_1200, sizeof(AMBE2000_2400_1200));
-	int lr = vocoder->read(buf, 6);
-	
-	fprintf(stderr, "AMBEHW:%d:%d:   ", lw, lr);
-	for(int i = 0; i < lr; ++i){
-		fprintf(stderr, "%02x ", buf[i]);
-	}
-	fprintf(stderr, "\n");
-	fflush(stderr);
-	vocoder_thread = new std::thread(&CModeConv::vocoder_thread_fn, this);
+	m_wake[0U] = -1;
+	m_wake[1U] = -1;
+
+	for (unsigned int i = 0U; i < DVSI_STREAMS; i++)
+		m_stream[i] = -1;
 }
 
 CModeConv::~CModeConv()
 {
+	close();
 }
 
-void CModeConv::vocoder_thread_fn()
+bool CModeConv::open(const std::vector<std::string>& devices, unsigned int channels, unsigned int maxInFlight)
 {
-	uint8_t dvsi_rx[512];
-	uint8_t ambe[9];
-	uint8_t vch[13];
-	int16_t pcm[160U];
-	uint8_t pcm_bytes[326U];
-	int lr;
-	
-	const char dvsi_pcm_header[] = {0x61, 0x01, 0x42, 0x02, 0x00, 0xa0};
-	const char dvsi_pkt_header[] = {0x61, 0x00, 0x0b, 0x01, 0x01, 0x48};
-	std::deque<uint8_t> d;
-	d.clear();
-	::memset(dvsi_rx, 0, 512);
-	//::memset(pcm, 0, sizeof(pcm));
-	fprintf(stderr, "CModeConv::vocoder_thread_fn() started queue size == %d\n", d.max_size());
-	while(1){
-		lr = vocoder->read(dvsi_rx, sizeof(dvsi_rx));
-		
-		//fprintf(stderr, "AMBEHW:%d:  ", lr);
-		for(int i = 0; i < lr; ++i){
-			d.push_back(dvsi_rx[i]);
-			//fprintf(stderr, "%02x ", dvsi_rx[i]);
+	assert(m_thread == NULL);
+
+	m_maxInFlight = (maxInFlight > 0U) ? maxInFlight : 1U;
+
+	if (channels == 0U)
+		channels = 1U;
+
+	for (std::vector<std::string>::const_iterator it = devices.begin(); it != devices.end(); ++it) {
+		if (!openDevice(*it, channels))
+			LogWarning("Not using the DVSI vocoder on %s", it->c_str());
+	}
+
+	if (m_channels.empty())
+		return false;
+
+	if (::pipe(m_wake) != 0) {
+		LogError("Cannot create the vocoder wake up pipe, errno=%d", errno);
+		close();
+		return false;
+	}
+
+	::fcntl(m_wake[0U], F_SETFL, O_NONBLOCK);
+	::fcntl(m_wake[1U], F_SETFL, O_NONBLOCK);
+
+	LogMessage("DVSI: %u device(s), %u channel(s), %u requests in flight per channel", (unsigned int)m_devices.size(), (unsigned int)m_channels.size(), m_maxInFlight);
+
+	m_statsStart = CStopWatch::getMicroseconds();
+
+	m_running = true;
+	m_thread = new std::thread(&CModeConv::vocoder_thread_fn, this);
+
+	return true;
+}
+
+bool CModeConv::openDevice(const std::string& name, unsigned int channels)
+{
+	CSerialController* serial = new CSerialController(name, SERIAL_460800);
+	serial->setNonBlocking(true);
+
+	if (!serial->open()) {
+		delete serial;
+		return false;
+	}
+
+	// Set every channel to the D-Star rate
+	for (unsigned int i = 0U; i < channels; i++) {
+		std::vector<unsigned char> packet;
+		packet.push_back(DVSI_START_BYTE);
+		packet.push_back(0x00U);
+		packet.push_back(1U + sizeof(DVSI_RATEP_DSTAR) + (channels > 1U ? 1U : 0U));
+		packet.push_back(DVSI_TYPE_CONTROL);
+		if (channels > 1U)
+			packet.push_back(DVSI_FIELD_CHANNEL + i);
+		packet.push_back(DVSI_FIELD_RATEP);
+		packet.insert(packet.end(), DVSI_RATEP_DSTAR, DVSI_RATEP_DSTAR + sizeof(DVSI_RATEP_DSTAR));
+
+		serial->write(&packet[0U], packet.size());
+	}
+
+	CDVSIFramer* framer = new CDVSIFramer;
+
+	// Wait up to a second for the dongle to acknowledge the rate change on every channel
+	unsigned int acks = 0U;
+	for (unsigned int i = 0U; i < 10U && acks < channels; i++) {
+		struct pollfd pfd;
+		pfd.fd = serial->getFd();
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (::poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		unsigned char buffer[DVSI_MAX_LENGTH];
+		int len = serial->read(buffer, sizeof(buffer));
+		if (len > 0)
+			framer->addData(buffer, len);
+
+		while (framer->getPacket(buffer) > 0U) {
+			if (buffer[3U] == DVSI_TYPE_CONTROL)
+				acks++;
+		}
+	}
+
+	if (acks < channels) {
+		LogError("No response from the DVSI vocoder on %s, %u of %u channels answered", name.c_str(), acks, channels);
+		serial->close();
+		delete serial;
+		delete framer;
+		return false;
+	}
+
+	CDVSIDevice device;
+	device.m_name            = name;
+	device.m_serial          = serial;
+	device.m_framer          = framer;
+	device.m_txPtr           = 0U;
+	device.m_channels        = channels;
+	device.m_firstChannel    = m_channels.size();
+	device.m_discarded       = 0U;
+	device.m_framerDiscarded = framer->getDiscarded();
+
+	for (unsigned int i = 0U; i < channels; i++) {
+		CDVSIChannel channel;
+		channel.m_device     = m_devices.size();
+		channel.m_id         = i;
+		channel.m_inFlight   = 0U;
+		channel.m_streams    = 0U;
+		channel.m_active     = false;
+		channel.m_busySince  = 0U;
+		channel.m_responses  = 0U;
+		channel.m_lost       = 0U;
+		channel.m_timeouts   = 0U;
+		channel.m_latencySum = 0U;
+		channel.m_latencyMin = 0U;
+		channel.m_latencyMax = 0U;
+		channel.m_queueSum   = 0U;
+		channel.m_queueMax   = 0U;
+		channel.m_busy       = 0U;
+		m_channels.push_back(channel);
+	}
+
+	m_devices.push_back(device);
+
+	LogMessage("Opened the DVSI vocoder on %s with %u channel(s)", name.c_str(), channels);
+
+	return true;
+}
+
+void CModeConv::close()
+{
+	if (m_thread != NULL) {
+		m_running = false;
+
+		unsigned char c = 0x00U;
+		ssize_t n = ::write(m_wake[1U], &c, 1U);
+		(void)n;
+
+		m_thread->join();
+		delete m_thread;
+		m_thread = NULL;
+	}
+
+	for (unsigned int i = 0U; i < 2U; i++) {
+		if (m_wake[i] != -1) {
+			::close(m_wake[i]);
+			m_wake[i] = -1;
 		}
-		//fprintf(stderr, "\n");
-		//fflush(stderr);
-		/*
-		fprintf(stderr, "QUEUE %d:  ", d.size());
-		for(std::deque<uint8_t>::iterator i = d.begin(); i < d.end(); ++i){
-			fprintf(stderr, "%02x ", *i);
+	}
+
+	for (std::vector<CDVSIDevice>::iterator it = m_devices.begin(); it != m_devices.end(); ++it) {
+		it->m_serial->close();
+		delete it->m_serial;
+		delete it->m_framer;
+	}
+
+	m_devices.clear();
+	m_channels.clear();
+}
+
+void CModeConv::addRequest(DVSI_REQUEST type, unsigned char tag, unsigned int stream, const unsigned char* data, unsigned int length)
+{
+	CDVSIRequest req;
+	req.m_type   = type;
+	req.m_tag    = tag;
+	req.m_stream = stream;
+	req.m_queued = CStopWatch::getMicroseconds();
+	req.m_sent   = 0U;
+
+	::memset(req.m_data, 0x00U, sizeof(req.m_data));
+	if (data != NULL)
+		::memcpy(req.m_data, data, length);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue[stream].push_back(req);
+	}
+
+	if (m_wake[1U] != -1) {
+		unsigned char c = 0x00U;
+		ssize_t n = ::write(m_wake[1U], &c, 1U);
+		(void)n;
+	}
+}
+
+// A stream stays on one channel from its header to its EOT, as the vocoder keeps state between frames
+unsigned int CModeConv::bindStream(unsigned int stream)
+{
+	if (m_stream[stream] >= 0)
+		return m_stream[stream];
+
+	// Prefer the channel with the fewest streams, then the device with the fewest streams as they share one serial link
+	std::vector<unsigned int> deviceStreams(m_devices.size(), 0U);
+	for (std::vector<CDVSIChannel>::const_iterator it = m_channels.begin(); it != m_channels.end(); ++it)
+		deviceStreams[it->m_device] += it->m_streams;
+
+	unsigned int best = 0U;
+	for (unsigned int i = 1U; i < m_channels.size(); i++) {
+		const CDVSIChannel& a = m_channels[i];
+		const CDVSIChannel& b = m_channels[best];
+		if (a.m_streams != b.m_streams) {
+			if (a.m_streams < b.m_streams)
+				best = i;
+		} else if (deviceStreams[a.m_device] != deviceStreams[b.m_device]) {
+			if (deviceStreams[a.m_device] < deviceStreams[b.m_device])
+				best = i;
+		} else if (a.m_inFlight < b.m_inFlight) {
+			best = i;
+		}
+	}
+
+	m_channels[best].m_streams++;
+	m_stream[stream] = best;
+
+	return best;
+}
+
+void CModeConv::dispatch(unsigned int stream)
+{
+	for (;;) {
+		CDVSIRequest req;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_queue[stream].empty())
+				return;
+			req = m_queue[stream].front();
 		}
-		fprintf(stderr, "\n");
-		fflush(stderr);
-		*/
-		if((::memcmp(&(*(d.begin())), dvsi_pcm_header, 6) == 0) && d.size() > 325){
-			d.erase(d.begin(), d.begin() + 6);
-			
-			std::deque<uint8_t>::iterator p_rx = d.begin();
-			for(int i = 0; i < 160; ++i){
-				pcm[i] = ((p_rx[(i*2)] << 8) & 0xff00) | (p_rx[(i*2)+1] & 0xff);
+
+		unsigned int index = bindStream(stream);
+		CDVSIChannel& channel = m_channels[index];
+
+		if (req.m_type == DVSI_MARKER) {
+			if (channel.m_sent.empty())
+				writeMarker(req);
+			else
+				channel.m_sent.push_back(req);
+
+			if (req.m_tag == TAG_EOT) {
+				channel.m_streams--;
+				m_stream[stream] = -1;
 			}
-			encodeYSF(pcm, vch);
+		} else {
+			if (channel.m_inFlight >= m_maxInFlight)
+				return;
+
+			buildPacket(req, m_devices[channel.m_device], channel.m_id);
+
+			req.m_sent = CStopWatch::getMicroseconds();
+			if (channel.m_inFlight == 0U) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				channel.m_active    = true;
+				channel.m_busySince = req.m_sent;
+			}
+
+			channel.m_sent.push_back(req);
+			channel.m_inFlight++;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue[stream].pop_front();
+	}
+}
+
+void CModeConv::buildPacket(const CDVSIRequest& req, CDVSIDevice& device, unsigned char id)
+{
+	std::vector<unsigned char>& tx = device.m_tx;
+	if (device.m_txPtr == tx.size()) {
+		tx.clear();
+		device.m_txPtr = 0U;
+	}
+
+	bool multi = device.m_channels > 1U;
+	unsigned int length = 2U + (multi ? 1U : 0U) + ((req.m_type == DVSI_DECODE) ? DVSI_AMBE_BYTES : DVSI_PCM_SAMPLES * 2U);
+
+	tx.push_back(DVSI_START_BYTE);
+	tx.push_back((length >> 8) & 0xFFU);
+	tx.push_back((length >> 0) & 0xFFU);
+	tx.push_back((req.m_type == DVSI_DECODE) ? DVSI_TYPE_AMBE : DVSI_TYPE_AUDIO);
+	if (multi)
+		tx.push_back(DVSI_FIELD_CHANNEL + id);
+
+	if (req.m_type == DVSI_DECODE) {
+		tx.push_back(DVSI_FIELD_CHAND);
+		tx.push_back(DVSI_AMBE_BYTES * 8U);
+		tx.insert(tx.end(), req.m_data, req.m_data + DVSI_AMBE_BYTES);
+		return;
+	}
+
+	int16_t pcm[DVSI_PCM_SAMPLES];
+	md380_decode(const_cast<unsigned char*>(req.m_data), pcm);
+
+	tx.push_back(DVSI_FIELD_SPEECHD);
+	tx.push_back(DVSI_PCM_SAMPLES);
+	for (unsigned int i = 0U; i < DVSI_PCM_SAMPLES; i++) {
+		tx.push_back(pcm[i] >> 8);
+		tx.push_back(pcm[i] & 0xFFU);
+	}
+}
+
+void CModeConv::writeMarker(const CDVSIRequest& req)
+{
+	unsigned char data[13U];
+	::memset(data, 0x00U, sizeof(data));
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (req.m_stream == DVSI_STREAM_TO_YSF) {
+		m_YSF.addData(&req.m_tag, 1U);
+		m_YSF.addData(data, 13U);
+		m_ysfN += 1U;
+	} else {
+		m_DSTAR.addData(&req.m_tag, 1U);
+		m_DSTAR.addData(data, 9U);
+		m_dstarN += 1U;
+	}
+}
+
+void CModeConv::completeRequest(CDVSIChannel& channel, uint64_t now)
+{
+	channel.m_sent.pop_front();
+	channel.m_inFlight--;
+
+	if (channel.m_inFlight == 0U) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		channel.m_busy  += now - channel.m_busySince;
+		channel.m_active = false;
+	}
+
+	// Header and EOT markers queued behind the request can go out now
+	while (!channel.m_sent.empty() && channel.m_sent.front().m_type == DVSI_MARKER) {
+		writeMarker(channel.m_sent.front());
+		channel.m_sent.pop_front();
+	}
+}
+
+void CModeConv::processResponse(CDVSIDevice& device, const unsigned char* packet, unsigned int length)
+{
+	unsigned int offset = DVSI_HEADER_LENGTH;
+	unsigned int id = 0U;
+
+	if (device.m_channels > 1U) {
+		if (length <= offset || (packet[offset] & 0xF0U) != DVSI_FIELD_CHANNEL || (packet[offset] & 0x0FU) >= device.m_channels)
+			return;
+		id = packet[offset] & 0x0FU;
+		offset++;
+	}
+
+	DVSI_REQUEST type;
+	if (packet[3U] == DVSI_TYPE_AUDIO && length >= offset + 2U + DVSI_PCM_SAMPLES * 2U)
+		type = DVSI_DECODE;
+	else if (packet[3U] == DVSI_TYPE_AMBE && length >= offset + 2U + DVSI_AMBE_BYTES)
+		type = DVSI_ENCODE;
+	else
+		return;
+
+	CDVSIChannel& channel = m_channels[device.m_firstChannel + id];
+	uint64_t now = CStopWatch::getMicroseconds();
+
+	// Each channel answers in order, so anything ahead of a matching request was dropped by it
+	while (!channel.m_sent.empty() && channel.m_sent.front().m_type != type) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			channel.m_lost++;
+		}
+		completeRequest(channel, now);
+	}
+
+	if (channel.m_sent.empty()) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		channel.m_lost++;
+		return;
+	}
+
+	const CDVSIRequest& req = channel.m_sent.front();
+	unsigned int latency = (unsigned int)(now - req.m_sent);
+	unsigned int queued  = (unsigned int)(req.m_sent - req.m_queued);
+	unsigned int stream  = req.m_stream;
+
+	const unsigned char* payload = packet + offset + 2U;
+
+	unsigned char vch[13U];
+	if (type == DVSI_DECODE) {
+		int16_t pcm[DVSI_PCM_SAMPLES];
+		for (unsigned int i = 0U; i < DVSI_PCM_SAMPLES; i++)
+			pcm[i] = ((payload[(i * 2U)] << 8) & 0xFF00) | (payload[(i * 2U) + 1U] & 0xFF);
+
+		encodeYSF(pcm, vch);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (stream == DVSI_STREAM_TO_YSF) {
 			m_YSF.addData(&TAG_DATA, 1U);
 			m_YSF.addData(vch, 13U);
 			m_ysfN += 1U;
-			d.erase(d.begin(), d.begin() + 320);
+		} else {
+			m_DSTAR.addData(&TAG_DATA, 1U);
+			m_DSTAR.addData(payload, DVSI_AMBE_BYTES);
+			m_dstarN += 1U;
 		}
-		
-		if(d.size() > 14){
-			int j = 0;
-			for(std::deque<uint8_t>::iterator i = d.begin()+6; i < d.begin()+15; ++i){
-				ambe[j++] = *i;
-			}
-			try {
-				//m.lock();
-				m_DSTAR.addData(&TAG_DATA, 1U);
-				m_DSTAR.addData(ambe, 9U);
-				m_dstarN += 1;
-				//m.unlock();
-			}
-			catch(std::logic_error&){
-				fprintf(stderr, "Exception\n");
-			}
-				//m_mutex.unlock();
-			d.erase(d.begin(), d.begin() + 15U);
-			//}
-			//else{
-			//	fprintf(stderr, "read thread try_lock() failed\n");
-			//}
+
+		if (channel.m_responses == 0U || latency < channel.m_latencyMin)
+			channel.m_latencyMin = latency;
+		if (latency > channel.m_latencyMax)
+			channel.m_latencyMax = latency;
+		channel.m_latencySum += latency;
+
+		if (queued > channel.m_queueMax)
+			channel.m_queueMax = queued;
+		channel.m_queueSum += queued;
+
+		channel.m_responses++;
+	}
+
+	completeRequest(channel, now);
+}
+
+void CModeConv::vocoder_thread_fn()
+{
+	unsigned char rx[DVSI_MAX_LENGTH];
+	unsigned char packet[DVSI_MAX_LENGTH];
+
+	std::vector<struct pollfd> pfd(m_devices.size() + 1U);
+
+	while (m_running) {
+		for (unsigned int i = 0U; i < DVSI_STREAMS; i++)
+			dispatch(i);
+
+		bool busy = false;
+		for (unsigned int i = 0U; i < m_devices.size(); i++) {
+			CDVSIDevice& device = m_devices[i];
+			pfd[i].fd = device.m_serial->getFd();
+			pfd[i].events = (device.m_txPtr < device.m_tx.size()) ? (POLLIN | POLLOUT) : POLLIN;
+			pfd[i].revents = 0;
 		}
-		/*
-		if(m_dvsiEncode){
-			fprintf(stderr, "CModeConv::vocoder_thread_fn() encode\n");
-			lr = vocoder->read(dvsi_rx, sizeof(dvsi_rx));
-			//fprintf(stderr, "CModeConv::vocoder_thread_fn() encoding lr == %d\n", lr);
-			//for(int i = 0; i < lr; ++i){
-			//	d.push(dvsi_rx[i]);
-			//}
-			if(lr != 15){
-				fprintf(stderr, "vocoder returned %d\n", lr);
-				//continue;
-			}
-			//if(d.size() > 14){
-				//d.pop();
-				//d.pop();
-				//d.pop();
-				//d.pop();
-				//d.pop();
-				//d.pop();
-				//for(int i = 0; i < 9; ++i){
-				//	ambe[i] = d.front();
-				//	d.pop();
-				//}
-				//::memcpy(pcm, pcm_bytes, 320);
-				m_DSTAR.addData(&TAG_DATA, 1U);
-				//m_DSTAR.addData(ambe, 9U);
-				m_DSTAR.addData(dvsi_rx+6, 9U);
-				m_dstarN += 1;
-			//}
+
+		for (unsigned int i = 0U; i < m_channels.size(); i++) {
+			if (m_channels[i].m_inFlight > 0U)
+				busy = true;
 		}
-		else{
-			fprintf(stderr, "CModeConv::vocoder_thread_fn() decode\n");
-			lr = vocoder->read(pcm_bytes, sizeof(pcm_bytes));
-			fprintf(stderr, "CModeConv::vocoder_thread_fn() decoding lr == %d\n", lr);
-			//for(int i = 0; i < lr; ++i){
-			//	pcm_q.push(pcm_bytes[i]);
-			//}
-			if(lr != 326){
-				fprintf(stderr, "vocoder returned %d\n", lr);
+
+		struct pollfd& wake = pfd[m_devices.size()];
+		wake.fd = m_wake[0U];
+		wake.events = POLLIN;
+		wake.revents = 0;
+
+		int ret = ::poll(&pfd[0U], pfd.size(), busy ? 20 : 1000);
+		if (ret < 0) {
+			if (errno == EINTR)
 				continue;
+			LogError("Error returned from poll() on the vocoders, errno=%d", errno);
+			break;
+		}
+
+		if (wake.revents & POLLIN) {
+			unsigned char buffer[16U];
+			while (::read(m_wake[0U], buffer, sizeof(buffer)) > 0)
+				;
+		}
+
+		for (unsigned int i = 0U; i < m_devices.size(); i++) {
+			CDVSIDevice& device = m_devices[i];
+
+			if ((pfd[i].revents & POLLOUT) && device.m_txPtr < device.m_tx.size()) {
+				int len = device.m_serial->writeSome(&device.m_tx[device.m_txPtr], device.m_tx.size() - device.m_txPtr);
+				if (len > 0)
+					device.m_txPtr += len;
 			}
-			//if(pcm_q.size() > 325){
-				uint8_t *p_rx = pcm_bytes + 6;
-				for(int i = 0; i < 160; ++i){
-					pcm[i] = ((p_rx[(i*2)] << 8) & 0xff00) | (p_rx[(i*2)+1] & 0xff);
+
+			if (pfd[i].revents & POLLIN) {
+				int len = device.m_serial->read(rx, sizeof(rx));
+				if (len > 0)
+					device.m_framer->addData(rx, len);
+
+				unsigned int n;
+				while ((n = device.m_framer->getPacket(packet)) > 0U)
+					processResponse(device, packet, n);
+
+				if (device.m_framer->getDiscarded() != device.m_framerDiscarded) {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					device.m_discarded += device.m_framer->getDiscarded() - device.m_framerDiscarded;
+					device.m_framerDiscarded = device.m_framer->getDiscarded();
 				}
-				
-				encodeYSF(pcm, vch);
-				m_YSF.addData(&TAG_DATA, 1U);
-				m_YSF.addData(vch, 13U);
-				m_ysfN += 1U;
-			//}
+			}
 		}
-		
-		fprintf(stderr, "AMBEHW %d:  ", lr);
-		for(int i = 0; i < lr; ++i){
-			fprintf(stderr, "%02x ", pcm_bytes[i]);
+
+		// Don't let a lost response hold up everything behind it
+		uint64_t now = CStopWatch::getMicroseconds();
+		for (std::vector<CDVSIChannel>::iterator it = m_channels.begin(); it != m_channels.end(); ++it) {
+			while (!it->m_sent.empty() && (now - it->m_sent.front().m_sent) > DVSI_TIMEOUT_US) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					it->m_timeouts++;
+				}
+				completeRequest(*it, now);
+			}
 		}
-		fprintf(stderr, "\n");
-		fflush(stderr);
-		*/
 	}
+
+	if (m_running)
+		LogError("The DVSI vocoder thread has stopped");
+}
+
+// Called with m_mutex held
+void CModeConv::writeStats()
+{
+	uint64_t now = CStopWatch::getMicroseconds();
+	uint64_t elapsed = now - m_statsStart;
+	if (elapsed == 0U)
+		elapsed = 1U;
+
+	for (std::vector<CDVSIChannel>::iterator it = m_channels.begin(); it != m_channels.end(); ++it) {
+		if (it->m_active) {
+			it->m_busy     += now - it->m_busySince;
+			it->m_busySince = now;
+		}
+
+		if (it->m_responses > 0U)
+			LogMessage("DVSI %s channel %u: %u responses, latency min/avg/max %u/%u/%u us, queueing avg/max %u/%u us, %u%% busy, %u lost, %u timed out",
+				m_devices[it->m_device].m_name.c_str(), it->m_id, it->m_responses,
+				it->m_latencyMin, (unsigned int)(it->m_latencySum / it->m_responses), it->m_latencyMax,
+				(unsigned int)(it->m_queueSum / it->m_responses), it->m_queueMax,
+				(unsigned int)((it->m_busy * 100U) / elapsed), it->m_lost, it->m_timeouts);
+
+		it->m_responses  = 0U;
+		it->m_lost       = 0U;
+		it->m_timeouts   = 0U;
+		it->m_latencySum = 0U;
+		it->m_latencyMin = 0U;
+		it->m_latencyMax = 0U;
+		it->m_queueSum   = 0U;
+		it->m_queueMax   = 0U;
+		it->m_busy       = 0U;
+	}
+
+	for (std::vector<CDVSIDevice>::iterator it = m_devices.begin(); it != m_devices.end(); ++it) {
+		if (it->m_discarded > 0U)
+			LogMessage("DVSI %s: %u bytes discarded", it->m_name.c_str(), it->m_discarded);
+		it->m_discarded = 0U;
+	}
+
+	m_statsStart = now;
 }
 
 void CModeConv::encodeYSF(int16_t *pcm, uint8_t *vch)
@@ -266,35 +692,19 @@ void CModeConv::encodeYSF(int16_t *pcm, uint8_t *vch)
 
 void CModeConv::putDSTARHeader()
 {
-	uint8_t vch[13];
-	::memset(vch, 0, sizeof(vch));
-	m_YSF.addData(&TAG_HEADER, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	addRequest(DVSI_MARKER, TAG_HEADER, DVSI_STREAM_TO_YSF, NULL, 0U);
 }
 
 void CModeConv::putDSTAREOT()
 {
-	uint8_t vch[13];
-	::memset(vch, 0, sizeof(vch));
-	m_YSF.addData(&TAG_EOT, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	addRequest(DVSI_MARKER, TAG_EOT, DVSI_STREAM_TO_YSF, NULL, 0U);
 }
 
 void CModeConv::putDSTAR(unsigned char* ambe)
 {
 	assert(ambe != NULL);
 
-	uint8_t vch[13];
-	int16_t pcm[320U];
-	::memset(pcm, 0, sizeof(pcm));
-	
-	decode_2400(pcm, ambe);
-	encodeYSF(pcm, vch);
-	m_YSF.addData(&TAG_DATA, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	addRequest(DVSI_DECODE, TAG_DATA, DVSI_STREAM_TO_YSF, ambe, 9U);
 }
 
 unsigned int CModeConv::getDSTAR(unsigned char* data)
@@ -303,18 +713,15 @@ unsigned int CModeConv::getDSTAR(unsigned char* data)
 
 	tag[0U] = TAG_NODATA;
 
+	std::lock_guard<std::mutex> lock(m_mutex);
+
 	if (m_dstarN >= 1U) {
-		try {
-			//m.lock();
-			m_DSTAR.getData(tag, 1U);
-			m_DSTAR.getData(data, 9U);
-			m_dstarN -= 1U;
-			//m.unlock();
-		}
-		catch(std::logic_error&){
-			fprintf(stderr, "Exception\n");
-		}
-			return tag[0U];
+		m_DSTAR.getData(tag, 1U);
+		m_DSTAR.getData(data, 9U);
+		m_dstarN -= 1U;
+		if (tag[0U] == TAG_EOT)
+			writeStats();
+		return tag[0U];
 	}
 	else
 		return TAG_NODATA;
@@ -322,27 +729,17 @@ unsigned int CModeConv::getDSTAR(unsigned char* data)
 
 void CModeConv::putYSFHeader()
 {
-	uint8_t ambe[9U];
-	::memset(ambe, 0, 9);
-	m_DSTAR.addData(&TAG_HEADER, 1U);
-	m_DSTAR.addData(ambe, 9U);
-	m_dstarN += 1U;
+	addRequest(DVSI_MARKER, TAG_HEADER, DVSI_STREAM_TO_DSTAR, NULL, 0U);
 }
 
 void CModeConv::putYSFEOT()
 {
-	uint8_t ambe[9U];
-	::memset(ambe, 0, 9);
-	m_DSTAR.addData(&TAG_EOT, 1U);
-	m_DSTAR.addData(ambe, 9U);
-	m_dstarN += 1U;
+	addRequest(DVSI_MARKER, TAG_EOT, DVSI_STREAM_TO_DSTAR, NULL, 0U);
 }
 
 void CModeConv::putYSF(unsigned char* data)
 {
 	unsigned char v_tmp[7U];
-	uint8_t ambe[9U];
-	int16_t pcm[160];
 
 	assert(data != NULL);
 
@@ -406,11 +803,7 @@ void CModeConv::putYSF(unsigned char* data)
 			bool s = (dat_c << (i + 7U)) & 0x80000000;
 			WRITE_BIT(v_tmp, i + 24U, s);
 		}
-		md380_decode(v_tmp, pcm);
-		encode_2400(pcm, ambe);
-		//m_DSTAR.addData(&TAG_DATA, 1U);
-		//m_DSTAR.addData(ambe, 9U);
-		//m_dstarN += 1;
+		addRequest(DVSI_ENCODE, TAG_DATA, DVSI_STREAM_TO_DSTAR, v_tmp, 7U);
 	}
 }
 
@@ -421,7 +814,9 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 	tag[0U] = TAG_NODATA;
 
 	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
-	
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
 	if (m_ysfN >= 1U) {
 		m_YSF.peek(tag, 1U);
 
@@ -429,6 +824,8 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 			m_YSF.getData(tag, 1U);
 			m_YSF.getData(data, 13U);
 			m_ysfN -= 1U;
+			if (tag[0U] == TAG_EOT)
+				writeStats();
 			return tag[0U];
 		}
 	}
@@ -464,61 +861,3 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 	else
 		return TAG_NODATA;
 }
-
-void CModeConv::decode_2400(int16_t *pcm, uint8_t *ambe)
-{
-	uint8_t dvsi_tx[15] = {0x61, 0x00, 0x0b, 0x01, 0x01, 0x48};
-	uint8_t dvsi_rx[326];
-
-	::memcpy(dvsi_tx + 6, ambe, 9);
-	m_dvsiEncode = false;
-	int lw = vocoder->write(dvsi_tx, 15);
-	/*
-	int lr = vocoder->read(dvsi_rx, sizeof(dvsi_rx));
-	
-	if(lr != 326){
-		fprintf(stderr, "vocoder returned %d:%d\n", lr, lw);
-		return;
-	}
-	
-	uint8_t *p_rx = dvsi_rx + 6;
-	for(int i = 0; i < 160; ++i){
-		pcm[i] = ((p_rx[(i*2)] << 8) & 0xff00) | (p_rx[(i*2)+1] & 0xff);
-	}
-	//::memcpy(pcm, dvsi_rx + 6, 320);
-	fprintf(stderr, "AMBEHW:%d:%d:  ", lw, lr);
-	for(int i = 0; i < lr; ++i){
-		fprintf(stderr, "%02x ", dvsi_rx[i]);
-	}
-	fprintf(stderr, "\n");
-	fflush(stderr);
-	*/
-}
-
-void CModeConv::encode_2400(int16_t *pcm, uint8_t *ambe)
-{
-	uint8_t dvsi_tx[326] = {0x61, 0x01, 0x42, 0x02, 0x00, 0xa0};
-	uint8_t dvsi_rx[15];
-	
-	uint8_t *p_tx = dvsi_tx + 6;
-	for(int i = 0; i < 160; ++i){
-		p_tx[(i*2)+1] = pcm[i] & 0xff;
-		p_tx[(i*2)] = pcm[i] >> 8;
-	}
-	
-	//::memcpy(dvsi_tx + 6, pcm, 320);
-	m_dvsiEncode = true;
-	int lw = vocoder->write(dvsi_tx, sizeof(dvsi_tx));
-	
-	//int lr = vocoder->read(dvsi_rx, sizeof(dvsi_rx));
-	
-	//::memcpy(ambe, dvsi_rx + 6, 9);
-	/*
-	fprintf(stderr, "PCM:%d: ", lw);
-	for(int i = 0; i < lw; ++i){
-		fprintf(stderr, "%02x ", dvsi_tx[i]);
-	}
-	fprintf(stderr, "\n");
-	fflush(stderr);
-	*/
-}
@@ -17,9 +17,16 @@
  *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 #include "SerialController.h"
+#include "DVSIFramer.h"
 #include "YSFDefines.h"
 #include "RingBuffer.h"
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstdint>
 
 
 const unsigned char TAG_HEADER = 0x00U;
@@ -31,11 +38,19 @@ const unsigned char TAG_NODATA = 0x04U;
 #if !defined(MODECONV_H)
 #define MODECONV_H
 
+const unsigned int DVSI_STREAM_TO_YSF   = 0U;
+const unsigned int DVSI_STREAM_TO_DSTAR = 1U;
+const unsigned int DVSI_STREAMS         = 2U;
+
 class CModeConv {
 public:
-	CModeConv(std::string device = "/dev/null");
+	CModeConv();
 	~CModeConv();
 
+	// Opens every device and configures each of its channels, succeeds if at least one channel is usable
+	bool open(const std::vector<std::string>& devices, unsigned int channels, unsigned int maxInFlight);
+	void close();
+
 	void putDSTAR(unsigned char* bytes);
 	void putDSTARHeader();
 	void putDSTAREOT();
@@ -48,20 +63,80 @@ public:
 	unsigned int getYSF(unsigned char* bytes);
 
 private:
+	enum DVSI_REQUEST {
+		DVSI_DECODE,
+		DVSI_ENCODE,
+		DVSI_MARKER
+	};
+
+	struct CDVSIRequest {
+		DVSI_REQUEST  m_type;
+		unsigned char m_tag;
+		unsigned int  m_stream;
+		unsigned char m_data[9U];
+		uint64_t      m_queued;
+		uint64_t      m_sent;
+	};
+
+	struct CDVSIDevice {
+		std::string                m_name;
+		CSerialController*         m_serial;
+		CDVSIFramer*               m_framer;
+		std::vector<unsigned char> m_tx;
+		unsigned int               m_txPtr;
+		unsigned int               m_channels;
+		unsigned int               m_firstChannel;
+		unsigned int               m_discarded;
+		unsigned int               m_framerDiscarded;
+	};
+
+	struct CDVSIChannel {
+		unsigned int             m_device;
+		unsigned char            m_id;
+		std::deque<CDVSIRequest> m_sent;
+		unsigned int             m_inFlight;
+		unsigned int             m_streams;
+		// The statistics are shared with the main thread under m_mutex
+		bool                     m_active;
+		uint64_t                 m_busySince;
+		unsigned int             m_responses;
+		unsigned int             m_lost;
+		unsigned int             m_timeouts;
+		uint64_t                 m_latencySum;
+		unsigned int             m_latencyMin;
+		unsigned int             m_latencyMax;
+		uint64_t                 m_queueSum;
+		unsigned int             m_queueMax;
+		uint64_t                 m_busy;
+	};
+
 	void encodeYSF(int16_t *pcm, uint8_t *vch);
-	void decode_2400(int16_t *, uint8_t *);
-	void encode_2400(int16_t *, uint8_t *);
 	void vocoder_thread_fn();
+
+	bool openDevice(const std::string& name, unsigned int channels);
+	void addRequest(DVSI_REQUEST type, unsigned char tag, unsigned int stream, const unsigned char* data, unsigned int length);
+	unsigned int bindStream(unsigned int stream);
+	void dispatch(unsigned int stream);
+	void buildPacket(const CDVSIRequest& req, CDVSIDevice& device, unsigned char id);
+	void processResponse(CDVSIDevice& device, const unsigned char* packet, unsigned int length);
+	void completeRequest(CDVSIChannel& channel, uint64_t now);
+	void writeMarker(const CDVSIRequest& req);
+	void writeStats();
 	
 	unsigned int m_dstarN;
 	unsigned int m_ysfN;
-	CSerialController *vocoder;
 	CRingBuffer<unsigned char> m_DSTAR;
 	CRingBuffer<unsigned char> m_YSF;
-	bool m_dvsiEncode;
-	std::thread *vocoder_thread;
-	std::atomic_flag m_lock;
-	
+	std::thread *m_thread;
+	std::atomic<bool> m_running;
+	std::mutex m_mutex;
+	int m_wake[2U];
+	std::vector<CDVSIDevice> m_devices;
+	std::vector<CDVSIChannel> m_channels;
+	std::deque<CDVSIRequest> m_queue[DVSI_STREAMS];
+	int m_stream[DVSI_STREAMS];
+	unsigned int m_maxInFlight;
+	uint64_t m_statsStart;
 };
 
 #endif
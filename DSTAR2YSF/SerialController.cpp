@@ -36,6 +36,7 @@ CSerialController::CSerialController(const std::string& device, SERIAL_SPEED spe
 m_device(device),
 m_speed(speed),
 m_assertRTS(assertRTS),
+m_nonBlocking(false),
 m_fd(-1)
 {
 	assert(!device.empty());
@@ -49,7 +50,7 @@ bool CSerialController::open()
 {
 	assert(m_fd == -1);
 	
-	m_fd = ::open(m_device.c_str(), O_RDWR);
+	m_fd = ::open(m_device.c_str(), m_nonBlocking ? (O_RDWR | O_NOCTTY | O_NONBLOCK) : O_RDWR);
 	
 	if (m_fd < 0) {
 		LogError("Cannot open device - %s", m_device.c_str());
@@ -73,7 +74,7 @@ bool CSerialController::open()
 		termios.c_lflag &= ~(ISIG | ICANON | IEXTEN);
 		termios.c_lflag &= ~(ECHO | ECHOE | ECHOK | ECHONL);
 		termios.c_cc[VMIN]  = 0;
-		termios.c_cc[VTIME] = 1;
+		termios.c_cc[VTIME] = m_nonBlocking ? 0 : 1;
 
 		switch (m_speed) {
 			case SERIAL_1200:
@@ -168,6 +169,7 @@ int CSerialController::read(unsigned char* buffer, unsigned int length)
 				LogError("Error from read(), errno=%d", errno);
 				return -1;
 			}
+			return 0;
 		}
 		//if (len > 0)
 			//ptr += len;
@@ -201,6 +203,38 @@ int CSerialController::write(const unsigned char* buffer, unsigned int length)
 	return ptr;
 }
 
+int CSerialController::writeSome(const unsigned char* buffer, unsigned int length)
+{
+	assert(buffer != NULL);
+	assert(m_fd != -1);
+
+	if (length == 0U)
+		return 0;
+
+	ssize_t len = ::write(m_fd, buffer, length);
+	if (len < 0) {
+		if (errno != EAGAIN) {
+			LogError("Error returned from write(), errno=%d", errno);
+			return -1;
+		}
+		return 0;
+	}
+
+	return len;
+}
+
+void CSerialController::setNonBlocking(bool on)
+{
+	assert(m_fd == -1);
+
+	m_nonBlocking = on;
+}
+
+int CSerialController::getFd() const
+{
+	return m_fd;
+}
+
 void CSerialController::close()
 {
 	assert(m_fd != -1);
@@ -46,10 +46,16 @@ public:
 	int write(const unsigned char* buffer, unsigned int length);
 	void close();
 
+	// Must be called before open(), reads and writeSome() then never block
+	void setNonBlocking(bool on);
+	int  writeSome(const unsigned char* buffer, unsigned int length);
+	int  getFd() const;
+
 protected:
 	std::string    m_device;
 	SERIAL_SPEED   m_speed;
 	bool           m_assertRTS;
+	bool           m_nonBlocking;
 	int            m_fd;
 };
 
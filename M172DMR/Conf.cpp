@@ -69,6 +69,8 @@ m_dmrNetworkOptions(),
 m_dmrNetworkDebug(false),
 m_dmrNetworkJitterEnabled(true),
 m_dmrNetworkJitter(500U),
+m_dmrNetworkSlot1(false),
+m_dmrNetworkSlot2(true),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_m17DstId(0U),
@@ -78,6 +80,7 @@ m_m17DstPort(0U),
 m_m17LocalAddress(),
 m_m17LocalPort(0U),
 m_m17GainAdjDb(),
+m_m17AGC(false),
 m_m17NetworkDebug(false),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
@@ -189,6 +192,10 @@ bool CConf::read()
 				m_dmrNetworkJitterEnabled = ::atoi(value) == 1;
 			else if (::strcmp(key, "Jitter") == 0)
 				m_dmrNetworkJitter = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Slot1") == 0)
+				m_dmrNetworkSlot1 = ::atoi(value) == 1;
+			else if (::strcmp(key, "Slot2") == 0)
+				m_dmrNetworkSlot2 = ::atoi(value) == 1;
 		} else if (section == SECTION_M17_NETWORK) {
 			if (::strcmp(key, "Callsign") == 0)
 				m_callsign = value;
@@ -206,6 +213,8 @@ bool CConf::read()
 				m_m17DstPort = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "GainAdjustdB") == 0)
 				m_m17GainAdjDb = value;
+			else if (::strcmp(key, "AGC") == 0)
+				m_m17AGC = ::atoi(value) == 1;
 			else if (::strcmp(key, "Debug") == 0)
 				m_m17NetworkDebug = ::atoi(value) == 1;
 		} 
@@ -356,6 +365,16 @@ unsigned int CConf::getDMRNetworkJitter() const
 	return m_dmrNetworkJitter;
 }
 
+bool CConf::getDMRNetworkSlot1() const
+{
+	return m_dmrNetworkSlot1;
+}
+
+bool CConf::getDMRNetworkSlot2() const
+{
+	return m_dmrNetworkSlot2;
+}
+
 std::string CConf::getDMRIdLookupFile() const
 {
 	return m_dmrIdLookupFile;
@@ -396,6 +415,11 @@ std::string CConf::getM17GainAdjDb() const
 	return m_m17GainAdjDb;
 }
 
+bool CConf::getM17AGC() const
+{
+	return m_m17AGC;
+}
+
 bool CConf::getM17NetworkDebug() const
 {
 	return m_m17NetworkDebug;
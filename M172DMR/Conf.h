@@ -41,6 +41,7 @@ public:
   std::string  getM17LocalAddress() const;
   unsigned int getM17LocalPort() const;
   std::string  getM17GainAdjDb() const;
+  bool         getM17AGC() const;
   bool         getM17NetworkDebug() const;
 
   // The Info section
@@ -69,6 +70,8 @@ public:
   bool         getDMRNetworkDebug() const;
   bool         getDMRNetworkJitterEnabled() const;
   unsigned int getDMRNetworkJitter() const;
+  bool         getDMRNetworkSlot1() const;
+  bool         getDMRNetworkSlot2() const;
 
   // The DMR Id section
   std::string  getDMRIdLookupFile() const;
@@ -115,6 +118,8 @@ private:
   bool         m_dmrNetworkDebug;
   bool         m_dmrNetworkJitterEnabled;
   unsigned int m_dmrNetworkJitter;
+  bool         m_dmrNetworkSlot1;
+  bool         m_dmrNetworkSlot2;
 
   std::string  m_dmrIdLookupFile;
   unsigned int m_dmrIdLookupTime;
@@ -126,6 +131,7 @@ private:
   std::string  m_m17LocalAddress;
   unsigned int m_m17LocalPort;
   std::string  m_m17GainAdjDb;
+  bool         m_m17AGC;
   bool         m_m17NetworkDebug;
 
 
@@ -0,0 +1,59 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DMRFrameBuilder_H)
+#define	DMRFrameBuilder_H
+
+#include "DMRDefines.h"
+#include "DMRLC.h"
+
+// Voice bursts in a DMR superframe, A to F
+const unsigned int DMR_VOICE_BURSTS = 6U;
+
+// Builds the DMR bursts sent by a bridge. The voice LC header and terminator, and the
+// sync, EMB and embedded LC of each burst of a superframe, are encoded when the LC
+// changes, usually once per call. A voice burst then only has its middle stamped in.
+class CDMRFrameBuilder {
+public:
+	CDMRFrameBuilder(unsigned int colorCode);
+	~CDMRFrameBuilder();
+
+	// Only encodes again when the LC has changed
+	void setLC(FLCO flco, unsigned int srcId, unsigned int dstId);
+
+	// The whole burst is written
+	void getHeader(unsigned char* data) const;
+	void getTerminator(unsigned char* data) const;
+
+	// The voice already in the burst is kept
+	void getVoice(unsigned char* data, unsigned int n) const;
+
+private:
+	unsigned int  m_colorCode;
+	FLCO          m_flco;
+	unsigned int  m_srcId;
+	unsigned int  m_dstId;
+	bool          m_valid;
+	unsigned char m_header[DMR_FRAME_LENGTH_BYTES];
+	unsigned char m_terminator[DMR_FRAME_LENGTH_BYTES];
+	unsigned char m_voice[DMR_VOICE_BURSTS][7U];		// Bytes 13 to 19, under SYNC_MASK
+
+	void encodeLC(unsigned char* data, const CDMRLC& lc, unsigned char dataType) const;
+};
+
+#endif
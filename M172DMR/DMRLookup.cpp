@@ -18,21 +18,188 @@
 */
 
 #include "DMRLookup.h"
+#include "FileWatcher.h"
+#include "StopWatch.h"
 #include "Timer.h"
 #include "Log.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
 
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static bool compareId(const CDMRIdRecord& a, const CDMRIdRecord& b)
+{
+	return a.m_id < b.m_id;
+}
+
+// Orders records by callsign, the callsigns being offsets into one block of text
+struct CDMRIdCallsignLess {
+	CDMRIdCallsignLess(const char* strings) :
+	m_strings(strings)
+	{
+	}
+
+	bool operator()(const CDMRIdRecord& a, const CDMRIdRecord& b) const
+	{
+		return ::strcmp(m_strings + a.m_callsign, m_strings + b.m_callsign) < 0;
+	}
+
+	const char* m_strings;
+};
+
+static bool hasId(const std::vector<CDMRIdRecord>& records, unsigned int id)
+{
+	CDMRIdRecord key;
+	key.m_id       = id;
+	key.m_callsign = 0U;
+
+	return std::binary_search(records.begin(), records.end(), key, compareId);
+}
+
+static bool hasCallsign(const std::vector<CDMRIdRecord>& records, const char* strings, const char* cs)
+{
+	size_t lo = 0U;
+	size_t hi = records.size();
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2U;
+		int cmp = ::strcmp(strings + records[mid].m_callsign, cs);
+		if (cmp == 0)
+			return true;
+		else if (cmp < 0)
+			lo = mid + 1U;
+		else
+			hi = mid;
+	}
+
+	return false;
+}
+
+CDMRLookup::CDMRLookupTable::CDMRLookupTable() :
+m_table(),
+m_cstable(),
+m_base(),
+m_removedIds(),
+m_removedCSs(),
+m_count(0U),
+m_map(NULL),
+m_mapLength(0U),
+m_header(NULL),
+m_records(NULL),
+m_buckets(NULL),
+m_slots(NULL),
+m_strings(NULL)
+{
+}
+
+CDMRLookup::CDMRLookupTable::~CDMRLookupTable()
+{
+	if (m_map != NULL) {
+#if defined(_WIN32) || defined(_WIN64)
+		::UnmapViewOfFile(m_map);
+#else
+		::munmap(m_map, m_mapLength);
+#endif
+	}
+}
+
+size_t CDMRLookup::CDMRLookupTable::size() const
+{
+	if (m_header != NULL)
+		return m_header->m_records;
+
+	if (m_base != NULL)
+		return m_count;
+
+	return m_table.size();
+}
+
+// The number of entries held on top of the base table
+size_t CDMRLookup::CDMRLookupTable::changes() const
+{
+	return m_table.size() + m_cstable.size() + m_removedIds.size() + m_removedCSs.size();
+}
+
+const char* CDMRLookup::CDMRLookupTable::getCS(unsigned int id) const
+{
+	if (m_header == NULL) {
+		std::unordered_map<unsigned int, std::string>::const_iterator it = m_table.find(id);
+		if (it != m_table.end())
+			return it->second.c_str();
+
+		if (m_base == NULL || m_removedIds.count(id) > 0U)
+			return NULL;
+
+		return m_base->getCS(id);
+	}
+
+	unsigned int lo = 0U;
+	unsigned int hi = m_header->m_records;
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2U;
+		if (m_records[mid].m_id < id)
+			lo = mid + 1U;
+		else
+			hi = mid;
+	}
+
+	if (lo == m_header->m_records || m_records[lo].m_id != id || m_records[lo].m_callsign >= m_header->m_stringLength)
+		return NULL;
+
+	return m_strings + m_records[lo].m_callsign;
+}
+
+bool CDMRLookup::CDMRLookupTable::findCS(unsigned int id, std::string& cs) const
+{
+	const char* text = getCS(id);
+	if (text == NULL)
+		return false;
+
+	cs = std::string(text);
+	return true;
+}
+
+bool CDMRLookup::CDMRLookupTable::findID(const std::string& cs, unsigned int& id) const
+{
+	if (m_header == NULL) {
+		std::unordered_map<std::string, unsigned int>::const_iterator it = m_cstable.find(cs);
+		if (it != m_cstable.end()) {
+			id = it->second;
+			return true;
+		}
+
+		if (m_base == NULL || m_removedCSs.count(cs) > 0U)
+			return false;
+
+		return m_base->findID(cs, id);
+	}
+
+	unsigned int bucket = DMRIdHash(cs.c_str(), 0U) % m_header->m_buckets;
+	unsigned int slot   = DMRIdHash(cs.c_str(), m_buckets[bucket]) % m_header->m_slots;
+
+	const CDMRIdRecord& record = m_slots[slot];
+	if (record.m_callsign >= m_header->m_stringLength || cs != (m_strings + record.m_callsign))
+		return false;
+
+	id = record.m_id;
+	return true;
+}
+
 CDMRLookup::CDMRLookup(const std::string& filename, unsigned int reloadTime) :
 CThread(),
 m_filename(filename),
 m_reloadTime(reloadTime),
-m_table(),
-m_cstable(),
-m_mutex(),
+m_tables(),
+m_maxLookup(0U),
 m_stop(false)
 {
 }
@@ -55,14 +222,34 @@ void CDMRLookup::entry()
 {
 	LogInfo("Started the DMR Id lookup reload thread");
 
-	CTimer timer(1U, 3600U * m_reloadTime);
+	// A change to the file is picked up at once, the timer remains for file systems that inotify cannot watch
+	CFileWatcher watcher(m_filename);
+	watcher.open();
+
+	CTimer timer(1000U, 3600U * m_reloadTime);
 	timer.start();
 
+	// A wait can return early or late, so the timer goes by the time that has passed
+	CStopWatch stopWatch;
+	stopWatch.start();
+
 	while (!m_stop) {
-		sleep(1000U);
+		bool changed = false;
+		if (watcher.isOpen()) {
+			changed = watcher.wait(1000U);
+
+			// Let a file that is still being written settle first
+			while (changed && !m_stop && watcher.wait(1000U))
+				;
+		} else {
+			sleep(1000U);
+		}
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
 
-		timer.clock();
-		if (timer.hasExpired()) {
+		timer.clock(ms);
+		if ((changed || timer.hasExpired()) && !m_stop) {
 			load();
 			timer.start();
 		}
@@ -83,54 +270,64 @@ void CDMRLookup::stop()
 	wait();
 }
 
-std::string CDMRLookup::findCS(unsigned int id)
+std::shared_ptr<const CDMRLookup::CDMRLookupTable> CDMRLookup::getTables() const
 {
-	std::string callsign;
+	return std::atomic_load(&m_tables);
+}
 
+void CDMRLookup::lookupTime(unsigned long long start)
+{
+	unsigned int elapsed = (unsigned int)(CStopWatch::getMicroseconds() - start);
+
+	unsigned int max = m_maxLookup.load(std::memory_order_relaxed);
+	while (elapsed > max && !m_maxLookup.compare_exchange_weak(max, elapsed, std::memory_order_relaxed))
+		;
+}
+
+std::string CDMRLookup::findCS(unsigned int id)
+{
 	if (id == 0xFFFFFFU)
 		return std::string("ALL");
 
-	m_mutex.lock();
+	unsigned long long start = CStopWatch::getMicroseconds();
 
-	try {
-		callsign = m_table.at(id);
-	} catch (...) {
+	std::string callsign;
+
+	std::shared_ptr<const CDMRLookupTable> tables = getTables();
+	if (tables == NULL || !tables->findCS(id, callsign)) {
 		char text[10U];
 		::sprintf(text, "%u", id);
 		callsign = std::string(text);
 	}
 
-	m_mutex.unlock();
+	lookupTime(start);
 
 	return callsign;
 }
 
 unsigned int CDMRLookup::findID(std::string cs)
 {
-	unsigned int dmrID;
+	unsigned long long start = CStopWatch::getMicroseconds();
 
-	m_mutex.lock();
+	unsigned int dmrID = 0U;
 
-	try {
-		dmrID = m_cstable.at(cs);
-	} catch (...) {
-		dmrID = 0U;
-	}
+	std::shared_ptr<const CDMRLookupTable> tables = getTables();
+	if (tables != NULL)
+		tables->findID(cs, dmrID);
 
-	m_mutex.unlock();
+	lookupTime(start);
 
 	return dmrID;
 }
 
 bool CDMRLookup::exists(unsigned int id)
 {
-	m_mutex.lock();
-
-	bool found = m_table.count(id) == 1U;
-
-	m_mutex.unlock();
+	std::shared_ptr<const CDMRLookupTable> tables = getTables();
+	if (tables == NULL)
+		return false;
 
-	return found;
+	std::string callsign;
+	return tables->findCS(id, callsign);
 }
 
 bool CDMRLookup::load()
@@ -141,11 +338,72 @@ bool CDMRLookup::load()
 		return false;
 	}
 
-	m_mutex.lock();
+	unsigned long long start = CStopWatch::getMicroseconds();
+
+	std::shared_ptr<const CDMRLookupTable> old = getTables();
+
+	// Build the new tables without touching the ones the readers are using
+	std::shared_ptr<CDMRLookupTable> tables(new CDMRLookupTable);
+
+	char magic[DMRID_MAGIC_LENGTH];
+	bool binary = ::fread(magic, 1U, DMRID_MAGIC_LENGTH, fp) == DMRID_MAGIC_LENGTH && ::memcmp(magic, DMRID_MAGIC, DMRID_MAGIC_LENGTH) == 0;
+	::rewind(fp);
+
+	CDMRIdChanges changes = { 0U, 0U, 0U, 0U };
+	bool update = false;
 
-	// Remove the old entries
-	m_table.clear();
-	m_cstable.clear();
+	bool ret;
+	if (binary) {
+		ret = loadBinary(fp, *tables);
+	} else {
+		CDMRIdText text;
+		ret = loadText(fp, text);
+
+		// When the current tables came from a text file only the entries that differ are copied
+		if (ret && !text.m_byId.empty() && old != NULL && old->m_header == NULL)
+			update = updateTables(text, old, *tables, changes);
+
+		if (ret && !update) {
+			tables.reset(new CDMRLookupTable);
+			buildTables(text, *tables);
+		}
+	}
+
+	::fclose(fp);
+
+	size_t size = tables->size();
+	if (!ret || size == 0U)
+		return false;
+
+	if (update && changes.m_added == 0U && changes.m_removed == 0U && changes.m_changed == 0U && changes.m_callsigns == 0U) {
+		LogInfo("The DMR callsign lookup table is unchanged, %u Ids", size);
+		return true;
+	}
+
+	std::atomic_store(&m_tables, std::shared_ptr<const CDMRLookupTable>(tables));
+
+	unsigned int elapsed = (unsigned int)((CStopWatch::getMicroseconds() - start) / 1000ULL);
+
+	// The new tables may be built on top of the old ones, which then stay
+	if (tables->m_base == old)
+		old.reset();
+
+	// Free the old tables here rather than in whichever reader happens to drop the last reference
+	while (old != NULL && old.use_count() > 1)
+		sleep(1U);
+	old.reset();
+
+	if (update)
+		LogInfo("Updated the DMR callsign lookup table in %u ms, %u Ids, %u added, %u removed, %u changed, longest lookup %u us", elapsed, size, changes.m_added, changes.m_removed, changes.m_changed, m_maxLookup.exchange(0U));
+	else
+		LogInfo("Loaded %u Ids to the DMR callsign lookup table in %u ms%s, longest lookup %u us", size, elapsed, binary ? " from the binary file" : "", m_maxLookup.exchange(0U));
+
+	return true;
+}
+
+bool CDMRLookup::loadText(FILE* fp, CDMRIdText& text)
+{
+	std::vector<CDMRIdRecord> entries;
 
 	char buffer[100U];
 	while (::fgets(buffer, 100U, fp) != NULL) {
@@ -156,24 +414,213 @@ bool CDMRLookup::load()
 		char* p2 = ::strtok(NULL, " \t\r\n");
 
 		if (p1 != NULL && p2 != NULL) {
-			unsigned int id = (unsigned int)::atoi(p1);
 			for (char* p = p2; *p != 0x00U; p++)
 				*p = ::toupper(*p);
 
-			m_table[id] = std::string(p2);
-			m_cstable[p2] = id;
+			CDMRIdRecord entry;
+			entry.m_id       = (unsigned int)::atoi(p1);
+			entry.m_callsign = (unsigned int)text.m_strings.size();
+			entries.push_back(entry);
+
+			text.m_strings.insert(text.m_strings.end(), p2, p2 + ::strlen(p2) + 1U);
 		}
 	}
 
-	m_mutex.unlock();
+	if (entries.empty())
+		return true;
 
-	::fclose(fp);
+	const char* strings = &text.m_strings[0U];
+
+	// A later line for the same Id or callsign replaces an earlier one
+	std::vector<CDMRIdRecord> sorted(entries);
+	std::stable_sort(sorted.begin(), sorted.end(), compareId);
+	for (size_t i = 0U; i < sorted.size(); i++) {
+		if (i + 1U == sorted.size() || sorted[i + 1U].m_id != sorted[i].m_id)
+			text.m_byId.push_back(sorted[i]);
+	}
+
+	sorted = entries;
+	std::stable_sort(sorted.begin(), sorted.end(), CDMRIdCallsignLess(strings));
+	for (size_t i = 0U; i < sorted.size(); i++) {
+		if (i + 1U == sorted.size() || ::strcmp(strings + sorted[i + 1U].m_callsign, strings + sorted[i].m_callsign) != 0)
+			text.m_byCS.push_back(sorted[i]);
+	}
+
+	return true;
+}
+
+void CDMRLookup::buildTables(const CDMRIdText& text, CDMRLookupTable& tables)
+{
+	if (text.m_byId.empty())
+		return;
+
+	const char* strings = &text.m_strings[0U];
+
+	tables.m_table.reserve(text.m_byId.size());
+	for (std::vector<CDMRIdRecord>::const_iterator it = text.m_byId.begin(); it != text.m_byId.end(); ++it)
+		tables.m_table[it->m_id] = std::string(strings + it->m_callsign);
+
+	tables.m_cstable.reserve(text.m_byCS.size());
+	for (std::vector<CDMRIdRecord>::const_iterator it = text.m_byCS.begin(); it != text.m_byCS.end(); ++it)
+		tables.m_cstable[strings + it->m_callsign] = it->m_id;
+}
+
+// Builds tables holding only the differences between the text and the base table. Returns false
+// when so much has changed that a complete table is the better choice.
+bool CDMRLookup::updateTables(const CDMRIdText& text, const std::shared_ptr<const CDMRLookupTable>& old, CDMRLookupTable& tables, CDMRIdChanges& changes)
+{
+	// Carry forward the differences that the old tables already hold
+	if (old->m_base != NULL) {
+		tables.m_base       = old->m_base;
+		tables.m_table      = old->m_table;
+		tables.m_cstable    = old->m_cstable;
+		tables.m_removedIds = old->m_removedIds;
+		tables.m_removedCSs = old->m_removedCSs;
+	} else {
+		tables.m_base = old;
+	}
+
+	const CDMRLookupTable& base = *tables.m_base;
+	const char* strings = &text.m_strings[0U];
+
+	for (std::vector<CDMRIdRecord>::const_iterator it = text.m_byId.begin(); it != text.m_byId.end(); ++it) {
+		const char* cs = old->getCS(it->m_id);
+		if (cs != NULL && ::strcmp(cs, strings + it->m_callsign) == 0)
+			continue;
+
+		if (cs == NULL)
+			changes.m_added++;
+		else
+			changes.m_changed++;
+
+		tables.m_table[it->m_id] = std::string(strings + it->m_callsign);
+		tables.m_removedIds.erase(it->m_id);
+	}
+
+	for (std::unordered_map<unsigned int, std::string>::const_iterator it = base.m_table.begin(); it != base.m_table.end(); ++it) {
+		if (hasId(text.m_byId, it->first))
+			continue;
+
+		tables.m_table.erase(it->first);
+		if (tables.m_removedIds.insert(it->first).second)
+			changes.m_removed++;
+	}
+
+	if (old->m_base != NULL) {
+		for (std::unordered_map<unsigned int, std::string>::const_iterator it = old->m_table.begin(); it != old->m_table.end(); ++it) {
+			if (hasId(text.m_byId, it->first))
+				continue;
+
+			tables.m_table.erase(it->first);
+			if (base.m_table.count(it->first) == 0U)
+				changes.m_removed++;
+		}
+	}
+
+	for (std::vector<CDMRIdRecord>::const_iterator it = text.m_byCS.begin(); it != text.m_byCS.end(); ++it) {
+		std::string cs(strings + it->m_callsign);
+
+		unsigned int id;
+		if (old->findID(cs, id) && id == it->m_id)
+			continue;
+
+		changes.m_callsigns++;
+
+		tables.m_cstable[cs] = it->m_id;
+		tables.m_removedCSs.erase(cs);
+	}
+
+	for (std::unordered_map<std::string, unsigned int>::const_iterator it = base.m_cstable.begin(); it != base.m_cstable.end(); ++it) {
+		if (hasCallsign(text.m_byCS, strings, it->first.c_str()))
+			continue;
+
+		tables.m_cstable.erase(it->first);
+		if (tables.m_removedCSs.insert(it->first).second)
+			changes.m_callsigns++;
+	}
+
+	if (old->m_base != NULL) {
+		for (std::unordered_map<std::string, unsigned int>::const_iterator it = old->m_cstable.begin(); it != old->m_cstable.end(); ++it) {
+			if (hasCallsign(text.m_byCS, strings, it->first.c_str()))
+				continue;
+
+			tables.m_cstable.erase(it->first);
+			if (base.m_cstable.count(it->first) == 0U)
+				changes.m_callsigns++;
+		}
+	}
+
+	tables.m_count = text.m_byId.size();
+
+	return tables.changes() <= base.size() / 4U;
+}
+
+// The file is mapped read only and shared, so every process using it shares the page cache.
+// DMRIdCompile replaces the file with a rename, an existing mapping keeps the old contents.
+bool CDMRLookup::loadBinary(FILE* fp, CDMRLookupTable& tables)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	HANDLE file = (HANDLE)::_get_osfhandle(::_fileno(fp));
+
+	LARGE_INTEGER fileSize;
+	if (file == INVALID_HANDLE_VALUE || !::GetFileSizeEx(file, &fileSize) || size_t(fileSize.QuadPart) < sizeof(CDMRIdHeader)) {
+		LogWarning("The binary DMR Id lookup file is truncated - %s", m_filename.c_str());
+		return false;
+	}
+
+	size_t length = size_t(fileSize.QuadPart);
+
+	// The view keeps the mapping alive after its handle is closed
+	void* map = NULL;
+	HANDLE mapping = ::CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping != NULL) {
+		map = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		::CloseHandle(mapping);
+	}
 
-	size_t size = m_table.size();
-	if (size == 0U)
+	if (map == NULL) {
+		LogWarning("Cannot map the binary DMR Id lookup file - %s", m_filename.c_str());
+		return false;
+	}
+#else
+	struct stat st;
+	if (::fstat(::fileno(fp), &st) != 0 || size_t(st.st_size) < sizeof(CDMRIdHeader)) {
+		LogWarning("The binary DMR Id lookup file is truncated - %s", m_filename.c_str());
 		return false;
+	}
 
-	LogInfo("Loaded %u Ids to the DMR callsign lookup table", size);
+	size_t length = st.st_size;
+
+	void* map = ::mmap(NULL, length, PROT_READ, MAP_SHARED, ::fileno(fp), 0);
+	if (map == MAP_FAILED) {
+		LogWarning("Cannot map the binary DMR Id lookup file - %s", m_filename.c_str());
+		return false;
+	}
+#endif
+
+	tables.m_map       = map;
+	tables.m_mapLength = length;
+
+	const unsigned char* base = (const unsigned char*)map;
+	const CDMRIdHeader* header = (const CDMRIdHeader*)base;
+
+	// Make sure every area lies inside the file before trusting any offset
+	bool valid = header->m_buckets > 0U && header->m_slots > 0U &&
+		header->m_recordOffset + size_t(header->m_records) * sizeof(CDMRIdRecord) <= length &&
+		header->m_bucketOffset + size_t(header->m_buckets) * sizeof(unsigned int) <= length &&
+		header->m_slotOffset   + size_t(header->m_slots) * sizeof(CDMRIdRecord) <= length &&
+		header->m_stringOffset + size_t(header->m_stringLength) <= length &&
+		header->m_stringLength > 0U && base[header->m_stringOffset + header->m_stringLength - 1U] == 0x00U;
+	if (!valid) {
+		LogWarning("The binary DMR Id lookup file is corrupt - %s", m_filename.c_str());
+		return false;
+	}
+
+	tables.m_header  = header;
+	tables.m_records = (const CDMRIdRecord*)(base + header->m_recordOffset);
+	tables.m_buckets = (const unsigned int*)(base + header->m_bucketOffset);
+	tables.m_slots   = (const CDMRIdRecord*)(base + header->m_slotOffset);
+	tables.m_strings = (const char*)(base + header->m_stringOffset);
 
 	return true;
-}
\ No newline at end of file
+}
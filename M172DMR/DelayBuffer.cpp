@@ -34,6 +34,8 @@ m_timer(1000U, 0U, jitterTime),
 m_stopWatch(),
 m_running(false),
 m_buffer(5000U, name.c_str()),
+m_times(5000U / blockSize + 2U, name.c_str()),
+m_added(0ULL),
 m_outputCount(0U),
 m_lastData(NULL),
 m_lastDataLength(0U),
@@ -62,7 +64,12 @@ bool CDelayBuffer::addData(const unsigned char* data, unsigned int length)
 	if (m_debug)
 		LogDebug("%s, DelayBuffer: appending data", m_name.c_str());
 
-	m_buffer.addData(data, length);
+	unsigned long long added = CStopWatch::getMicroseconds();
+
+	if (m_buffer.addData(data, length))
+		m_times.addData(&added, 1U);
+	else
+		m_times.clear();
 
 	if (!m_timer.isRunning()) {
 		if (m_debug)
@@ -91,6 +98,8 @@ B_STATUS CDelayBuffer::getData(unsigned char* data, unsigned int& length)
 		if (m_buffer.getData(data, m_blockSize)) {
 			length = m_blockSize;
 
+			m_times.getData(&m_added, 1U);
+
 			// Save this data in case no more data is available next time
 			::memcpy(m_lastData, data, length);
 			m_lastDataLength = length;
@@ -126,6 +135,8 @@ B_STATUS CDelayBuffer::getData(unsigned char* data, unsigned int& length)
 		m_lastDataValid = false;
 		length = m_lastDataLength;
 
+		m_added = 0ULL;
+
 		m_outputCount++;
 
 		return BS_MISSING;
@@ -137,6 +148,7 @@ B_STATUS CDelayBuffer::getData(unsigned char* data, unsigned int& length)
 void CDelayBuffer::reset()
 {
 	m_buffer.clear();
+	m_times.clear();
 
 	m_lastDataLength = 0U;
 
@@ -157,3 +169,13 @@ void CDelayBuffer::clock(unsigned int ms)
 		}
 	}
 }
+
+unsigned int CDelayBuffer::getDepth() const
+{
+	return m_buffer.dataSize() / m_blockSize;
+}
+
+unsigned long long CDelayBuffer::getAdded() const
+{
+	return m_added;
+}
@@ -29,8 +29,8 @@
 #define M17_FRAME_PER      35U
 #define M17_PING_TIMEOUT    35000U
 
-#define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
+#define DMR_SLOT_WATCHDOG   25U		// Missing frames, 1.5s as for the network watchdog
 
 const char* DEFAULT_INI_FILE = "/etc/M172DMR.ini";
 
@@ -137,6 +137,8 @@ m_m17Ref(),
 m_conf(configFile),
 m_dmrNetwork(NULL),
 m_dmrlookup(NULL),
+m_m17Identities(),
+m_dmrIdentities(),
 m_conv(),
 m_colorcode(1U),
 m_srcHS(1U),
@@ -150,15 +152,22 @@ m_m17Frame(NULL),
 m_m17Frames(0U),
 m_dmrFrame(NULL),
 m_dmrFrames(0U),
-m_EmbeddedLC(),
+m_dmrBuilder(NULL),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
 m_xlxmodule(),
 m_xlxConnected(false),
 m_xlxReflectors(NULL),
 m_xlxrefl(0U),
-m_firstSync(false)
+m_firstSync(false),
+m_slot1(false),
+m_slot2(true),
+m_rxSlot(0U),
+m_txSlot(2U)
 {
+	m_slotDstId[0U]  = m_slotDstId[1U]  = m_slotDstId[2U]  = 0U;
+	m_slotMissing[0U] = m_slotMissing[1U] = m_slotMissing[2U] = 0U;
+
 	m_m17Frame = new unsigned char[100U];
 	m_dmrFrame  = new unsigned char[50U];
 
@@ -267,6 +276,7 @@ int CM172DMR::run()
 	bool m17_debug               = m_conf.getM17NetworkDebug();
 	
 	m_conv.setM17GainAdjDb(m_conf.getM17GainAdjDb());
+	m_conv.setM17AGC(m_conf.getM17AGC());
 	
 	uint16_t streamid = 0;
 	unsigned char m17_src[10];
@@ -278,7 +288,7 @@ int CM172DMR::run()
 	
 	std::string fileName    = m_conf.getDMRXLXFile();
 	m_xlxReflectors = new CReflectors(fileName, 60U);
-	m_xlxReflectors->load();
+	m_xlxReflectors->read();
 	
 	m_m17Network = new CM17Network(m17_localAddress, m17_localPort, m17_dstAddress, m17_dstPort, m17_src, m17_debug);
 	
@@ -296,6 +306,8 @@ int CM172DMR::run()
 		return 1;
 	}
 
+	m_dmrBuilder = new CDMRFrameBuilder(m_colorcode);
+
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
 
@@ -376,16 +388,28 @@ int CM172DMR::run()
 				else{
 					m_conv.putM17(m_m17Frame);
 				}
-				uint8_t cs[10];
-				memcpy(cs, m_m17Frame+12, 6);
-				decode_callsign(cs);
-				std::string css((char *)cs);
-				css = css.substr(0, css.find(' '));
-				 
-				int dmrid = m_dmrlookup->findID(css);
-				if(dmrid){
-					m_dmrSrc = dmrid;
+				// The stream id and the encoded source identify the caller for the whole stream
+				unsigned int streamId = (m_m17Frame[4U] << 8) | m_m17Frame[5U];
+
+				CIdentity identity;
+				if (!m_m17Identities.find(streamId, m_m17Frame + 12U, 6U, identity)) {
+					uint8_t cs[10];
+					memcpy(cs, m_m17Frame+12, 6);
+					decode_callsign(cs);
+					std::string css((char *)cs);
+					css = css.substr(0, css.find(' '));
+
+					identity.m_id = m_dmrlookup->findID(css);
+					m_m17Identities.add(streamId, m_m17Frame + 12U, 6U, identity);
+				}
+
+				if(identity.m_id){
+					m_dmrSrc = identity.m_id;
 				}
+
+				if (m_m17Frame[34U] & 0x80U)
+					m_m17Identities.remove(streamId);
+
 				m_m17Frames++;
 			}
 		}
@@ -397,8 +421,9 @@ int CM172DMR::run()
 				LogMessage("Sending DMR Header");
 				CDMRData rx_dmrdata;
 				dmr_cnt = 0U;
+				m_txSlot = getTxSlot(m_dstid);
 				
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -408,20 +433,9 @@ int CM172DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
+				// Header, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getHeader(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -444,10 +458,9 @@ int CM172DMR::run()
 				if (n_dmr) {
 					for (unsigned int i = 0U; i < fill; i++) {
 
-						CDMREMB emb;
 						CDMRData rx_dmrdata;
 
-						rx_dmrdata.setSlotNo(2U);
+						rx_dmrdata.setSlotNo(m_txSlot);
 						rx_dmrdata.setSrcId(m_dmrSrc);
 						rx_dmrdata.setDstId(m_dstid);
 						rx_dmrdata.setFLCO(m_dmrflco);
@@ -459,13 +472,8 @@ int CM172DMR::run()
 
 						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
 
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
+						// Add the EMB and embedded LC
+						m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
 
 						rx_dmrdata.setData(m_dmrFrame);
 
@@ -478,7 +486,7 @@ int CM172DMR::run()
 					}
 				}
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -488,19 +496,9 @@ int CM172DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+				// Terminator, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getTerminator(m_dmrFrame);
 
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -510,11 +508,10 @@ int CM172DMR::run()
 			}
 			else if(dmrFrameType == TAG_DATA) {
 				LogMessage("Sending DMR Data");
-				CDMREMB emb;
 				CDMRData rx_dmrdata;
 				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -525,23 +522,16 @@ int CM172DMR::run()
 			
 				if (!n_dmr) {
 					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
+					// Any change of the LC is sent from this superframe
+					m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
 				}
 				else {
 					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
 				}
 
+				// Add the sync, or the EMB and embedded LC
+				m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
+
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -553,6 +543,34 @@ int CM172DMR::run()
 		}
 
 		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int slotNo = tx_dmrdata.getSlotNo();
+
+			if (!tx_dmrdata.isMissing() && tx_dmrdata.getFLCO() == FLCO_GROUP)
+				m_slotDstId[slotNo] = tx_dmrdata.getDstId();
+
+			// There is a single conversion to the other mode, the first slot to start a call keeps it,
+			// and a call on the other slot is picked up by its late entry once that call has ended
+			if (m_rxSlot == 0U && !tx_dmrdata.isMissing()) {
+				m_rxSlot = slotNo;
+				m_slotMissing[slotNo] = 0U;
+			}
+
+			if (slotNo != m_rxSlot) {
+				// The buffer of the other slot is still reset when its call ends, or when it stops without a terminator
+				if (tx_dmrdata.isMissing())
+					m_slotMissing[slotNo]++;
+				else
+					m_slotMissing[slotNo] = 0U;
+
+				bool ended = !tx_dmrdata.isMissing() && tx_dmrdata.getDataType() == DT_TERMINATOR_WITH_LC;
+				if (ended || m_slotMissing[slotNo] >= DMR_SLOT_WATCHDOG) {
+					m_dmrNetwork->reset(slotNo);
+					m_slotMissing[slotNo] = 0U;
+				}
+
+				continue;
+			}
+
 			m_dmrSrc = tx_dmrdata.getSrcId();
 			m_dmrDst = tx_dmrdata.getDstId();
 			
@@ -560,12 +578,25 @@ int CM172DMR::run()
 				m_dmrSrc = m_srcHS;
 			}
 			
-			memset(m17_src, 0, 10);
-			std::string css = m_dmrlookup->findCS(m_dmrSrc);
-			memcpy(m17_src, css.c_str(), css.size());
-			m17_src[css.size()] = ' ';
-			m17_src[css.size()+1] = 'D';
-			encode_callsign(m17_src);
+			unsigned char source[3U];
+			source[0U] = m_dmrSrc >> 16;
+			source[1U] = m_dmrSrc >> 8;
+			source[2U] = m_dmrSrc >> 0;
+
+			CIdentity identity;
+			if (!m_dmrIdentities.find(tx_dmrdata.getStreamId(), source, 3U, identity)) {
+				memset(m17_src, 0, 10);
+				std::string css = m_dmrlookup->findCS(m_dmrSrc);
+				memcpy(m17_src, css.c_str(), css.size());
+				m17_src[css.size()] = ' ';
+				m17_src[css.size()+1] = 'D';
+				encode_callsign(m17_src);
+
+				memcpy(identity.m_encoded, m17_src, 10);
+				m_dmrIdentities.add(tx_dmrdata.getStreamId(), source, 3U, identity);
+			} else {
+				memcpy(m17_src, identity.m_encoded, 10);
+			}
 			
 			
 			FLCO netflco = tx_dmrdata.getFLCO();
@@ -574,9 +605,13 @@ int CM172DMR::run()
 			if (!tx_dmrdata.isMissing()) {
 				networkWatchdog.start();
 
+				if (DataType == DT_TERMINATOR_WITH_LC)
+					m_dmrIdentities.remove(tx_dmrdata.getStreamId());
+
 				if(DataType == DT_TERMINATOR_WITH_LC) {
 					if (m_dmrFrames == 0U) {
-						m_dmrNetwork->reset(2U);
+						m_dmrNetwork->reset(m_rxSlot);
+						m_rxSlot = 0U;
 						networkWatchdog.stop();
 						m_dmrinfo = false;
 						m_firstSync = false;
@@ -586,7 +621,8 @@ int CM172DMR::run()
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
 					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -638,7 +674,8 @@ int CM172DMR::run()
 				networkWatchdog.clock(ms);
 				if (networkWatchdog.hasExpired()) {
 					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -709,19 +746,21 @@ int CM172DMR::run()
 			m_xlxConnected = false;
 		}
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
-
 		if (ms < 5U) CThread::sleep(5U);
 	}
 
 	m_m17Network->close();
 	m_dmrNetwork->close();
 	delete m_dmrNetwork;
+	delete m_dmrBuilder;
 	delete m_m17Network;
 
-	if (m_xlxReflectors != NULL)
+	LogMessage("Identity cache, M17 sources: %u hits, %u misses, DMR sources: %u hits, %u misses", m_m17Identities.getHits(), m_m17Identities.getMisses(), m_dmrIdentities.getHits(), m_dmrIdentities.getMisses());
+
+	if (m_xlxReflectors != NULL) {
+		m_xlxReflectors->stop();
 		delete m_xlxReflectors;
+	}
 
 	::LogFinalise();
 
@@ -738,9 +777,9 @@ bool CM172DMR::createDMRNetwork()
 	std::string password  = m_conf.getDMRNetworkPassword();
 	bool debug            = m_conf.getDMRNetworkDebug();
 	unsigned int jitter   = m_conf.getDMRNetworkJitter();
-	bool slot1            = false;
-	bool slot2            = true;
-	bool duplex           = false;
+	bool slot1            = m_conf.getDMRNetworkSlot1();
+	bool slot2            = m_conf.getDMRNetworkSlot2() || !slot1;
+	bool duplex           = slot1;		// Slot 1 is only carried by a duplex hotspot
 	HW_TYPE hwType        = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -755,11 +794,11 @@ bool CM172DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (m_srcHS > 99999999U)
@@ -786,6 +825,11 @@ bool CM172DMR::createDMRNetwork()
 	else
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
+	LogMessage("    Slots: %s", slot1 && slot2 ? "1 and 2" : (slot1 ? "1" : "2"));
+
+	m_slot1  = slot1;
+	m_slot2  = slot2;
+	m_txSlot = getTxSlot(m_dstid);
 
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
@@ -831,6 +875,15 @@ bool CM172DMR::createDMRNetwork()
 	return true;
 }
 
+unsigned int CM172DMR::getTxSlot(unsigned int dstId) const
+{
+	// A talkgroup goes out on the slot it was last heard on, anything else on slot 2 when it is carried
+	if (m_slot1 && m_slot2 && m_slotDstId[1U] == dstId && m_slotDstId[2U] != dstId)
+		return 1U;
+
+	return m_slot2 ? 2U : 1U;
+}
+
 void CM172DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -839,7 +892,7 @@ void CM172DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 
 	CDMRData data;
 
-	data.setSlotNo(XLX_SLOT);
+	data.setSlotNo(getTxSlot(dstId));
 	data.setFLCO(FLCO_USER_USER);
 	data.setSrcId(srcId);
 	data.setDstId(dstId);
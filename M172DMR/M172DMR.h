@@ -26,10 +26,12 @@
 #include "DMRNetwork.h"
 #include "M17Network.h"
 #include "DMREmbeddedData.h"
+#include "DMRFrameBuilder.h"
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
+#include "IdentityCache.h"
 #include "Reflectors.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
@@ -66,6 +68,8 @@ private:
 	CDMRNetwork*     m_dmrNetwork;
 	CM17Network*	 m_m17Network;
 	CDMRLookup*      m_dmrlookup;
+	CIdentityCache   m_m17Identities;
+	CIdentityCache   m_dmrIdentities;
 	CModeConv        m_conv;
 	unsigned int     m_colorcode;
 	unsigned int     m_srcHS;
@@ -81,7 +85,7 @@ private:
 	unsigned int     m_m17Frames;
 	unsigned char*   m_dmrFrame;
 	unsigned int     m_dmrFrames;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRFrameBuilder* m_dmrBuilder;
 	FLCO             m_dmrflco;
 	bool             m_dmrinfo;
 	std::string      m_xlxmodule;
@@ -89,8 +93,15 @@ private:
 	CReflectors*     m_xlxReflectors;
 	unsigned int     m_xlxrefl;
 	bool             m_firstSync;
+	bool             m_slot1;
+	bool             m_slot2;
+	unsigned int     m_rxSlot;				// The slot being converted, zero when idle
+	unsigned int     m_txSlot;
+	unsigned int     m_slotDstId[3U];			// The talkgroup last heard on each slot
+	unsigned int     m_slotMissing[3U];			// Missing frames in a row on a slot that is not converted
 
 	bool createDMRNetwork();
+	unsigned int getTxSlot(unsigned int dstId) const;
 	void writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network);
 };
 
@@ -22,6 +22,9 @@
 #define INCLUDED_AMBE_ENCODER_H
 
 #include "mbeenc.h"
+#if defined(NATIVE_AMBE)
+#include "mbedec.h"
+#endif
 #include <stdint.h>
 
 
@@ -34,6 +37,10 @@ public:
 
 private:
 	MBEEncoder *m_mbeenc;
+#if defined(NATIVE_AMBE)
+	MBEEncoder *m_mbeenc49;
+	MBEDecoder *m_mbedec;
+#endif
 };
 
 #endif /* INCLUDED_AMBE_ENCODER_H */
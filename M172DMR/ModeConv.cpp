@@ -453,14 +453,18 @@ const unsigned int C_TABLE[] = { 46U, 50U, 54U, 58U, 62U, 66U, 70U,  3U,  7U, 11
 								 23U, 27U, 31U, 35U, 39U, 43U, 47U, 51U, 55U, 59U, 63U, 67U, 71U };
 
 const unsigned char AMBE_SILENCE[] = {0xB9U, 0xE8U, 0x81U, 0x52U, 0x61U, 0x73U, 0x00U, 0x2AU, 0x6BU};
+const unsigned char C2_SILENCE[]   = {0x00U, 0x01U, 0x43U, 0x09U, 0xE4U, 0x9CU, 0x08U, 0x21U};	// Codec2 3200
 
 CModeConv::CModeConv() :
 m_m17N(0U),
 m_dmrN(0U),
 m_M17(5000U, "DMR2M17"),
 m_DMR(5000U, "M172DMR"),
-m_m17GainMultiplier(1),
-m_m17Attenuate(false)
+m_m17Gain(),
+m_dmrFrames(0U),
+m_dmrSilence(0U),
+m_m17Frames(0U),
+m_m17Silence(0U)
 {
 	m_mbe = new MBEVocoder();
 	m_c2 = new CCodec2(true);
@@ -472,55 +476,48 @@ CModeConv::~CModeConv()
 
 void CModeConv::setM17GainAdjDb(std::string dbstring)
 {
-	float db = std::stof(dbstring);
-	
-	float ratio = powf(10.0, (db/10.0));
-	if(db < 0){
-		ratio = 1/ratio;
-		m_m17Attenuate = true;
-	}
-	m_m17GainMultiplier = (uint16_t)roundf(ratio);
+	m_m17Gain.setGain(dbstring);
 }
 
-void CModeConv::putDMRHeader()
+void CModeConv::setM17AGC(bool enabled)
 {
-	const uint8_t quiet[] = { 0x00u, 0x01u, 0x43u, 0x09u, 0xe4u, 0x9cu, 0x08u, 0x21u };
+	m_m17Gain.setAGC(enabled);
+}
 
+void CModeConv::putDMRHeader()
+{
 	m_M17.addData(&TAG_HEADER, 1U);
-	m_M17.addData(quiet, 8U);
+	m_M17.addData(C2_SILENCE, 8U);
 	m_m17N += 1U;
+
+	if (m_dmrFrames > 0U)
+		LogMessage("DMR to M17: %u frames, %u silent (%.1f%%) not transcoded", m_dmrFrames, m_dmrSilence, 100.0F * float(m_dmrSilence) / float(m_dmrFrames));
+
+	m_dmrFrames = 0U;
+	m_dmrSilence = 0U;
 }
 
 void CModeConv::putDMREOT()
 {
-	const uint8_t quiet[] = { 0x00u, 0x01u, 0x43u, 0x09u, 0xe4u, 0x9cu, 0x08u, 0x21u };
-
 	m_M17.addData(&TAG_EOT, 1U);
-	m_M17.addData(quiet, 8U);
+	m_M17.addData(C2_SILENCE, 8U);
 	m_m17N += 1U;
+
+	if (m_dmrFrames > 0U)
+		LogMessage("DMR to M17: %u frames, %u silent (%.1f%%) not transcoded", m_dmrFrames, m_dmrSilence, 100.0F * float(m_dmrSilence) / float(m_dmrFrames));
+
+	m_dmrFrames = 0U;
+	m_dmrSilence = 0U;
 }
 
 void CModeConv::putDMR(unsigned char* data)
 {
 	assert(data != NULL);
-	
-	int16_t audio[160U];
-	uint8_t ambe[9U];
+
 	uint8_t v_ambe[9U];
-	uint8_t codec2[8U];
-	
-	::memset(audio, 0, sizeof(audio));
-	::memset(ambe, 0, sizeof(ambe));
-	::memset(v_ambe, 0, sizeof(v_ambe));
-	::memset(codec2, 0, sizeof(codec2));
-	
-	decode(data, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	m_c2->codec2_encode(codec2, audio);
-	m_M17.addData(&TAG_DATA, 1U);
-	m_M17.addData(codec2, 8U);
-	m_m17N += 1U;
-	
+
+	putDMRFrame(data);
+
 	data += 9U;
 	for (unsigned int i = 0U; i < 4U; i++)
 		v_ambe[i] = data[i];
@@ -531,14 +528,33 @@ void CModeConv::putDMR(unsigned char* data)
 	for (unsigned int i = 0U; i < 4U; i++)
 		v_ambe[i + 5U] = data[i + 11U];
 
-	decode(v_ambe, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	m_c2->codec2_encode(codec2, audio);
-	m_M17.addData(&TAG_DATA, 1U);
-	m_M17.addData(codec2, 8U);
-	m_m17N += 1U;
-	
-	data += 15U;;
+	putDMRFrame(v_ambe);
+
+	data += 15U;
+	putDMRFrame(data);
+}
+
+void CModeConv::putDMRFrame(const unsigned char* data)
+{
+	int16_t audio[160U];
+	uint8_t ambe[9U];
+	uint8_t codec2[8U];
+
+	m_dmrFrames++;
+
+	// Silence maps straight to silence, no need to run either vocoder
+	if (::memcmp(data, AMBE_SILENCE, 9U) == 0) {
+		m_dmrSilence++;
+		m_M17.addData(&TAG_DATA, 1U);
+		m_M17.addData(C2_SILENCE, 8U);
+		m_m17N += 1U;
+		return;
+	}
+
+	::memset(audio, 0, sizeof(audio));
+	::memset(ambe, 0, sizeof(ambe));
+	::memset(codec2, 0, sizeof(codec2));
+
 	decode(data, ambe, 0U);
 	m_mbe->decode_2450(audio, ambe);
 	m_c2->codec2_encode(codec2, audio);
@@ -574,6 +590,12 @@ void CModeConv::putM17EOT()
 	m_DMR.addData(&TAG_EOT, 1U);
 	m_DMR.addData(vch, 9U);
 	m_dmrN += 1U;
+
+	if (m_m17Frames > 0U)
+		LogMessage("M17 to DMR: %u frames, %u silent (%.1f%%) not transcoded", m_m17Frames, m_m17Silence, 100.0F * float(m_m17Silence) / float(m_m17Frames));
+
+	m_m17Frames = 0U;
+	m_m17Silence = 0U;
 }
 
 void CModeConv::putM17(unsigned char* data)
@@ -593,19 +615,31 @@ void CModeConv::putM17(unsigned char* data)
 	::memcpy(codec2, &data[36], 8);
 	
 	if((data[19] & 0x06U) == 0x04U){	//"3200 Voice";
+		m_m17Frames += 2U;
+
+		// Both halves silent, no need to run either vocoder
+		if (::memcmp(data + 36U, C2_SILENCE, 8U) == 0 && ::memcmp(data + 44U, C2_SILENCE, 8U) == 0) {
+			m_m17Silence += 2U;
+			for (unsigned int i = 0U; i < 2U; i++) {
+				m_DMR.addData(&TAG_DATA, 1U);
+				m_DMR.addData(AMBE_SILENCE, 9U);
+				m_dmrN += 1U;
+			}
+			return;
+		}
+
 		m_c2->codec2_set_mode(true);
 		s = 160;
 	}
 	else{								//"1600 V/D";
+		m_m17Frames += 2U;
 		m_c2->codec2_set_mode(false);
 		s = 320;
 	}
 	
 	m_c2->codec2_decode(audio, codec2);
 	
-	for(size_t i = 0; i < s; ++i){
-		m_m17Attenuate ? audio_adjusted[i] = audio[i] / m_m17GainMultiplier : audio[i] * m_m17GainMultiplier;
-	}
+	m_m17Gain.process(audio, audio_adjusted, s);
 	//m_mbe->encode_2450(audio_adjusted, ambe);
 	m_mbe->encode_dmr(audio_adjusted, ambe);
 	encode(ambe, vch, 0U);
@@ -618,9 +652,7 @@ void CModeConv::putM17(unsigned char* data)
 	if(s == 160){
 		::memcpy(codec2, &data[44], 8);
 		m_c2->codec2_decode(audio, codec2);
-		for(int i = 0; i < 160; ++i){
-			m_m17Attenuate ? audio_adjusted[i] = audio[i] / m_m17GainMultiplier : audio[i] * m_m17GainMultiplier;
-		}
+		m_m17Gain.process(audio, audio_adjusted, 160U);
 	}
 	else{
 		p = &audio_adjusted[160U];
@@ -20,6 +20,7 @@
 
 #include "Defines.h"
 #include "RingBuffer.h"
+#include "PCMGain.h"
 #include "MBEVocoder.h"
 #include "codec2/codec2.h"
 
@@ -32,6 +33,7 @@ public:
 	~CModeConv();
 
 	void setM17GainAdjDb(std::string dbstring);
+	void setM17AGC(bool enabled);
 	void putDMR(unsigned char* data);
 	void putDMRHeader();
 	void putDMREOT();
@@ -50,8 +52,12 @@ private:
 	CRingBuffer<unsigned char> m_DMR;
 	MBEVocoder *m_mbe;
 	CCodec2 *m_c2;
-	uint16_t m_m17GainMultiplier;
-	bool m_m17Attenuate;
+	CPCMGain m_m17Gain;
+	unsigned int m_dmrFrames;
+	unsigned int m_dmrSilence;
+	unsigned int m_m17Frames;
+	unsigned int m_m17Silence;
+	void putDMRFrame(const unsigned char* data);
 	void encode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 	void decode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 };
@@ -0,0 +1,41 @@
+/* -*- c++ -*- */
+/*
+ * AMBE halfrate decoder for the 49 bit (2450 bps) DMR voice frames
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_MBE_DECODER_H
+#define INCLUDED_MBE_DECODER_H
+
+#include <stdint.h>
+#include "ambe.h"
+
+class MBEDecoder {
+public:
+	MBEDecoder();
+	~MBEDecoder();
+	void decode(int16_t samples[], const uint8_t codeword[]);
+	void set_uvquality(const int uvquality) {d_uvquality = uvquality;}
+private:
+	mbe_parms cur_mp;
+	mbe_parms prev_mp;
+	mbe_parms prev_mp_enhanced;
+	int d_uvquality;
+	void decode_49bit(int b[9], const uint8_t inp[49]);
+};
+
+#endif /* INCLUDED_MBE_DECODER_H */
@@ -25,6 +25,7 @@
 #include "M17Network.h"
 #include "YSFPayload.h"
 #include "YSFNetwork.h"
+#include "YSFFrameBuilder.h"
 #include "YSFFICH.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
@@ -52,6 +53,7 @@ private:
 	std::string 	 m_m17Ref;
 	CConf            m_conf;
 	CYSFNetwork*     m_ysfNetwork;
+	CYSFFrameBuilder* m_ysfBuilder;
 	CM17Network*	 m_m17Network;
 	CModeConv        m_conv;
 	std::string      m_m17Src;
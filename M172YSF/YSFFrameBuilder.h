@@ -0,0 +1,65 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(YSFFrameBuilder_H)
+#define	YSFFrameBuilder_H
+
+#include <string>
+#include <vector>
+
+// Frame numbers of a VD mode 2 superframe
+const unsigned int YSF_FRAME_NUMBERS = 8U;
+
+// Builds the YSF network frames sent by a bridge. Everything but the voice and the
+// frame counter is encoded in advance, the FICH and the fixed parts of the DCH when
+// the builder is set up, the header, terminator and callsign DCH when a call starts.
+class CYSFFrameBuilder {
+public:
+	CYSFFrameBuilder(const std::string& callsign, const std::string& radioID);
+	~CYSFFrameBuilder();
+
+	void setFICH(unsigned char callSign, unsigned char callMode, unsigned char frameTotal, unsigned char messageRoute, bool voip, unsigned char dataType, bool sql, unsigned char sqlCode);
+	void setDT(const std::vector<unsigned char>& dt1, const std::vector<unsigned char>& dt2);
+
+	// Only encodes again when the source or destination has changed
+	void setCall(const std::string& source, const std::string& destination);
+
+	// The whole frame is written
+	void getHeader(unsigned char* data) const;
+	void getTerminator(unsigned char* data, unsigned int count) const;
+
+	// The voice already in the frame is kept
+	void getData(unsigned char* data, unsigned int count) const;
+
+private:
+	unsigned char m_net[34U];					// Network header up to the counter
+	std::string   m_radioID;
+	std::string   m_source;
+	std::string   m_destination;
+	unsigned int  m_frameTotal;
+	unsigned char m_headerFICH[30U];				// Sync and FICH
+	unsigned char m_terminatorFICH[30U];
+	unsigned char m_dataFICH[YSF_FRAME_NUMBERS][30U];
+	unsigned char m_header[90U];					// Payload of the header and terminator
+	unsigned char m_dch[YSF_FRAME_NUMBERS][25U];		// The DCH part of a VD mode 2 payload
+
+	void encodeCall();
+	void encodeDCH(unsigned int fn, const unsigned char* dt);
+};
+
+#endif
@@ -17,6 +17,7 @@
  */
 
 #include "YSFNetwork.h"
+#include "StopWatch.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -33,7 +34,8 @@ m_address(),
 m_port(0U),
 m_poll(NULL),
 m_unlink(NULL),
-m_buffer(1000U, "YSF Network Buffer")
+m_buffer(1000U, "YSF Network Buffer"),
+m_received(0ULL)
 {
 	m_poll = new unsigned char[14U];
 	::memcpy(m_poll + 0U, "YSFP", 4U);
@@ -57,7 +59,8 @@ m_address(),
 m_port(0U),
 m_poll(NULL),
 m_unlink(NULL),
-m_buffer(1000U, "YSF Network Buffer")
+m_buffer(1000U, "YSF Network Buffer"),
+m_received(0ULL)
 {
 	m_poll = new unsigned char[14U];
 	::memcpy(m_poll + 0U, "YSFP", 4U);
@@ -151,8 +154,12 @@ void CYSFNetwork::clock(unsigned int ms)
 	if (m_debug)
 		CUtils::dump(1U, "YSF Network Data Received", buffer, length);
 
+	// The arrival time travels with the frame
+	unsigned long long received = CStopWatch::getMicroseconds();
+
 	unsigned char len = length;
 	m_buffer.addData(&len, 1U);
+	m_buffer.addData((unsigned char*)&received, sizeof(unsigned long long));
 
 	m_buffer.addData(buffer, length);
 }
@@ -166,6 +173,7 @@ unsigned int CYSFNetwork::read(unsigned char* data)
 
 	unsigned char len = 0U;
 	m_buffer.getData(&len, 1U);
+	m_buffer.getData((unsigned char*)&m_received, sizeof(unsigned long long));
 
 	m_buffer.getData(data, len);
 
@@ -178,3 +186,8 @@ void CYSFNetwork::close()
 
 	LogMessage("Closing YSF network connection");
 }
+
+unsigned long long CYSFNetwork::getReceived() const
+{
+	return m_received;
+}
@@ -70,6 +70,8 @@ m_dmrNetworkOptions(),
 m_dmrNetworkDebug(false),
 m_dmrNetworkJitterEnabled(true),
 m_dmrNetworkJitter(500U),
+m_dmrNetworkSlot1(false),
+m_dmrNetworkSlot2(true),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_nxdnIdLookupFile(),
@@ -206,6 +208,10 @@ bool CConf::read()
 				m_dmrNetworkJitterEnabled = ::atoi(value) == 1;
 			else if (::strcmp(key, "Jitter") == 0)
 				m_dmrNetworkJitter = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Slot1") == 0)
+				m_dmrNetworkSlot1 = ::atoi(value) == 1;
+			else if (::strcmp(key, "Slot2") == 0)
+				m_dmrNetworkSlot2 = ::atoi(value) == 1;
 		} else if (section == SECTION_DMRID_LOOKUP) {
 			if (::strcmp(key, "File") == 0)
 				m_dmrIdLookupFile = value;
@@ -388,6 +394,16 @@ unsigned int CConf::getDMRNetworkJitter() const
 	return m_dmrNetworkJitter;
 }
 
+bool CConf::getDMRNetworkSlot1() const
+{
+	return m_dmrNetworkSlot1;
+}
+
+bool CConf::getDMRNetworkSlot2() const
+{
+	return m_dmrNetworkSlot2;
+}
+
 std::string CConf::getDMRIdLookupFile() const
 {
 	return m_dmrIdLookupFile;
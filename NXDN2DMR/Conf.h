@@ -67,6 +67,8 @@ public:
   bool         getDMRNetworkDebug() const;
   bool         getDMRNetworkJitterEnabled() const;
   unsigned int getDMRNetworkJitter() const;
+  bool         getDMRNetworkSlot1() const;
+  bool         getDMRNetworkSlot2() const;
 
   // The DMR Id section
   std::string  getDMRIdLookupFile() const;
@@ -117,6 +119,8 @@ private:
   bool         m_dmrNetworkDebug;
   bool         m_dmrNetworkJitterEnabled;
   unsigned int m_dmrNetworkJitter;
+  bool         m_dmrNetworkSlot1;
+  bool         m_dmrNetworkSlot2;
 
   std::string  m_dmrIdLookupFile;
   unsigned int m_dmrIdLookupTime;
@@ -63,7 +63,8 @@ m_height(0),
 m_location(),
 m_description(),
 m_url(),
-m_beacon(false)
+m_beacon(false),
+m_received(0ULL)
 {
 	assert(!address.empty());
 	assert(port > 0U);
@@ -190,6 +191,8 @@ bool CDMRNetwork::read(CDMRData& data)
 				data.setN(n);
 			}
 
+			m_received = m_delayBuffers[slotNo]->getAdded();
+
 			return true;
 		}
 	}
@@ -490,6 +493,18 @@ bool CDMRNetwork::isConnected() const
 	return m_status == RUNNING;
 }
 
+unsigned int CDMRNetwork::getJitterDepth(unsigned int slotNo) const
+{
+	assert(slotNo == 1U || slotNo == 2U);
+
+	return m_delayBuffers[slotNo]->getDepth();
+}
+
+unsigned long long CDMRNetwork::getReceived() const
+{
+	return m_received;
+}
+
 void CDMRNetwork::receiveData(const unsigned char* data, unsigned int length)
 {
 	assert(data != NULL);
@@ -34,8 +34,8 @@
 
 #define NXDNGW_DSTID_DEF    20U
 
-#define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
+#define DMR_SLOT_WATCHDOG   25U		// Missing frames, 1.5s as for the network watchdog
 
 #if defined(_WIN32) || defined(_WIN64)
 const char* DEFAULT_INI_FILE = "NXDN2DMR.ini";
@@ -124,7 +124,7 @@ m_nxdnFrame(NULL),
 m_dmrFrame(NULL),
 m_dmrFrames(0U),
 m_nxdnFrames(0U),
-m_EmbeddedLC(),
+m_dmrBuilder(NULL),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
 m_nxdninfo(false),
@@ -133,8 +133,15 @@ m_xlxConnected(false),
 m_xlxReflectors(NULL),
 m_xlxrefl(0U),
 m_defaultID(65519U),
-m_firstSync(false)
+m_firstSync(false),
+m_slot1(false),
+m_slot2(true),
+m_rxSlot(0U),
+m_txSlot(2U)
 {
+	m_slotDstId[0U]  = m_slotDstId[1U]  = m_slotDstId[2U]  = 0U;
+	m_slotMissing[0U] = m_slotMissing[1U] = m_slotMissing[2U] = 0U;
+
 	m_nxdnFrame = new unsigned char[200U];
 	m_dmrFrame  = new unsigned char[50U];
 
@@ -251,7 +258,7 @@ int CNXDN2DMR::run()
 
 	std::string fileName    = m_conf.getDMRXLXFile();
 	m_xlxReflectors = new CReflectors(fileName, 60U);
-	m_xlxReflectors->load();
+	m_xlxReflectors->read();
 
 	m_nxdnNetwork = new CNXDNNetwork(localAddress, localPort, m_callsign, debug);
 	m_nxdnNetwork->setDestination(dstAddress, dstPort);
@@ -270,6 +277,8 @@ int CNXDN2DMR::run()
 		return 1;
 	}
 
+	m_dmrBuilder = new CDMRFrameBuilder(m_colorcode);
+
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
 
@@ -352,7 +361,7 @@ int CNXDN2DMR::run()
 						std::string netDst = m_nxdnlookup->findCS(m_nxdnDst);
 						LogMessage("Received NXDN header from %s to %s%s", netSrc.c_str(), grp ? "TG " : "", netDst.c_str());
 
-						m_dmrNetwork->reset(2U);	// OE1KBC fix
+						m_dmrNetwork->reset(getTxSlot(m_dstid));	// OE1KBC fix
 
 						m_conv.putNXDNHeader();
 						m_nxdnFrames = 0U;
@@ -365,7 +374,7 @@ int CNXDN2DMR::run()
 							std::string netDst = m_nxdnlookup->findCS(m_nxdnDst);
 							LogMessage("Received NXDN late entry from %s to %s%s", netSrc.c_str(), grp ? "TG " : "", netDst.c_str());
 
-							m_dmrNetwork->reset(2U);	// OE1KBC fix
+							m_dmrNetwork->reset(getTxSlot(m_dstid));	// OE1KBC fix
 
 							m_conv.putNXDNHeader();
 							m_nxdninfo = true;
@@ -388,9 +397,10 @@ int CNXDN2DMR::run()
 			if(dmrFrameType == TAG_HEADER) {
 				CDMRData rx_dmrdata;
 				dmr_cnt = 0U;
+				m_txSlot = getTxSlot(m_dstid);
 				m_dmrSrc = findDMRID(m_nxdnSrc);
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -400,20 +410,9 @@ int CNXDN2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
+				// Header, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getHeader(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -434,10 +433,9 @@ int CNXDN2DMR::run()
 				if (n_dmr) {
 					for (unsigned int i = 0U; i < fill; i++) {
 
-						CDMREMB emb;
 						CDMRData rx_dmrdata;
 
-						rx_dmrdata.setSlotNo(2U);
+						rx_dmrdata.setSlotNo(m_txSlot);
 						rx_dmrdata.setSrcId(m_dmrSrc);
 						rx_dmrdata.setDstId(m_dstid);
 						rx_dmrdata.setFLCO(m_dmrflco);
@@ -449,13 +447,8 @@ int CNXDN2DMR::run()
 
 						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
 
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
+						// Add the EMB and embedded LC
+						m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
 
 						rx_dmrdata.setData(m_dmrFrame);
 
@@ -467,7 +460,7 @@ int CNXDN2DMR::run()
 					}
 				}
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -477,19 +470,9 @@ int CNXDN2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+				// Terminator, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getTerminator(m_dmrFrame);
 
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -498,11 +481,10 @@ int CNXDN2DMR::run()
 				dmrWatch.start();
 			}
 			else if(dmrFrameType == TAG_DATA) {
-				CDMREMB emb;
 				CDMRData rx_dmrdata;
 				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -513,23 +495,16 @@ int CNXDN2DMR::run()
 			
 				if (!n_dmr) {
 					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
+					// Any change of the LC is sent from this superframe
+					m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
 				}
 				else {
 					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
 				}
 
+				// Add the sync, or the EMB and embedded LC
+				m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
+
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -541,6 +516,34 @@ int CNXDN2DMR::run()
 		}
 
 		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int slotNo = tx_dmrdata.getSlotNo();
+
+			if (!tx_dmrdata.isMissing() && tx_dmrdata.getFLCO() == FLCO_GROUP)
+				m_slotDstId[slotNo] = tx_dmrdata.getDstId();
+
+			// There is a single conversion to the other mode, the first slot to start a call keeps it,
+			// and a call on the other slot is picked up by its late entry once that call has ended
+			if (m_rxSlot == 0U && !tx_dmrdata.isMissing()) {
+				m_rxSlot = slotNo;
+				m_slotMissing[slotNo] = 0U;
+			}
+
+			if (slotNo != m_rxSlot) {
+				// The buffer of the other slot is still reset when its call ends, or when it stops without a terminator
+				if (tx_dmrdata.isMissing())
+					m_slotMissing[slotNo]++;
+				else
+					m_slotMissing[slotNo] = 0U;
+
+				bool ended = !tx_dmrdata.isMissing() && tx_dmrdata.getDataType() == DT_TERMINATOR_WITH_LC;
+				if (ended || m_slotMissing[slotNo] >= DMR_SLOT_WATCHDOG) {
+					m_dmrNetwork->reset(slotNo);
+					m_slotMissing[slotNo] = 0U;
+				}
+
+				continue;
+			}
+
 			m_dmrSrc = tx_dmrdata.getSrcId();
 			m_dmrDst = tx_dmrdata.getDstId();
 			
@@ -552,7 +555,8 @@ int CNXDN2DMR::run()
 
 				if(DataType == DT_TERMINATOR_WITH_LC) {
 					if (m_dmrFrames == 0U) {
-						m_dmrNetwork->reset(2U);
+						m_dmrNetwork->reset(m_rxSlot);
+						m_rxSlot = 0U;
 						networkWatchdog.stop();
 						m_dmrinfo = false;
 						m_firstSync = false;
@@ -562,7 +566,8 @@ int CNXDN2DMR::run()
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
 					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -614,7 +619,8 @@ int CNXDN2DMR::run()
 				networkWatchdog.clock(ms);
 				if (networkWatchdog.hasExpired()) {
 					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -746,9 +752,6 @@ int CNXDN2DMR::run()
 
 		m_dmrNetwork->clock(ms);
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
-
 		pollTimer.clock(ms);
 		if (pollTimer.isRunning() && pollTimer.hasExpired() && m_nxdnTG != NXDNGW_DSTID_DEF) {
 			m_nxdnNetwork->writePoll(m_nxdnTG);
@@ -769,10 +772,13 @@ int CNXDN2DMR::run()
 	m_nxdnNetwork->close();
 	m_dmrNetwork->close();
 	delete m_dmrNetwork;
+	delete m_dmrBuilder;
 	delete m_nxdnNetwork;
 
-	if (m_xlxReflectors != NULL)
+	if (m_xlxReflectors != NULL) {
+		m_xlxReflectors->stop();
 		delete m_xlxReflectors;
+	}
 
 	::LogFinalise();
 
@@ -828,9 +834,9 @@ bool CNXDN2DMR::createDMRNetwork()
 	std::string password  = m_conf.getDMRNetworkPassword();
 	bool debug            = m_conf.getDMRNetworkDebug();
 	unsigned int jitter   = m_conf.getDMRNetworkJitter();
-	bool slot1            = false;
-	bool slot2            = true;
-	bool duplex           = false;
+	bool slot1            = m_conf.getDMRNetworkSlot1();
+	bool slot2            = m_conf.getDMRNetworkSlot2() || !slot1;
+	bool duplex           = slot1;		// Slot 1 is only carried by a duplex hotspot
 	HW_TYPE hwType        = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -845,11 +851,11 @@ bool CNXDN2DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (m_srcHS > 99999999U)
@@ -876,6 +882,11 @@ bool CNXDN2DMR::createDMRNetwork()
 	else
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
+	LogMessage("    Slots: %s", slot1 && slot2 ? "1 and 2" : (slot1 ? "1" : "2"));
+
+	m_slot1  = slot1;
+	m_slot2  = slot2;
+	m_txSlot = getTxSlot(m_dstid);
 
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
@@ -921,6 +932,15 @@ bool CNXDN2DMR::createDMRNetwork()
 	return true;
 }
 
+unsigned int CNXDN2DMR::getTxSlot(unsigned int dstId) const
+{
+	// A talkgroup goes out on the slot it was last heard on, anything else on slot 2 when it is carried
+	if (m_slot1 && m_slot2 && m_slotDstId[1U] == dstId && m_slotDstId[2U] != dstId)
+		return 1U;
+
+	return m_slot2 ? 2U : 1U;
+}
+
 void CNXDN2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -929,7 +949,7 @@ void CNXDN2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork
 
 	CDMRData data;
 
-	data.setSlotNo(XLX_SLOT);
+	data.setSlotNo(getTxSlot(dstId));
 	data.setFLCO(FLCO_USER_USER);
 	data.setSrcId(srcId);
 	data.setDstId(dstId);
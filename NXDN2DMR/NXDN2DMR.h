@@ -25,6 +25,7 @@
 #include "ModeConv.h"
 #include "DMRNetwork.h"
 #include "DMREmbeddedData.h"
+#include "DMRFrameBuilder.h"
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
@@ -88,7 +89,7 @@ private:
 	unsigned char*   m_dmrFrame;
 	unsigned int     m_dmrFrames;
 	unsigned int     m_nxdnFrames;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRFrameBuilder* m_dmrBuilder;
 	FLCO             m_dmrflco;
 	bool             m_dmrinfo;
 	bool             m_nxdninfo;
@@ -98,8 +99,15 @@ private:
 	unsigned int     m_xlxrefl;
 	unsigned int     m_defaultID;
 	bool             m_firstSync;
+	bool             m_slot1;
+	bool             m_slot2;
+	unsigned int     m_rxSlot;				// The slot being converted, zero when idle
+	unsigned int     m_txSlot;
+	unsigned int     m_slotDstId[3U];			// The talkgroup last heard on each slot
+	unsigned int     m_slotMissing[3U];			// Missing frames in a row on a slot that is not converted
 
 	bool createDMRNetwork();
+	unsigned int getTxSlot(unsigned int dstId) const;
 	unsigned int findNXDNID(unsigned int dmrid);
 	unsigned int findDMRID(unsigned int nxdnid);
 	unsigned int truncID(unsigned int id);
@@ -33,7 +33,8 @@ enum SECTION {
   SECTION_P25_NETWORK,
   SECTION_DMR_NETWORK,
   SECTION_DMRID_LOOKUP,
-  SECTION_LOG
+  SECTION_LOG,
+  SECTION_METRICS
 };
 
 CConf::CConf(const std::string& file) :
@@ -69,6 +70,8 @@ m_dmrNetworkOptions(),
 m_dmrNetworkDebug(false),
 m_dmrNetworkJitterEnabled(true),
 m_dmrNetworkJitter(500U),
+m_dmrNetworkSlot1(false),
+m_dmrNetworkSlot2(true),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_p25DstId(0U),
@@ -78,10 +81,15 @@ m_p25LocalAddress(),
 m_p25LocalPort(0U),
 m_p25TGListFile(),
 m_p25NetworkDebug(false),
+m_p25DirectTranscode(false),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
 m_logFilePath(),
-m_logFileRoot()
+m_logFileRoot(),
+m_metricsEnabled(false),
+m_metricsAddress("127.0.0.1"),
+m_metricsPort(9101U),
+m_metricsSummaryTime(0U)
 {
 }
 
@@ -116,6 +124,8 @@ bool CConf::read()
 				section = SECTION_DMRID_LOOKUP;
 			else if (::strncmp(buffer, "[Log]", 5U) == 0)
 				section = SECTION_LOG;
+			else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+				section = SECTION_METRICS;
 			else
 				section = SECTION_NONE;
 
@@ -190,6 +200,10 @@ bool CConf::read()
 				m_dmrNetworkJitterEnabled = ::atoi(value) == 1;
 			else if (::strcmp(key, "Jitter") == 0)
 				m_dmrNetworkJitter = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Slot1") == 0)
+				m_dmrNetworkSlot1 = ::atoi(value) == 1;
+			else if (::strcmp(key, "Slot2") == 0)
+				m_dmrNetworkSlot2 = ::atoi(value) == 1;
 		} else if (section == SECTION_P25_NETWORK) {
 			if (::strcmp(key, "StartupDstId") == 0)
 				m_p25DstId = (unsigned int)::atoi(value);
@@ -207,6 +221,8 @@ bool CConf::read()
 				m_daemon = ::atoi(value) == 1;
 			else if (::strcmp(key, "Debug") == 0)
 				m_p25NetworkDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "DirectTranscode") == 0)
+				m_p25DirectTranscode = ::atoi(value) == 1;
 		}
 		else if (section == SECTION_DMRID_LOOKUP) {
 			if (::strcmp(key, "File") == 0)
@@ -222,6 +238,15 @@ bool CConf::read()
 				m_logFileLevel = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "DisplayLevel") == 0)
 				m_logDisplayLevel = (unsigned int)::atoi(value);
+		} else if (section == SECTION_METRICS) {
+			if (::strcmp(key, "Enable") == 0)
+				m_metricsEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Address") == 0)
+				m_metricsAddress = value;
+			else if (::strcmp(key, "Port") == 0)
+				m_metricsPort = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "SummaryTime") == 0)
+				m_metricsSummaryTime = (unsigned int)::atoi(value);
 		}
 	}
 
@@ -355,6 +380,16 @@ unsigned int CConf::getDMRNetworkJitter() const
 	return m_dmrNetworkJitter;
 }
 
+bool CConf::getDMRNetworkSlot1() const
+{
+	return m_dmrNetworkSlot1;
+}
+
+bool CConf::getDMRNetworkSlot2() const
+{
+	return m_dmrNetworkSlot2;
+}
+
 std::string CConf::getDMRIdLookupFile() const
 {
 	return m_dmrIdLookupFile;
@@ -400,6 +435,11 @@ bool CConf::getP25NetworkDebug() const
 	return m_p25NetworkDebug;
 }
 
+bool CConf::getP25DirectTranscode() const
+{
+	return m_p25DirectTranscode;
+}
+
 unsigned int CConf::getLogDisplayLevel() const
 {
 	return m_logDisplayLevel;
@@ -419,3 +459,23 @@ std::string CConf::getLogFileRoot() const
 {
   return m_logFileRoot;
 }
+
+bool CConf::getMetricsEnabled() const
+{
+  return m_metricsEnabled;
+}
+
+std::string CConf::getMetricsAddress() const
+{
+  return m_metricsAddress;
+}
+
+unsigned int CConf::getMetricsPort() const
+{
+  return m_metricsPort;
+}
+
+unsigned int CConf::getMetricsSummaryTime() const
+{
+  return m_metricsSummaryTime;
+}
@@ -42,6 +42,7 @@ public:
   unsigned int getP25LocalPort() const;
   std::string  getP25TGListFile() const;
   bool         getP25NetworkDebug() const;
+  bool         getP25DirectTranscode() const;
 
 
   // The Info section
@@ -70,6 +71,8 @@ public:
   bool         getDMRNetworkDebug() const;
   bool         getDMRNetworkJitterEnabled() const;
   unsigned int getDMRNetworkJitter() const;
+  bool         getDMRNetworkSlot1() const;
+  bool         getDMRNetworkSlot2() const;
 
   // The DMR Id section
   std::string  getDMRIdLookupFile() const;
@@ -81,6 +84,12 @@ public:
   std::string  getLogFilePath() const;
   std::string  getLogFileRoot() const;
 
+  // The Metrics section
+  bool         getMetricsEnabled() const;
+  std::string  getMetricsAddress() const;
+  unsigned int getMetricsPort() const;
+  unsigned int getMetricsSummaryTime() const;
+
 private:
   std::string  m_file;
   std::string  m_callsign;
@@ -116,6 +125,8 @@ private:
   bool         m_dmrNetworkDebug;
   bool         m_dmrNetworkJitterEnabled;
   unsigned int m_dmrNetworkJitter;
+  bool         m_dmrNetworkSlot1;
+  bool         m_dmrNetworkSlot2;
 
   std::string  m_dmrIdLookupFile;
   unsigned int m_dmrIdLookupTime;
@@ -127,6 +138,7 @@ private:
   unsigned int m_p25LocalPort;
   std::string  m_p25TGListFile;
   bool         m_p25NetworkDebug;
+  bool         m_p25DirectTranscode;
 
 
   unsigned int m_logDisplayLevel;
@@ -134,6 +146,11 @@ private:
   std::string  m_logFilePath;
   std::string  m_logFileRoot;
 
+  bool         m_metricsEnabled;
+  std::string  m_metricsAddress;
+  unsigned int m_metricsPort;
+  unsigned int m_metricsSummaryTime;
+
 };
 
 #endif
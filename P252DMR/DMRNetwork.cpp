@@ -63,7 +63,10 @@ m_height(0),
 m_location(),
 m_description(),
 m_url(),
-m_beacon(false)
+m_beacon(false),
+m_packetsIn(0U),
+m_packetsOut(0U),
+m_received(0ULL)
 {
 	assert(!address.empty());
 	assert(port > 0U);
@@ -190,6 +193,10 @@ bool CDMRNetwork::read(CDMRData& data)
 				data.setN(n);
 			}
 
+			m_received = m_delayBuffers[slotNo]->getAdded();
+
+			m_packetsIn.fetch_add(1U, std::memory_order_relaxed);
+
 			return true;
 		}
 	}
@@ -267,6 +274,8 @@ bool CDMRNetwork::write(const CDMRData& data)
 	for (unsigned int i = 0U; i < count; i++)
 		write(buffer, HOMEBREW_DATA_PACKET_LENGTH);
 
+	m_packetsOut.fetch_add(1U, std::memory_order_relaxed);
+
 	return true;
 }
 
@@ -494,6 +503,28 @@ bool CDMRNetwork::isConnected() const
 	return m_status == RUNNING;
 }
 
+unsigned int CDMRNetwork::getJitterDepth(unsigned int slotNo) const
+{
+	assert(slotNo == 1U || slotNo == 2U);
+
+	return m_delayBuffers[slotNo]->getDepth();
+}
+
+unsigned long long CDMRNetwork::getReceived() const
+{
+	return m_received;
+}
+
+const std::atomic<unsigned long long>& CDMRNetwork::getPacketsIn() const
+{
+	return m_packetsIn;
+}
+
+const std::atomic<unsigned long long>& CDMRNetwork::getPacketsOut() const
+{
+	return m_packetsOut;
+}
+
 void CDMRNetwork::receiveData(const unsigned char* data, unsigned int length)
 {
 	assert(data != NULL);
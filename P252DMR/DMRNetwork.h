@@ -26,6 +26,7 @@
 #include "Defines.h"
 
 #include <string>
+#include <atomic>
 #include <cstdint>
 
 class CDMRNetwork
@@ -44,6 +45,9 @@ public:
 
 	bool read(CDMRData& data);
 
+	// When the frame last returned by read() arrived, zero for one made up by the jitter buffer
+	unsigned long long getReceived() const;
+
 	bool write(const CDMRData& data);
 
 	bool writePosition(unsigned int id, const unsigned char* data);
@@ -58,6 +62,13 @@ public:
 
 	bool isConnected() const;
 
+	// The number of packets in the jitter buffer of a slot
+	unsigned int getJitterDepth(unsigned int slotNo) const;
+
+	// Data frames through the network, for the metrics
+	const std::atomic<unsigned long long>& getPacketsIn() const;
+	const std::atomic<unsigned long long>& getPacketsOut() const;
+
 	void close();
 
 private: 
@@ -107,6 +118,10 @@ private:
 
 	bool           m_beacon;
 
+	std::atomic<unsigned long long> m_packetsIn;
+	std::atomic<unsigned long long> m_packetsOut;
+	unsigned long long m_received;
+
 	bool writeLogin();
 	bool writeAuthorisation();
 	bool writeOptions();
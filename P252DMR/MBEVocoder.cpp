@@ -18,7 +18,9 @@
 *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 */
 #include <cstring>
+#if !defined(NATIVE_AMBE)
 #include <md380_vocoder.h>
+#endif
 #include "MBEVocoder.h"
 
 
@@ -28,12 +30,20 @@ const uint8_t  BIT_MASK_TABLE8[]  = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U,
 
 MBEVocoder::MBEVocoder(void)
 {
+#if defined(NATIVE_AMBE)
+	m_mbeenc49 = new MBEEncoder();
+	m_mbeenc49->set_49bit_mode();
+	m_mbeenc49->set_gain_adjust(2.5);
+	m_mbedec = new MBEDecoder();
+#else
 	md380_init();
+#endif
 }
 
-void MBEVocoder::decode_4400(int16_t *pcm, uint8_t *imbe)
+void MBEVocoder::unpack_4400(int16_t *frame, uint8_t *imbe)
 {
-	int16_t frame[8U] = {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000};
+	::memset(frame, 0, 8U * sizeof(int16_t));
+
 	unsigned int offset = 0U;
 
 	int16_t mask = 0x0800;
@@ -67,6 +77,12 @@ void MBEVocoder::decode_4400(int16_t *pcm, uint8_t *imbe)
 	mask = 0x0040;
 	for (unsigned int i = 0U; i < 7U; i++, mask >>= 1, offset++)
 		frame[7U] |= READ_BIT8(imbe, offset) != 0x00U ? mask : 0x0000;
+}
+
+void MBEVocoder::decode_4400(int16_t *pcm, uint8_t *imbe)
+{
+	int16_t frame[8U];
+	unpack_4400(frame, imbe);
 
 	vocoder.imbe_decode(frame, pcm);
 }
@@ -116,10 +132,90 @@ void MBEVocoder::encode_4400(int16_t *pcm, uint8_t *imbe)
 
 void MBEVocoder::decode_2450(int16_t *pcm, uint8_t *ambe49)
 {
+#if defined(NATIVE_AMBE)
+	m_mbedec->decode(pcm, ambe49);
+#else
 	md380_decode(ambe49, pcm);
+#endif
 }
 
 void MBEVocoder::encode_2450(int16_t *pcm, uint8_t *ambe49)
 {
+#if defined(NATIVE_AMBE)
+	uint8_t bits[72U];
+	::memset(bits, 0, sizeof(bits));
+	m_mbeenc49->encode(pcm, bits);
+
+	::memset(ambe49, 0, 7U);
+	for (unsigned int i = 0U; i < 49U; i++)
+		WRITE_BIT8(ambe49, i, bits[i]);
+#else
 	md380_encode(ambe49, pcm);
+#endif
+}
+
+// Convert an IMBE frame to AMBE in the MBE parameter domain: the IMBE model
+// parameters are requantised by the AMBE encoder, so the speech analysis of
+// the synthesised audio done by encode_2450 is skipped. Needs the native AMBE
+// encoder, otherwise (and for invalid pitch) it falls back to PCM tandem.
+void MBEVocoder::transcode_4400_2450(uint8_t *imbe, uint8_t *ambe49)
+{
+	int16_t pcm[160U];
+#if defined(NATIVE_AMBE)
+	int16_t frame[8U];
+	unpack_4400(frame, imbe);
+
+	// b0 is split between u0 and u7
+	unsigned int b0 = ((frame[0U] >> 4) & 0xFC) | ((frame[7U] >> 1) & 0x03);
+	if (b0 <= 207U) {
+		// dequantise, the synthesised audio is not used
+		vocoder.imbe_decode(frame, pcm);
+
+		IMBE_PARAM param = *vocoder.param();
+		param.ref_pitch = (2 * b0 + 79) << 6;	// pitch period (b0 + 39.5) / 2 in Q8.8
+
+		uint8_t bits[72U];
+		::memset(bits, 0, sizeof(bits));
+		m_mbeenc49->encode_params(&param, bits);
+
+		::memset(ambe49, 0, 7U);
+		for (unsigned int i = 0U; i < 49U; i++)
+			WRITE_BIT8(ambe49, i, bits[i]);
+		return;
+	}
+#endif
+	decode_4400(pcm, imbe);
+	encode_2450(pcm, ambe49);
+}
+
+// The vocoders keep state from one frame to the next, so a batch is still
+// processed in order, but each vocoder runs over the whole batch in turn.
+void MBEVocoder::decode_4400(int16_t *pcm, uint8_t *imbe, unsigned int n)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		decode_4400(pcm + i * 160U, imbe + i * 11U);
+}
+
+void MBEVocoder::encode_4400(int16_t *pcm, uint8_t *imbe, unsigned int n)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		encode_4400(pcm + i * 160U, imbe + i * 11U);
+}
+
+void MBEVocoder::decode_2450(int16_t *pcm, uint8_t *ambe49, unsigned int n)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		decode_2450(pcm + i * 160U, ambe49 + i * 7U);
+}
+
+void MBEVocoder::encode_2450(int16_t *pcm, uint8_t *ambe49, unsigned int n)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		encode_2450(pcm + i * 160U, ambe49 + i * 7U);
+}
+
+void MBEVocoder::transcode_4400_2450(uint8_t *imbe, uint8_t *ambe49, unsigned int n)
+{
+	for (unsigned int i = 0U; i < n; i++)
+		transcode_4400_2450(imbe + i * 11U, ambe49 + i * 7U);
 }
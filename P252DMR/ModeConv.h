@@ -21,15 +21,24 @@
 #include "Defines.h"
 #include "RingBuffer.h"
 #include "MBEVocoder.h"
+#include "Profiler.h"
 
 #if !defined(MODECONV_H)
 #define MODECONV_H
 
+const unsigned int DMR_BURST_FRAMES = 3U;
+const unsigned int P25_LDU_FRAMES   = 9U;
+
 class CModeConv {
 public:
 	CModeConv();
 	~CModeConv();
 
+	void setDirectTranscode(bool direct);
+
+	// Accounts for the CPU time of the vocoders, the transcoding summaries take theirs from it
+	void setProfiler(CProfiler* profiler);
+
 	void putDMR(unsigned char* data);
 	void putDMRHeader();
 	void putDMREOT();
@@ -41,12 +50,30 @@ public:
 	unsigned int getP25(unsigned char* data);
 	unsigned int getDMR(unsigned char* data);
 
+	// The number of frames waiting
+	unsigned int getP25Depth() const;
+	unsigned int getDMRDepth() const;
+
 private:
 	unsigned int m_p25N;
 	unsigned int m_dmrN;
 	CRingBuffer<unsigned char> m_P25;
 	CRingBuffer<unsigned char> m_DMR;
 	MBEVocoder *m_mbe;
+	bool m_direct;
+	unsigned int m_dmrFrames;
+	unsigned int m_dmrSilence;
+	uint64_t m_dmrCPU;
+	unsigned int m_p25Frames;
+	unsigned int m_p25Silence;
+	unsigned char m_imbe[P25_LDU_FRAMES * 11U];
+	unsigned int m_imbeN;
+	unsigned int m_p25Batches[P25_LDU_FRAMES + 1U];		// indexed by batch size
+	unsigned int m_p25BatchVoice[P25_LDU_FRAMES + 1U];
+	uint64_t m_p25BatchCPU[P25_LDU_FRAMES + 1U];
+	CProfiler* m_profiler;
+	unsigned int m_vocoderStage;
+	void putP25Batch();
 	void encode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 	void decode(const unsigned char* in, unsigned char* out, unsigned int offset) const;
 };
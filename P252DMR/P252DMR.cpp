@@ -94,8 +94,8 @@ const unsigned char REC80[] = {
 #define DMR_FRAME_PER       55U
 #define P25_FRAME_PER      15U
 
-#define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
+#define DMR_SLOT_WATCHDOG   25U		// Missing frames, 1.5s as for the network watchdog
 
 #if defined(_WIN32) || defined(_WIN64)
 const char* DEFAULT_INI_FILE = "P252DMR.ini";
@@ -179,15 +179,32 @@ m_p25Frame(NULL),
 m_dmrFrame(NULL),
 m_dmrFrames(0U),
 m_p25Frames(0U),
-m_EmbeddedLC(),
+m_dmrBuilder(NULL),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
 m_xlxmodule(),
 m_xlxConnected(false),
 m_xlxReflectors(NULL),
 m_xlxrefl(0U),
-m_firstSync(false)
+m_firstSync(false),
+m_slot1(false),
+m_slot2(true),
+m_rxSlot(0U),
+m_txSlot(2U),
+m_metrics(NULL),
+m_dmrLogins(NULL),
+m_p25Queue(NULL),
+m_dmrQueue(NULL),
+m_slot1Jitter(NULL),
+m_slot2Jitter(NULL),
+m_p25ConvertTime(NULL),
+m_dmrConvertTime(NULL),
+m_profiler(NULL),
+m_networkStage(0U)
 {
+	m_slotDstId[0U]  = m_slotDstId[1U]  = m_slotDstId[2U]  = 0U;
+	m_slotMissing[0U] = m_slotMissing[1U] = m_slotMissing[2U] = 0U;
+
 	m_p25Frame = new unsigned char[200U];
 	m_dmrFrame  = new unsigned char[50U];
 
@@ -298,10 +315,14 @@ int CP252DMR::run()
 	std::string p25_localAddress = m_conf.getP25LocalAddress();
 	unsigned int p25_localPort   = m_conf.getP25LocalPort();
 	bool p25_debug               = m_conf.getP25NetworkDebug();
+	bool p25_direct              = m_conf.getP25DirectTranscode();
+
+	LogMessage("P25 to DMR transcoding: %s", p25_direct ? "direct (parameter domain)" : "tandem (PCM)");
+	m_conv.setDirectTranscode(p25_direct);
 	
 	std::string fileName    = m_conf.getDMRXLXFile();
 	m_xlxReflectors = new CReflectors(fileName, 60U);
-	m_xlxReflectors->load();
+	m_xlxReflectors->read();
 
 	m_p25Network = new CP25Network(p25_localAddress, p25_localPort, p25_dstAddress, p25_dstPort, m_callsign, p25_debug);
 	
@@ -320,12 +341,16 @@ int CP252DMR::run()
 		return 1;
 	}
 
+	m_dmrBuilder = new CDMRFrameBuilder(m_colorcode);
+
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
 
 	m_dmrlookup = new CDMRLookup(lookupFile, reloadTime);
 	m_dmrlookup->read();
 
+	createMetrics();
+
 	if (m_dmrpc)
 		m_dmrflco = FLCO_USER_USER;
 	else
@@ -349,6 +374,8 @@ int CP252DMR::run()
 
 	LogMessage("Starting P252DMR-%s", VERSION);
 
+	bool dmrConnected = false;
+
 	for (; end == 0;) {
 		unsigned char buffer[2000U];
 		unsigned int srcId = 0U;
@@ -401,7 +428,9 @@ int CP252DMR::run()
 					m_p25info = false;
 					m_conv.putP25EOT();
 				}
+				unsigned long long start = CMetrics::getMicroseconds();
 				m_conv.putP25(m_p25Frame);
+				m_p25ConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 				m_p25Frames++;
 			}
 		}
@@ -413,10 +442,11 @@ int CP252DMR::run()
 				LogMessage("Sending DMR Header");
 				CDMRData rx_dmrdata;
 				dmr_cnt = 0U;
+				m_txSlot = getTxSlot(m_dstid);
 				m_dmrSrc = m_p25Src;
 				//m_dmrSrc = m_defsrcid;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -426,20 +456,9 @@ int CP252DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
+				// Header, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getHeader(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -461,10 +480,9 @@ int CP252DMR::run()
 				if (n_dmr) {
 					for (unsigned int i = 0U; i < fill; i++) {
 
-						CDMREMB emb;
 						CDMRData rx_dmrdata;
 
-						rx_dmrdata.setSlotNo(2U);
+						rx_dmrdata.setSlotNo(m_txSlot);
 						rx_dmrdata.setSrcId(m_dmrSrc);
 						rx_dmrdata.setDstId(m_dstid);
 						rx_dmrdata.setFLCO(m_dmrflco);
@@ -476,13 +494,8 @@ int CP252DMR::run()
 
 						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
 
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
+						// Add the EMB and embedded LC
+						m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
 
 						rx_dmrdata.setData(m_dmrFrame);
 
@@ -495,7 +508,7 @@ int CP252DMR::run()
 					}
 				}
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -505,19 +518,9 @@ int CP252DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+				// Terminator, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getTerminator(m_dmrFrame);
 
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -527,11 +530,10 @@ int CP252DMR::run()
 			}
 			else if(dmrFrameType == TAG_DATA) {
 				LogMessage("Sending DMR Data");
-				CDMREMB emb;
 				CDMRData rx_dmrdata;
 				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -542,23 +544,16 @@ int CP252DMR::run()
 			
 				if (!n_dmr) {
 					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
+					// Any change of the LC is sent from this superframe
+					m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
 				}
 				else {
 					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
 				}
 
+				// Add the sync, or the EMB and embedded LC
+				m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
+
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -570,6 +565,34 @@ int CP252DMR::run()
 		}
 
 		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int slotNo = tx_dmrdata.getSlotNo();
+
+			if (!tx_dmrdata.isMissing() && tx_dmrdata.getFLCO() == FLCO_GROUP)
+				m_slotDstId[slotNo] = tx_dmrdata.getDstId();
+
+			// There is a single conversion to the other mode, the first slot to start a call keeps it,
+			// and a call on the other slot is picked up by its late entry once that call has ended
+			if (m_rxSlot == 0U && !tx_dmrdata.isMissing()) {
+				m_rxSlot = slotNo;
+				m_slotMissing[slotNo] = 0U;
+			}
+
+			if (slotNo != m_rxSlot) {
+				// The buffer of the other slot is still reset when its call ends, or when it stops without a terminator
+				if (tx_dmrdata.isMissing())
+					m_slotMissing[slotNo]++;
+				else
+					m_slotMissing[slotNo] = 0U;
+
+				bool ended = !tx_dmrdata.isMissing() && tx_dmrdata.getDataType() == DT_TERMINATOR_WITH_LC;
+				if (ended || m_slotMissing[slotNo] >= DMR_SLOT_WATCHDOG) {
+					m_dmrNetwork->reset(slotNo);
+					m_slotMissing[slotNo] = 0U;
+				}
+
+				continue;
+			}
+
 			m_dmrSrc = tx_dmrdata.getSrcId();
 			m_dmrDst = tx_dmrdata.getDstId();
 			
@@ -585,7 +608,8 @@ int CP252DMR::run()
 
 				if(DataType == DT_TERMINATOR_WITH_LC) {
 					if (m_dmrFrames == 0U) {
-						m_dmrNetwork->reset(2U);
+						m_dmrNetwork->reset(m_rxSlot);
+						m_rxSlot = 0U;
 						networkWatchdog.stop();
 						m_dmrinfo = false;
 						m_firstSync = false;
@@ -595,7 +619,8 @@ int CP252DMR::run()
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
 					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -632,7 +657,9 @@ int CP252DMR::run()
 						m_dmrinfo = true;
 					}
 
+					unsigned long long start = CMetrics::getMicroseconds();
 					m_conv.putDMR(dmr_frame); // Add DMR frame for P25 conversion
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 			}
@@ -640,14 +667,17 @@ int CP252DMR::run()
 				if(DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
 					unsigned char dmr_frame[50];
 					tx_dmrdata.getData(dmr_frame);
+					unsigned long long start = CMetrics::getMicroseconds();
 					m_conv.putDMR(dmr_frame); // Add DMR frame for P25 conversion
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 
 				networkWatchdog.clock(ms);
 				if (networkWatchdog.hasExpired()) {
 					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -792,29 +822,83 @@ int CP252DMR::run()
 			pollTimer.start();
 		}
 
-		if(m_dmrNetwork->clock(ms)){
+		m_profiler->begin(m_networkStage);
+		bool lost = m_dmrNetwork->clock(ms);
+		m_profiler->end(m_networkStage);
+		if (lost) {
 			m_xlxConnected = false;
 		}
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
+		bool connected = m_dmrNetwork->isConnected();
+		if (connected && !dmrConnected)
+			m_dmrLogins->inc();
+		dmrConnected = connected;
+
+		m_p25Queue->set(m_conv.getP25Depth());
+		m_dmrQueue->set(m_conv.getDMRDepth());
+		m_slot1Jitter->set(m_dmrNetwork->getJitterDepth(1U));
+		m_slot2Jitter->set(m_dmrNetwork->getJitterDepth(2U));
+
+		m_profiler->clock(ms);
 
 		if (ms < 2U) CThread::sleep(2U);
 	}
 
+	// The metrics refer to the networks
+	m_metrics->stop();
+
 	m_p25Network->close();
 	m_dmrNetwork->close();
 	delete m_dmrNetwork;
+	delete m_dmrBuilder;
 	delete m_p25Network;
 
-	if (m_xlxReflectors != NULL)
+	if (m_xlxReflectors != NULL) {
+		m_xlxReflectors->stop();
 		delete m_xlxReflectors;
+	}
+
+	delete m_metrics;
+	delete m_profiler;
 
 	::LogFinalise();
 
 	return 0;
 }
 
+void CP252DMR::createMetrics()
+{
+	m_metrics = new CMetrics("p252dmr_");
+
+	// The stages are only measured when the metrics are served or summarised in the log
+	m_profiler     = new CProfiler(m_conf.getMetricsEnabled() || m_conf.getMetricsSummaryTime() > 0U, m_conf.getMetricsSummaryTime());
+	m_networkStage = m_profiler->addStage("network");
+	m_conv.setProfiler(m_profiler);
+
+	m_metrics->addCounter("packets_total{network=\"P25\",direction=\"in\"}", "Data packets through each network", m_p25Network->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"P25\",direction=\"out\"}", "Data packets through each network", m_p25Network->getPacketsOut());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"in\"}", "Data packets through each network", m_dmrNetwork->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"out\"}", "Data packets through each network", m_dmrNetwork->getPacketsOut());
+
+	m_p25ConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"P25-DMR\"}", "Time taken to convert a voice frame, including the vocoders, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+	m_dmrConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"DMR-P25\"}", "Time taken to convert a voice frame, including the vocoders, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+
+	m_p25Queue    = m_metrics->addGauge("queue_frames{queue=\"P25\"}", "Frames waiting in the converter or the jitter buffers");
+	m_dmrQueue    = m_metrics->addGauge("queue_frames{queue=\"DMR\"}", "Frames waiting in the converter or the jitter buffers");
+	m_slot1Jitter = m_metrics->addGauge("queue_frames{queue=\"DMR Slot 1\"}", "Frames waiting in the converter or the jitter buffers");
+	m_slot2Jitter = m_metrics->addGauge("queue_frames{queue=\"DMR Slot 2\"}", "Frames waiting in the converter or the jitter buffers");
+
+	m_metrics->addCounter("lookups_total{result=\"hit\"}", "DMR Id lookups", m_dmrlookup->getHits());
+	m_metrics->addCounter("lookups_total{result=\"miss\"}", "DMR Id lookups", m_dmrlookup->getMisses());
+
+	m_dmrLogins = m_metrics->addCounter("dmr_logins_total", "Logins to the DMR network, including each reconnect");
+
+	m_profiler->addMetrics(m_metrics);
+
+	if (m_conf.getMetricsEnabled())
+		m_metrics->open(m_conf.getMetricsAddress(), m_conf.getMetricsPort());
+}
+
 bool CP252DMR::createDMRNetwork()
 {
 	std::string address   = m_conf.getDMRNetworkAddress();
@@ -825,9 +909,9 @@ bool CP252DMR::createDMRNetwork()
 	std::string password  = m_conf.getDMRNetworkPassword();
 	bool debug            = m_conf.getDMRNetworkDebug();
 	unsigned int jitter   = m_conf.getDMRNetworkJitter();
-	bool slot1            = false;
-	bool slot2            = true;
-	bool duplex           = false;
+	bool slot1            = m_conf.getDMRNetworkSlot1();
+	bool slot2            = m_conf.getDMRNetworkSlot2() || !slot1;
+	bool duplex           = slot1;		// Slot 1 is only carried by a duplex hotspot
 	HW_TYPE hwType        = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -842,11 +926,11 @@ bool CP252DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (m_srcHS > 99999999U)
@@ -873,6 +957,11 @@ bool CP252DMR::createDMRNetwork()
 	else
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
+	LogMessage("    Slots: %s", slot1 && slot2 ? "1 and 2" : (slot1 ? "1" : "2"));
+
+	m_slot1  = slot1;
+	m_slot2  = slot2;
+	m_txSlot = getTxSlot(m_dstid);
 
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
@@ -918,6 +1007,15 @@ bool CP252DMR::createDMRNetwork()
 	return true;
 }
 
+unsigned int CP252DMR::getTxSlot(unsigned int dstId) const
+{
+	// A talkgroup goes out on the slot it was last heard on, anything else on slot 2 when it is carried
+	if (m_slot1 && m_slot2 && m_slotDstId[1U] == dstId && m_slotDstId[2U] != dstId)
+		return 1U;
+
+	return m_slot2 ? 2U : 1U;
+}
+
 void CP252DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -926,7 +1024,7 @@ void CP252DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 
 	CDMRData data;
 
-	data.setSlotNo(XLX_SLOT);
+	data.setSlotNo(getTxSlot(dstId));
 	data.setFLCO(FLCO_USER_USER);
 	data.setSrcId(srcId);
 	data.setDstId(dstId);
@@ -26,11 +26,14 @@
 #include "DMRNetwork.h"
 #include "P25Network.h"
 #include "DMREmbeddedData.h"
+#include "DMRFrameBuilder.h"
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
 #include "Reflectors.h"
+#include "Metrics.h"
+#include "Profiler.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
 #include "Version.h"
@@ -81,7 +84,7 @@ private:
 	unsigned int     m_dmrFrames;
 	unsigned int     m_p25Frames;
 	bool			 m_p25info;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRFrameBuilder* m_dmrBuilder;
 	FLCO             m_dmrflco;
 	bool             m_dmrinfo;
 	std::string      m_xlxmodule;
@@ -89,8 +92,26 @@ private:
 	CReflectors*     m_xlxReflectors;
 	unsigned int     m_xlxrefl;
 	bool             m_firstSync;
+	bool             m_slot1;
+	bool             m_slot2;
+	unsigned int     m_rxSlot;				// The slot being converted, zero when idle
+	unsigned int     m_txSlot;
+	unsigned int     m_slotDstId[3U];			// The talkgroup last heard on each slot
+	unsigned int     m_slotMissing[3U];			// Missing frames in a row on a slot that is not converted
+	CMetrics*        m_metrics;
+	CMetricCounter*  m_dmrLogins;
+	CMetricGauge*    m_p25Queue;
+	CMetricGauge*    m_dmrQueue;
+	CMetricGauge*    m_slot1Jitter;
+	CMetricGauge*    m_slot2Jitter;
+	CMetricHistogram* m_p25ConvertTime;
+	CMetricHistogram* m_dmrConvertTime;
+	CProfiler*       m_profiler;
+	unsigned int     m_networkStage;
 
 	bool createDMRNetwork();
+	unsigned int getTxSlot(unsigned int dstId) const;
+	void createMetrics();
 	void writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network);
 };
 
@@ -29,7 +29,9 @@ m_callsign(callsign),
 m_address(),
 m_port(gatewayPort),
 m_socket(localAddress, localPort),
-m_debug(debug)
+m_debug(debug),
+m_packetsIn(0U),
+m_packetsOut(0U)
 {
 	m_callsign.resize(10U, ' ');
 	m_address = CUDPSocket::lookup(gatewayAddress);
@@ -54,6 +56,8 @@ bool CP25Network::writeData(const unsigned char* data, unsigned int length)
 	if (m_debug)
 		CUtils::dump(1U, "P25 Network Data Sent", data, length);
 
+	m_packetsOut.fetch_add(1U, std::memory_order_relaxed);
+
 	return m_socket.write(data, length, m_address, m_port);
 }
 
@@ -107,6 +111,8 @@ unsigned int CP25Network::readData(unsigned char* data, unsigned int length)
 	if (m_debug)
 		CUtils::dump(1U, "P25 Network Data Received", data, len);
 
+	m_packetsIn.fetch_add(1U, std::memory_order_relaxed);
+
 	return len;
 }
 
@@ -116,3 +122,13 @@ void CP25Network::close()
 
 	LogInfo("Closing P25 network connection");
 }
+
+const std::atomic<unsigned long long>& CP25Network::getPacketsIn() const
+{
+	return m_packetsIn;
+}
+
+const std::atomic<unsigned long long>& CP25Network::getPacketsOut() const
+{
+	return m_packetsOut;
+}
@@ -23,6 +23,7 @@
 
 #include <cstdint>
 #include <string>
+#include <atomic>
 
 class CP25Network {
 public:
@@ -41,12 +42,18 @@ public:
 
 	void close();
 
+	// Data frames through the network, for the metrics
+	const std::atomic<unsigned long long>& getPacketsIn() const;
+	const std::atomic<unsigned long long>& getPacketsOut() const;
+
 private:
 	std::string  m_callsign;
 	in_addr      m_address;
 	unsigned int m_port;
 	CUDPSocket   m_socket;
 	bool         m_debug;
+	std::atomic<unsigned long long> m_packetsIn;
+	std::atomic<unsigned long long> m_packetsOut;
 };
 
 #endif
@@ -17,90 +17,194 @@
 */
 
 #include "Reflectors.h"
+#include "FileWatcher.h"
+#include "StopWatch.h"
+#include "Timer.h"
 #include "Log.h"
 
-#include <algorithm>
-#include <functional>
 #include <cstdio>
+#include <cstdlib>
 #include <cassert>
 #include <cstring>
-#include <cctype>
 
 CReflectors::CReflectors(const std::string& hostsFile, unsigned int reloadTime) :
+CThread(),
 m_hostsFile(hostsFile),
+m_reloadTime(reloadTime),
 m_reflectors(),
-m_timer(1000U, reloadTime * 60U)
+m_maxLookup(0U),
+m_started(false),
+m_stop(false)
 {
-    if (reloadTime > 0U)
-        m_timer.start();
 }
 
 CReflectors::~CReflectors()
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
+}
+
+bool CReflectors::read()
+{
+	bool ret = load();
 
-	m_reflectors.clear();
+	if (m_reloadTime > 0U)
+		m_started = run();
+
+	return ret;
 }
 
-bool CReflectors::load()
+void CReflectors::entry()
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
+	LogInfo("Started the XLX reflector reload thread");
+
+	// Changes to the file are seen within a second, the timer remains for when inotify is not available
+	CFileWatcher watcher(m_hostsFile);
+	watcher.open();
 
-	m_reflectors.clear();
+	CTimer timer(1000U, 60U * m_reloadTime);
+	timer.start();
+
+	// A wait can return early or late, so the timer goes by the time that has passed
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	while (!m_stop) {
+		bool changed = false;
+		if (watcher.isOpen()) {
+			changed = watcher.wait(1000U);
+
+			// Let a file that is still being written settle first
+			while (changed && !m_stop && watcher.wait(1000U))
+				;
+		} else {
+			sleep(1000U);
+		}
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		timer.clock(ms);
+		if ((changed || timer.hasExpired()) && !m_stop) {
+			load();
+			timer.start();
+		}
+	}
+
+	LogInfo("Stopped the XLX reflector reload thread");
+}
+
+void CReflectors::stop()
+{
+	if (!m_started)
+		return;
+
+	m_stop = true;
+
+	wait();
+
+	m_started = false;
+}
+
+// A new table is built and published only when it differs from the current one, the
+// table the readers are using is never modified
+bool CReflectors::load()
+{
+	std::shared_ptr<const CReflectorTable> old = std::atomic_load(&m_reflectors);
 
 	FILE* fp = ::fopen(m_hostsFile.c_str(), "rt");
-	if (fp != NULL) {
-		char buffer[100U];
-		while (::fgets(buffer, 100U, fp) != NULL) {
-			if (buffer[0U] == '#')
-				continue;
-
-			char* p1 = ::strtok(buffer, ";\r\n");
-			char* p2 = ::strtok(NULL, ";\r\n");
-			char* p3 = ::strtok(NULL, "\r\n");
-
-			if (p1 != NULL && p2 != NULL && p3 != NULL) {
-				CReflector* refl = new CReflector;
-				refl->m_id       = (unsigned int)::atoi(p1);
-				refl->m_address  = std::string(p2);
-				refl->m_startup  = (unsigned int)::atoi(p3);
-				m_reflectors.push_back(refl);
-			}
+	if (fp == NULL) {
+		LogWarning("Cannot open the XLX reflector file - %s", m_hostsFile.c_str());
+		return old != NULL && !old->empty();
+	}
+
+	unsigned long long start = CStopWatch::getMicroseconds();
+
+	std::shared_ptr<CReflectorTable> reflectors(new CReflectorTable);
+
+	char buffer[100U];
+	while (::fgets(buffer, 100U, fp) != NULL) {
+		if (buffer[0U] == '#')
+			continue;
+
+		char* p1 = ::strtok(buffer, ";\r\n");
+		char* p2 = ::strtok(NULL, ";\r\n");
+		char* p3 = ::strtok(NULL, "\r\n");
+
+		if (p1 != NULL && p2 != NULL && p3 != NULL) {
+			CReflector refl;
+			refl.m_id      = (unsigned int)::atoi(p1);
+			refl.m_address = std::string(p2);
+			refl.m_startup = (unsigned int)::atoi(p3);
+
+			// The first entry for an id is the one that is used
+			reflectors->insert(std::make_pair(refl.m_id, refl));
+		}
+	}
+
+	::fclose(fp);
+
+	unsigned int added   = 0U;
+	unsigned int removed = 0U;
+	unsigned int changed = 0U;
+
+	if (old != NULL) {
+		for (CReflectorTable::const_iterator it = reflectors->begin(); it != reflectors->end(); ++it) {
+			CReflectorTable::const_iterator found = old->find(it->first);
+			if (found == old->end())
+				added++;
+			else if (found->second.m_address != it->second.m_address || found->second.m_startup != it->second.m_startup)
+				changed++;
 		}
 
-		::fclose(fp);
+		removed = (unsigned int)(old->size() + added - reflectors->size());
 	}
 
-	size_t size = m_reflectors.size();
-	LogInfo("Loaded %u XLX reflectors", size);
+	size_t size = reflectors->size();
+
+	if (old == NULL || added > 0U || removed > 0U || changed > 0U) {
+		std::atomic_store(&m_reflectors, std::shared_ptr<const CReflectorTable>(reflectors));
+
+		unsigned int elapsed = (unsigned int)((CStopWatch::getMicroseconds() - start) / 1000ULL);
+
+		if (old == NULL)
+			LogInfo("Loaded %u XLX reflectors in %u ms", size, elapsed);
+		else
+			LogInfo("Updated the XLX reflectors in %u ms, %u reflectors, %u added, %u removed, %u changed, longest lookup %u us", elapsed, size, added, removed, changed, m_maxLookup.exchange(0U));
+	}
 
-	size = m_reflectors.size();
 	if (size == 0U)
 		return false;
 
 	return true;
 }
 
-CReflector* CReflectors::find(unsigned int id)
+bool CReflectors::find(unsigned int id, CReflector& reflector)
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it) {
-		if (id == (*it)->m_id)
-			return *it;
+	unsigned long long start = CStopWatch::getMicroseconds();
+
+	std::shared_ptr<const CReflectorTable> reflectors = std::atomic_load(&m_reflectors);
+
+	bool found = false;
+	if (reflectors != NULL) {
+		CReflectorTable::const_iterator it = reflectors->find(id);
+		if (it != reflectors->end()) {
+			reflector = it->second;
+			found = true;
+		}
 	}
 
-	LogMessage("Trying to find non existent XLX reflector with an id of %u", id);
+	lookupTime(start);
+
+	if (!found)
+		LogMessage("Trying to find non existent XLX reflector with an id of %u", id);
 
-	return NULL;
+	return found;
 }
 
-void CReflectors::clock(unsigned int ms)
+void CReflectors::lookupTime(unsigned long long start)
 {
-    m_timer.clock(ms);
+	unsigned int elapsed = (unsigned int)(CStopWatch::getMicroseconds() - start);
 
-    if (m_timer.isRunning() && m_timer.hasExpired()) {
-        load();
-        m_timer.start();
-    }
+	unsigned int max = m_maxLookup.load(std::memory_order_relaxed);
+	while (elapsed > max && !m_maxLookup.compare_exchange_weak(max, elapsed, std::memory_order_relaxed))
+		;
 }
@@ -66,15 +66,19 @@ m_dmrNetworkPort(0U),
 m_dmrNetworkLocal(0U),
 m_dmrNetworkPassword(),
 m_dmrNetworkOptions(),
+m_dmrAGC(false),
 m_dmrNetworkDebug(false),
 m_dmrNetworkJitterEnabled(true),
 m_dmrNetworkJitter(500U),
+m_dmrNetworkSlot1(false),
+m_dmrNetworkSlot2(true),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_usrpAddress(),
 m_usrpDstPort(0U),
 m_usrpLocalPort(0U),
 m_usrpGainAdjDb(),
+m_usrpAGC(false),
 m_usrpDebug(false),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
@@ -184,12 +188,18 @@ bool CConf::read()
 				m_dmrNetworkOptions = value;
 			else if (::strcmp(key, "GainAdjustdB") == 0)
 				m_dmrGainAdjDb = value;
+			else if (::strcmp(key, "AGC") == 0)
+				m_dmrAGC = ::atoi(value) == 1;
 			else if (::strcmp(key, "Debug") == 0)
 				m_dmrNetworkDebug = ::atoi(value) == 1;
 			else if (::strcmp(key, "JitterEnabled") == 0)
 				m_dmrNetworkJitterEnabled = ::atoi(value) == 1;
 			else if (::strcmp(key, "Jitter") == 0)
 				m_dmrNetworkJitter = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Slot1") == 0)
+				m_dmrNetworkSlot1 = ::atoi(value) == 1;
+			else if (::strcmp(key, "Slot2") == 0)
+				m_dmrNetworkSlot2 = ::atoi(value) == 1;
 		} else if (section == SECTION_USRP_NETWORK) {
 			if (::strcmp(key, "Address") == 0)
 				m_usrpAddress = value;
@@ -199,6 +209,8 @@ bool CConf::read()
 				m_usrpLocalPort = (uint32_t)::atoi(value);
 			else if (::strcmp(key, "GainAdjustdB") == 0)
 				m_usrpGainAdjDb = value;
+			else if (::strcmp(key, "AGC") == 0)
+				m_usrpAGC = ::atoi(value) == 1;
 			else if (::strcmp(key, "Debug") == 0)
 				m_usrpDebug = ::atoi(value) == 1;
 		} else if (section == SECTION_DMRID_LOOKUP) {
@@ -338,6 +350,11 @@ std::string CConf::getDMRGainAdjDb() const
 	return m_dmrGainAdjDb;
 }
 
+bool CConf::getDMRAGC() const
+{
+	return m_dmrAGC;
+}
+
 bool CConf::getDMRNetworkDebug() const
 {
 	return m_dmrNetworkDebug;
@@ -353,6 +370,16 @@ unsigned int CConf::getDMRNetworkJitter() const
 	return m_dmrNetworkJitter;
 }
 
+bool CConf::getDMRNetworkSlot1() const
+{
+	return m_dmrNetworkSlot1;
+}
+
+bool CConf::getDMRNetworkSlot2() const
+{
+	return m_dmrNetworkSlot2;
+}
+
 std::string CConf::getDMRIdLookupFile() const
 {
 	return m_dmrIdLookupFile;
@@ -383,6 +410,11 @@ std::string CConf::getUSRPGainAdjDb() const
 	return m_usrpGainAdjDb;
 }
 
+bool CConf::getUSRPAGC() const
+{
+	return m_usrpAGC;
+}
+
 bool CConf::getUSRPDebug() const
 {
 	return m_usrpDebug;
@@ -36,6 +36,7 @@ public:
   uint16_t     getUSRPDstPort() const;
   uint16_t     getUSRPLocalPort() const;
   std::string  getUSRPGainAdjDb() const;
+  bool         getUSRPAGC() const;
   bool         getUSRPDebug() const;
   
   // The Info section
@@ -64,9 +65,12 @@ public:
   std::string  getDMRNetworkPassword() const;
   std::string  getDMRNetworkOptions() const;
   std::string  getDMRGainAdjDb() const;
+  bool         getDMRAGC() const;
   bool         getDMRNetworkDebug() const;
   bool         getDMRNetworkJitterEnabled() const;
   unsigned int getDMRNetworkJitter() const;
+  bool         getDMRNetworkSlot1() const;
+  bool         getDMRNetworkSlot2() const;
 
   // The DMR Id section
   std::string  getDMRIdLookupFile() const;
@@ -111,9 +115,12 @@ private:
   std::string  m_dmrNetworkPassword;
   std::string  m_dmrNetworkOptions;
   std::string  m_dmrGainAdjDb;
+  bool         m_dmrAGC;
   bool         m_dmrNetworkDebug;
   bool         m_dmrNetworkJitterEnabled;
   unsigned int m_dmrNetworkJitter;
+  bool         m_dmrNetworkSlot1;
+  bool         m_dmrNetworkSlot2;
 
   std::string  m_dmrIdLookupFile;
   unsigned int m_dmrIdLookupTime;
@@ -122,6 +129,7 @@ private:
   uint16_t     m_usrpDstPort;
   uint16_t     m_usrpLocalPort;
   std::string  m_usrpGainAdjDb;
+  bool         m_usrpAGC;
   bool         m_usrpDebug;
   
   unsigned int m_logDisplayLevel;
@@ -44,6 +44,9 @@ public:
 
 	bool read(CDMRData& data);
 
+	// When the frame last returned by read() arrived, zero for one made up by the jitter buffer
+	unsigned long long getReceived() const;
+
 	bool write(const CDMRData& data);
 
 	bool writePosition(unsigned int id, const unsigned char* data);
@@ -58,6 +61,9 @@ public:
 
 	bool isConnected() const;
 
+	// The number of packets in the jitter buffer of a slot
+	unsigned int getJitterDepth(unsigned int slotNo) const;
+
 	void close();
 
 private: 
@@ -107,6 +113,8 @@ private:
 
 	bool           m_beacon;
 
+	unsigned long long m_received;
+
 	bool writeLogin();
 	bool writeAuthorisation();
 	bool writeOptions();
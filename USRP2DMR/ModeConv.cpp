@@ -27,7 +27,6 @@
 #include <cstdio>
 #include <cassert>
 #include <cstring>
-#include <cmath>
 
 const unsigned char BIT_MASK_TABLE[] = { 0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U };
 
@@ -455,15 +454,20 @@ const unsigned int C_TABLE[] = { 46U, 50U, 54U, 58U, 62U, 66U, 70U,  3U,  7U, 11
 
 const unsigned char AMBE_SILENCE[] = {0xB9U, 0xE8U, 0x81U, 0x52U, 0x61U, 0x73U, 0x00U, 0x2AU, 0x6BU};
 
+// USRP frames below an RMS level of 32 (about -60 dBFS) are treated as silence
+const int64_t USRP_SILENCE_ENERGY = 160 * 32 * 32;
+
 CModeConv::CModeConv() :
 m_usrpN(0U),
 m_dmrN(0U),
 m_USRP(5000U, "DMR2USRP"),
 m_DMR(5000U, "USRP2DMR"),
-m_usrpGainMultiplier(1),
-m_usrpAttenuate(false),
-m_dmrGainMultiplier(1),
-m_dmrAttenuate(false)
+m_usrpGain(),
+m_dmrGain(),
+m_dmrFrames(0U),
+m_dmrSilence(0U),
+m_usrpFrames(0U),
+m_usrpSilence(0U)
 {
 	m_mbe = new MBEVocoder();
 }
@@ -474,26 +478,22 @@ CModeConv::~CModeConv()
 
 void CModeConv::setUSRPGainAdjDb(std::string dbstring)
 {
-	float db = std::stof(dbstring);
-	
-	float ratio = powf(10.0, (db/10.0));
-	if(db < 0){
-		ratio = 1/ratio;
-		m_usrpAttenuate = true;
-	}
-	m_usrpGainMultiplier = (uint16_t)roundf(ratio);
+	m_usrpGain.setGain(dbstring);
+}
+
+void CModeConv::setUSRPAGC(bool enabled)
+{
+	m_usrpGain.setAGC(enabled);
 }
 
 void CModeConv::setDMRGainAdjDb(std::string dbstring)
 {
-	float db = std::stof(dbstring);
-	
-	float ratio = powf(10.0, (db/10.0));
-	if(db < 0){
-		ratio = 1/ratio;
-		m_dmrAttenuate = true;
-	}
-	m_dmrGainMultiplier = (uint16_t)roundf(ratio);
+	m_dmrGain.setGain(dbstring);
+}
+
+void CModeConv::setDMRAGC(bool enabled)
+{
+	m_dmrGain.setAGC(enabled);
 }
 
 void CModeConv::putDMRHeader()
@@ -512,32 +512,22 @@ void CModeConv::putDMREOT()
 	m_USRP.addData(&TAG_USRP_EOT, 1U);
 	m_USRP.addData(zero, 160U);
 	m_usrpN += 1U;
+
+	if (m_dmrFrames > 0U)
+		LogMessage("DMR to USRP: %u frames, %u silent (%.1f%%) not transcoded", m_dmrFrames, m_dmrSilence, 100.0F * float(m_dmrSilence) / float(m_dmrFrames));
+
+	m_dmrFrames = 0U;
+	m_dmrSilence = 0U;
 }
 
 void CModeConv::putDMR(unsigned char* data)
 {
 	assert(data != NULL);
-	
-	int16_t audio[160U];
-	int16_t audio_adjusted[160U];
-	uint8_t ambe[9U];
+
 	uint8_t v_ambe[9U];
-	
-	::memset(audio, 0, sizeof(audio));
-	::memset(ambe, 0, sizeof(ambe));
-	::memset(v_ambe, 0, sizeof(v_ambe));
-	
-	decode(data, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	
-	for(int i = 0; i < 160; ++i){
-		audio_adjusted[i] = m_dmrAttenuate ? audio[i] / m_dmrGainMultiplier : audio[i] * m_dmrGainMultiplier;
-	}
-	
-	m_USRP.addData(&TAG_USRP_DATA, 1U);
-	m_USRP.addData(audio_adjusted, 160U);
-	m_usrpN += 1U;
-	
+
+	putDMRFrame(data);
+
 	data += 9U;
 	for (unsigned int i = 0U; i < 4U; i++)
 		v_ambe[i] = data[i];
@@ -548,24 +538,38 @@ void CModeConv::putDMR(unsigned char* data)
 	for (unsigned int i = 0U; i < 4U; i++)
 		v_ambe[i + 5U] = data[i + 11U];
 
-	decode(v_ambe, ambe, 0U);
-	m_mbe->decode_2450(audio, ambe);
-	
-	for(int i = 0; i < 160; ++i){
-		audio_adjusted[i] = m_dmrAttenuate ? audio[i] / m_dmrGainMultiplier : audio[i] * m_dmrGainMultiplier;
+	putDMRFrame(v_ambe);
+
+	data += 15U;
+	putDMRFrame(data);
+}
+
+void CModeConv::putDMRFrame(const unsigned char* data)
+{
+	int16_t audio[160U];
+	int16_t audio_adjusted[160U];
+	uint8_t ambe[9U];
+
+	m_dmrFrames++;
+
+	// Silence maps straight to zero samples, no need to run the vocoder
+	if (::memcmp(data, AMBE_SILENCE, 9U) == 0) {
+		const int16_t zero[160U] = {0};
+
+		m_dmrSilence++;
+		m_USRP.addData(&TAG_USRP_DATA, 1U);
+		m_USRP.addData(zero, 160U);
+		m_usrpN += 1U;
+		return;
 	}
-	
-	m_USRP.addData(&TAG_USRP_DATA, 1U);
-	m_USRP.addData(audio_adjusted, 160U);
-	m_usrpN += 1U;
-	
-	data += 15U;;
+
+	::memset(audio, 0, sizeof(audio));
+	::memset(ambe, 0, sizeof(ambe));
+
 	decode(data, ambe, 0U);
 	m_mbe->decode_2450(audio, ambe);
 	
-	for(int i = 0; i < 160; ++i){
-		audio_adjusted[i] = m_dmrAttenuate ? audio[i] / m_dmrGainMultiplier : audio[i] * m_dmrGainMultiplier;
-	}
+	m_dmrGain.process(audio, audio_adjusted, 160U);
 	
 	m_USRP.addData(&TAG_USRP_DATA, 1U);
 	m_USRP.addData(audio_adjusted, 160U);
@@ -599,6 +603,12 @@ void CModeConv::putUSRPEOT()
 	m_DMR.addData(&TAG_EOT, 1U);
 	m_DMR.addData(vch, 9U);
 	m_dmrN += 1U;
+
+	if (m_usrpFrames > 0U)
+		LogMessage("USRP to DMR: %u frames, %u silent (%.1f%%) not transcoded", m_usrpFrames, m_usrpSilence, 100.0F * float(m_usrpSilence) / float(m_usrpFrames));
+
+	m_usrpFrames = 0U;
+	m_usrpSilence = 0U;
 }
 
 void CModeConv::putUSRP(int16_t* data)
@@ -609,11 +619,19 @@ void CModeConv::putUSRP(int16_t* data)
 	uint8_t ambe[72U];
 	uint8_t vch[10U];
 	::memset(ambe, 0, sizeof(ambe));
-	
-	for(int i = 0; i < 160; ++i){
-		m_usrpAttenuate ? audio_adjusted[i] = data[i] / m_usrpGainMultiplier : data[i] * m_usrpGainMultiplier;
+
+	m_usrpFrames++;
+
+	if (isSilence(data)) {
+		m_usrpSilence++;
+		m_DMR.addData(&TAG_DATA, 1U);
+		m_DMR.addData(AMBE_SILENCE, 9U);
+		m_dmrN += 1U;
+		return;
 	}
 	
+	m_usrpGain.process(data, audio_adjusted, 160U);
+	
 	m_mbe->encode_dmr(audio_adjusted, ambe);
 	encode(ambe, vch, 0U);
 	m_DMR.addData(&TAG_DATA, 1U);
@@ -621,6 +639,19 @@ void CModeConv::putUSRP(int16_t* data)
 	m_dmrN += 1U;
 }
 
+bool CModeConv::isSilence(const int16_t* data) const
+{
+	int64_t energy = 0;
+
+	for (unsigned int i = 0U; i < 160U; i++) {
+		energy += int32_t(data[i]) * int32_t(data[i]);
+		if (energy >= USRP_SILENCE_ENERGY)
+			return false;
+	}
+
+	return true;
+}
+
 unsigned int CModeConv::getDMR(unsigned char* data)
 {
 	unsigned char tmp[9U];
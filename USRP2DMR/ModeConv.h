@@ -20,6 +20,7 @@
 
 #include "Defines.h"
 #include "RingBuffer.h"
+#include "PCMGain.h"
 #include "MBEVocoder.h"
 
 #if !defined(MODECONV_H)
@@ -31,7 +32,9 @@ public:
 	~CModeConv();
 
 	void setDMRGainAdjDb(std::string dbstring);
+	void setDMRAGC(bool enabled);
 	void setUSRPGainAdjDb(std::string dbstring);
+	void setUSRPAGC(bool enabled);
 	void putDMR(uint8_t* data);
 	void putDMRHeader();
 	void putDMREOT();
@@ -49,10 +52,14 @@ private:
 	CRingBuffer<int16_t> m_USRP;
 	CRingBuffer<uint8_t> m_DMR;
 	MBEVocoder *m_mbe;
-	uint16_t m_usrpGainMultiplier;
-	bool m_usrpAttenuate;
-	uint16_t m_dmrGainMultiplier;
-	bool m_dmrAttenuate;
+	CPCMGain m_usrpGain;
+	CPCMGain m_dmrGain;
+	uint32_t m_dmrFrames;
+	uint32_t m_dmrSilence;
+	uint32_t m_usrpFrames;
+	uint32_t m_usrpSilence;
+	void putDMRFrame(const uint8_t* data);
+	bool isSilence(const int16_t* data) const;
 	void encode(const uint8_t* in, uint8_t* out, uint32_t offset) const;
 	void decode(const uint8_t* in, uint8_t* out, uint32_t offset) const;
 };
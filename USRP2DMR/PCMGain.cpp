@@ -0,0 +1,147 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "PCMGain.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+const float AGC_TARGET   = 16384.0F;	// peak level, -6 dBFS
+const float AGC_RELEASE  = 1.122F;	// +1 dB per frame
+const int   AGC_MIN_PEAK = 64;		// quieter frames hold the gain
+
+CPCMGain::CPCMGain() :
+m_gain(1.0F),
+m_agc(false),
+m_agcGain(1.0F),
+m_mult(1),
+m_shift(0U)
+{
+}
+
+CPCMGain::~CPCMGain()
+{
+}
+
+void CPCMGain::setGain(const std::string& db)
+{
+	m_gain = ::powf(10.0F, float(::atof(db.c_str())) / 10.0F);
+	m_agcGain = m_gain;
+
+	setMultiplier(m_gain);
+}
+
+void CPCMGain::setAGC(bool enabled)
+{
+	m_agc = enabled;
+	m_agcGain = m_gain;
+
+	setMultiplier(m_gain);
+}
+
+void CPCMGain::setMultiplier(float gain)
+{
+	if (gain > 32767.0F)
+		gain = 32767.0F;
+
+	// Q15 below unity, fewer fraction bits for larger gains
+	unsigned int shift = 15U;
+	while (shift > 0U && gain * float(1U << shift) > 32767.0F)
+		shift--;
+
+	m_mult  = int16_t(::lroundf(gain * float(1U << shift)));
+	m_shift = shift;
+}
+
+void CPCMGain::updateAGC(const int16_t* in, unsigned int n)
+{
+	int peak = 0;
+	for (unsigned int i = 0U; i < n; i++) {
+		int s = ::abs(in[i]);
+		if (s > peak)
+			peak = s;
+	}
+
+	if (peak < AGC_MIN_PEAK)
+		return;
+
+	float want = AGC_TARGET / float(peak);
+	if (want > m_gain)
+		want = m_gain;
+
+	// Attack at once, release slowly
+	if (want < m_agcGain) {
+		m_agcGain = want;
+	} else {
+		m_agcGain *= AGC_RELEASE;
+		if (m_agcGain > want)
+			m_agcGain = want;
+	}
+
+	setMultiplier(m_agcGain);
+}
+
+void CPCMGain::process(const int16_t* in, int16_t* out, unsigned int n)
+{
+	assert(in != NULL);
+	assert(out != NULL);
+
+	if (m_agc)
+		updateAGC(in, n);
+
+	const int32_t round = m_shift > 0U ? 1 << (m_shift - 1U) : 0;
+
+	unsigned int i = 0U;
+
+#if defined(__SSE2__)
+	const __m128i mult  = _mm_set1_epi16(m_mult);
+	const __m128i rnd   = _mm_set1_epi32(round);
+	const __m128i shift = _mm_cvtsi32_si128(int(m_shift));
+
+	for (; (i + 8U) <= n; i += 8U) {
+		__m128i x  = _mm_loadu_si128((const __m128i*)(in + i));
+		__m128i lo = _mm_mullo_epi16(x, mult);
+		__m128i hi = _mm_mulhi_epi16(x, mult);
+		__m128i p0 = _mm_sra_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), rnd), shift);
+		__m128i p1 = _mm_sra_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), rnd), shift);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(p0, p1));
+	}
+#elif defined(__ARM_NEON)
+	const int16x4_t mult  = vdup_n_s16(m_mult);
+	const int32x4_t shift = vdupq_n_s32(-int32_t(m_shift));
+
+	for (; (i + 8U) <= n; i += 8U) {
+		int16x8_t x  = vld1q_s16(in + i);
+		int32x4_t p0 = vrshlq_s32(vmull_s16(vget_low_s16(x), mult), shift);
+		int32x4_t p1 = vrshlq_s32(vmull_s16(vget_high_s16(x), mult), shift);
+		vst1q_s16(out + i, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+	}
+#endif
+
+	for (; i < n; i++) {
+		int32_t p = (int32_t(in[i]) * m_mult + round) >> m_shift;
+		out[i] = p > 32767 ? 32767 : (p < -32768 ? -32768 : int16_t(p));
+	}
+}
@@ -60,6 +60,19 @@ unsigned int CStopWatch::elapsed()
 	return (unsigned int)(temp.QuadPart / m_frequencyS.QuadPart);
 }
 
+unsigned long long CStopWatch::getMicroseconds()
+{
+	LARGE_INTEGER frequency, now;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&now);
+
+	// Whole seconds and the remainder apart, so that neither truncates nor overflows
+	unsigned long long seconds   = now.QuadPart / frequency.QuadPart;
+	unsigned long long remainder = now.QuadPart % frequency.QuadPart;
+
+	return seconds * 1000000ULL + remainder * 1000000ULL / frequency.QuadPart;
+}
+
 #else
 
 #include <cstdio>
@@ -102,4 +115,12 @@ unsigned int CStopWatch::elapsed()
 	return nowMS - m_startMS;
 }
 
+unsigned long long CStopWatch::getMicroseconds()
+{
+	struct timespec now;
+	::clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000ULL + now.tv_nsec / 1000ULL;
+}
+
 #endif
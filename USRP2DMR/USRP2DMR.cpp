@@ -28,8 +28,8 @@
 #define DMR_FRAME_PER      55U
 #define USRP_FRAME_PER     15U
 
-#define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
+#define DMR_SLOT_WATCHDOG   25U		// Missing frames, 1.5s as for the network watchdog
 
 const char* DEFAULT_INI_FILE = "/etc/USRP2DMR.ini";
 
@@ -106,15 +106,22 @@ m_usrpFrame(NULL),
 m_usrpFrames(0U),
 m_dmrFrame(NULL),
 m_dmrFrames(0U),
-m_EmbeddedLC(),
+m_dmrBuilder(NULL),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
 m_xlxmodule(),
 m_xlxConnected(false),
 m_xlxReflectors(NULL),
 m_xlxrefl(0U),
-m_firstSync(false)
+m_firstSync(false),
+m_slot1(false),
+m_slot2(true),
+m_rxSlot(0U),
+m_txSlot(2U)
 {
+	m_slotDstId[0U]  = m_slotDstId[1U]  = m_slotDstId[2U]  = 0U;
+	m_slotMissing[0U] = m_slotMissing[1U] = m_slotMissing[2U] = 0U;
+
 	m_usrpFrame = new uint8_t[400U];
 	m_dmrFrame  = new uint8_t[50U];
 
@@ -220,7 +227,9 @@ int CUSRP2DMR::run()
 	bool usrp_debug               = m_conf.getUSRPDebug();
 	
 	m_conv.setUSRPGainAdjDb(m_conf.getUSRPGainAdjDb());
+	m_conv.setUSRPAGC(m_conf.getUSRPAGC());
 	m_conv.setDMRGainAdjDb(m_conf.getDMRGainAdjDb());
+	m_conv.setDMRAGC(m_conf.getDMRAGC());
 	
 	m_usrpNetwork = new CUSRPNetwork(usrp_address, usrp_dstPort, usrp_localPort, usrp_debug);
 	
@@ -233,7 +242,7 @@ int CUSRP2DMR::run()
 
 	std::string fileName    = m_conf.getDMRXLXFile();
 	m_xlxReflectors = new CReflectors(fileName, 60U);
-	m_xlxReflectors->load();
+	m_xlxReflectors->read();
 	
 	ret = createDMRNetwork();
 	if (!ret) {
@@ -242,6 +251,8 @@ int CUSRP2DMR::run()
 		return 1;
 	}
 
+	m_dmrBuilder = new CDMRFrameBuilder(m_colorcode);
+
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
 
@@ -324,8 +335,9 @@ int CUSRP2DMR::run()
 				LogMessage("Sending DMR Header");
 				CDMRData rx_dmrdata;
 				dmr_cnt = 0U;
+				m_txSlot = getTxSlot(m_dstid);
 				
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -335,20 +347,9 @@ int CUSRP2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
+				// Header, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getHeader(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -371,10 +372,9 @@ int CUSRP2DMR::run()
 				if (n_dmr) {
 					for (unsigned int i = 0U; i < fill; i++) {
 
-						CDMREMB emb;
 						CDMRData rx_dmrdata;
 
-						rx_dmrdata.setSlotNo(2U);
+						rx_dmrdata.setSlotNo(m_txSlot);
 						rx_dmrdata.setSrcId(m_dmrSrc);
 						rx_dmrdata.setDstId(m_dstid);
 						rx_dmrdata.setFLCO(m_dmrflco);
@@ -386,13 +386,8 @@ int CUSRP2DMR::run()
 
 						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
 
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
+						// Add the EMB and embedded LC
+						m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
 
 						rx_dmrdata.setData(m_dmrFrame);
 
@@ -405,7 +400,7 @@ int CUSRP2DMR::run()
 					}
 				}
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -415,19 +410,9 @@ int CUSRP2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+				// Terminator, from the LC of the call
+				m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
+				m_dmrBuilder->getTerminator(m_dmrFrame);
 
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -437,11 +422,10 @@ int CUSRP2DMR::run()
 			}
 			else if(dmrFrameType == TAG_DATA) {
 				LogMessage("Sending DMR Data");
-				CDMREMB emb;
 				CDMRData rx_dmrdata;
 				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_dmrSrc);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -452,23 +436,16 @@ int CUSRP2DMR::run()
 			
 				if (!n_dmr) {
 					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_dmrSrc, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
+					// Any change of the LC is sent from this superframe
+					m_dmrBuilder->setLC(m_dmrflco, m_dmrSrc, m_dstid);
 				}
 				else {
 					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
 				}
 
+				// Add the sync, or the EMB and embedded LC
+				m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
+
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -480,6 +457,34 @@ int CUSRP2DMR::run()
 		}
 
 		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int slotNo = tx_dmrdata.getSlotNo();
+
+			if (!tx_dmrdata.isMissing() && tx_dmrdata.getFLCO() == FLCO_GROUP)
+				m_slotDstId[slotNo] = tx_dmrdata.getDstId();
+
+			// There is a single conversion to the other mode, the first slot to start a call keeps it,
+			// and a call on the other slot is picked up by its late entry once that call has ended
+			if (m_rxSlot == 0U && !tx_dmrdata.isMissing()) {
+				m_rxSlot = slotNo;
+				m_slotMissing[slotNo] = 0U;
+			}
+
+			if (slotNo != m_rxSlot) {
+				// The buffer of the other slot is still reset when its call ends, or when it stops without a terminator
+				if (tx_dmrdata.isMissing())
+					m_slotMissing[slotNo]++;
+				else
+					m_slotMissing[slotNo] = 0U;
+
+				bool ended = !tx_dmrdata.isMissing() && tx_dmrdata.getDataType() == DT_TERMINATOR_WITH_LC;
+				if (ended || m_slotMissing[slotNo] >= DMR_SLOT_WATCHDOG) {
+					m_dmrNetwork->reset(slotNo);
+					m_slotMissing[slotNo] = 0U;
+				}
+
+				continue;
+			}
+
 			m_dmrSrc = tx_dmrdata.getSrcId();
 			m_dmrDst = tx_dmrdata.getDstId();
 			
@@ -495,7 +500,8 @@ int CUSRP2DMR::run()
 
 				if(DataType == DT_TERMINATOR_WITH_LC) {
 					if (m_dmrFrames == 0U) {
-						m_dmrNetwork->reset(2U);
+						m_dmrNetwork->reset(m_rxSlot);
+						m_rxSlot = 0U;
 						networkWatchdog.stop();
 						m_dmrinfo = false;
 						m_firstSync = false;
@@ -505,7 +511,8 @@ int CUSRP2DMR::run()
 					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
 
 					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -557,7 +564,8 @@ int CUSRP2DMR::run()
 				networkWatchdog.clock(ms);
 				if (networkWatchdog.hasExpired()) {
 					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -638,19 +646,19 @@ int CUSRP2DMR::run()
 			m_xlxConnected = false;
 		}
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
-
 		if (ms < 5U) ::usleep(5U * 1000U);
 	}
 
 	m_usrpNetwork->close();
 	m_dmrNetwork->close();
 	delete m_dmrNetwork;
+	delete m_dmrBuilder;
 	delete m_usrpNetwork;
 
-	if (m_xlxReflectors != NULL)
+	if (m_xlxReflectors != NULL) {
+		m_xlxReflectors->stop();
 		delete m_xlxReflectors;
+	}
 
 	::LogFinalise();
 
@@ -667,9 +675,9 @@ bool CUSRP2DMR::createDMRNetwork()
 	std::string password  = m_conf.getDMRNetworkPassword();
 	bool debug            = m_conf.getDMRNetworkDebug();
 	unsigned int jitter   = m_conf.getDMRNetworkJitter();
-	bool slot1            = false;
-	bool slot2            = true;
-	bool duplex           = false;
+	bool slot1            = m_conf.getDMRNetworkSlot1();
+	bool slot2            = m_conf.getDMRNetworkSlot2() || !slot1;
+	bool duplex           = slot1;		// Slot 1 is only carried by a duplex hotspot
 	HW_TYPE hwType        = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -684,11 +692,11 @@ bool CUSRP2DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (m_srcHS > 99999999U)
@@ -715,6 +723,11 @@ bool CUSRP2DMR::createDMRNetwork()
 	else
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
+	LogMessage("    Slots: %s", slot1 && slot2 ? "1 and 2" : (slot1 ? "1" : "2"));
+
+	m_slot1  = slot1;
+	m_slot2  = slot2;
+	m_txSlot = getTxSlot(m_dstid);
 
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
@@ -760,6 +773,15 @@ bool CUSRP2DMR::createDMRNetwork()
 	return true;
 }
 
+unsigned int CUSRP2DMR::getTxSlot(unsigned int dstId) const
+{
+	// A talkgroup goes out on the slot it was last heard on, anything else on slot 2 when it is carried
+	if (m_slot1 && m_slot2 && m_slotDstId[1U] == dstId && m_slotDstId[2U] != dstId)
+		return 1U;
+
+	return m_slot2 ? 2U : 1U;
+}
+
 void CUSRP2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -768,7 +790,7 @@ void CUSRP2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork
 
 	CDMRData data;
 
-	data.setSlotNo(XLX_SLOT);
+	data.setSlotNo(getTxSlot(dstId));
 	data.setFLCO(FLCO_USER_USER);
 	data.setSrcId(srcId);
 	data.setDstId(dstId);
@@ -26,6 +26,7 @@
 #include "DMRNetwork.h"
 #include "USRPNetwork.h"
 #include "DMREmbeddedData.h"
+#include "DMRFrameBuilder.h"
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
@@ -79,7 +80,7 @@ private:
 	uint32_t         m_usrpFrames;
 	uint8_t*         m_dmrFrame;
 	uint32_t         m_dmrFrames;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRFrameBuilder* m_dmrBuilder;
 	FLCO             m_dmrflco;
 	bool             m_dmrinfo;
 	std::string      m_xlxmodule;
@@ -87,8 +88,15 @@ private:
 	CReflectors*     m_xlxReflectors;
 	uint32_t         m_xlxrefl;
 	bool             m_firstSync;
+	bool             m_slot1;
+	bool             m_slot2;
+	unsigned int     m_rxSlot;				// The slot being converted, zero when idle
+	unsigned int     m_txSlot;
+	unsigned int     m_slotDstId[3U];			// The talkgroup last heard on each slot
+	unsigned int     m_slotMissing[3U];			// Missing frames in a row on a slot that is not converted
 
 	bool createDMRNetwork();
+	unsigned int getTxSlot(unsigned int dstId) const;
 	void writeXLXLink(uint32_t srcId, uint32_t dstId, CDMRNetwork* network);
 };
 
@@ -18,8 +18,14 @@
 #include <stdlib.h>
 #include <math.h>
 #include "ambe.h"
+#if defined(NATIVE_AMBE)
+// without the external mbelib the quantiser tables are defined here
+#include "ambe3600x2250_const.h"
+#include "ambe3600x2400_const.h"
+#else
 //#include "ambe3600x2250_const.h"
 //#include "ambe3600x2400_const.h"
+#endif
 
 extern const float AmbePlusLtable[];
 extern const int AmbePlusVuv[16][8];
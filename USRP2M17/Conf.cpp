@@ -43,12 +43,14 @@ m_usrpAddress(),
 m_usrpDstPort(0U),
 m_usrpLocalPort(0U),
 m_usrpGainAdjDb(),
+m_usrpAGC(false),
 m_usrpDebug(false),
 m_m17Name(),
 m_m17Address(),
 m_m17DstPort(0U),
 m_m17LocalPort(0U),
 m_m17GainAdjDb(),
+m_m17AGC(false),
 m_m17Debug(false),
 m_logDisplayLevel(0U),
 m_logFileLevel(0U),
@@ -117,6 +119,8 @@ bool CConf::read()
 			m_m17DstPort = (uint32_t)::atoi(value);
 		else if (::strcmp(key, "GainAdjustdB") == 0)
 			m_m17GainAdjDb = value;
+		else if (::strcmp(key, "AGC") == 0)
+			m_m17AGC = ::atoi(value) == 1;
 		else if (::strcmp(key, "Debug") == 0)
 			m_m17Debug = ::atoi(value) == 1;
 	} else if (section == SECTION_USRP_NETWORK) {
@@ -128,6 +132,8 @@ bool CConf::read()
 			m_usrpLocalPort = (uint32_t)::atoi(value);
 		else if (::strcmp(key, "GainAdjustdB") == 0)
 			m_usrpGainAdjDb = value;
+		else if (::strcmp(key, "AGC") == 0)
+			m_usrpAGC = ::atoi(value) == 1;
 		else if (::strcmp(key, "Debug") == 0)
 			m_usrpDebug = ::atoi(value) == 1;
 	} else if (section == SECTION_LOG) {
@@ -177,6 +183,11 @@ std::string CConf::getM17GainAdjDb() const
 	return m_m17GainAdjDb;
 }
 
+bool CConf::getM17AGC() const
+{
+	return m_m17AGC;
+}
+
 bool CConf::getM17Debug() const
 {
 	return m_m17Debug;
@@ -207,6 +218,11 @@ std::string CConf::getUSRPGainAdjDb() const
 	return m_usrpGainAdjDb;
 }
 
+bool CConf::getUSRPAGC() const
+{
+	return m_usrpAGC;
+}
+
 bool CConf::getUSRPDebug() const
 {
 	return m_usrpDebug;
@@ -40,6 +40,7 @@ public:
   uint16_t     getM17DstPort() const;
   uint16_t     getM17LocalPort() const;
   std::string  getM17GainAdjDb() const;
+  bool         getM17AGC() const;
   bool         getM17Debug() const;
   
   // The USRP Network section
@@ -47,6 +48,7 @@ public:
   uint16_t     getUSRPDstPort() const;
   uint16_t     getUSRPLocalPort() const;
   std::string  getUSRPGainAdjDb() const;
+  bool         getUSRPAGC() const;
   bool         getUSRPDebug() const;
 
   // The Log section
@@ -64,6 +66,7 @@ private:
   uint16_t     m_usrpDstPort;
   uint16_t     m_usrpLocalPort;
   std::string  m_usrpGainAdjDb;
+  bool         m_usrpAGC;
   bool         m_usrpDebug;
   
   std::string  m_m17Name;
@@ -71,6 +74,7 @@ private:
   uint16_t     m_m17DstPort;
   uint16_t     m_m17LocalPort;
   std::string  m_m17GainAdjDb;
+  bool         m_m17AGC;
   bool         m_m17Debug;
 
   uint32_t     m_logDisplayLevel;
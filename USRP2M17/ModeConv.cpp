@@ -31,10 +31,8 @@ m_m17N(0U),
 m_usrpN(0U),
 m_M17(5000U, "USRP2M17"),
 m_USRP(5000U, "M172USRP"),
-m_m17GainMultiplier(1),
-m_m17Attenuate(false),
-m_usrpGainMultiplier(3),
-m_usrpAttenuate(true)
+m_m17Gain(),
+m_usrpGain()
 {
 	m_c2 = new CCodec2(true);
 }
@@ -45,26 +43,22 @@ CModeConv::~CModeConv()
 
 void CModeConv::setUSRPGainAdjDb(std::string dbstring)
 {
-	float db = std::stof(dbstring);
-	
-	float ratio = powf(10.0, (db/10.0));
-	if(db < 0){
-		ratio = 1/ratio;
-		m_usrpAttenuate = true;
-	}
-	m_usrpGainMultiplier = (uint16_t)roundf(ratio);
+	m_usrpGain.setGain(dbstring);
+}
+
+void CModeConv::setUSRPAGC(bool enabled)
+{
+	m_usrpGain.setAGC(enabled);
 }
 
 void CModeConv::setM17GainAdjDb(std::string dbstring)
 {
-	float db = std::stof(dbstring);
-	
-	float ratio = powf(10.0, (db/10.0));
-	if(db < 0){
-		ratio = 1/ratio;
-		m_m17Attenuate = true;
-	}
-	m_m17GainMultiplier = (uint16_t)roundf(ratio);
+	m_m17Gain.setGain(dbstring);
+}
+
+void CModeConv::setM17AGC(bool enabled)
+{
+	m_m17Gain.setAGC(enabled);
 }
 
 void CModeConv::putUSRPHeader()
@@ -99,9 +93,7 @@ void CModeConv::putUSRP(int16_t* data)
 	
 	int16_t audio_adjusted[160U];
 	
-	for(int i = 0; i < 160; ++i){
-		audio_adjusted[i] = m_usrpAttenuate ? data[i] / m_usrpGainMultiplier : data[i] * m_usrpGainMultiplier;
-	}
+	m_usrpGain.process(data, audio_adjusted, 160U);
 	
 	m_c2->codec2_encode(codec2, audio_adjusted);
 	m_M17.addData(&TAG_DATA, 1U);
@@ -148,9 +140,7 @@ void CModeConv::putM17(uint8_t* data)
 	
 	m_c2->codec2_decode(audio, codec2);
 	
-	for(size_t i = 0; i < s; ++i){
-		audio_adjusted[i] = m_m17Attenuate ? audio[i] / m_m17GainMultiplier : audio[i] * m_m17GainMultiplier;
-	}
+	m_m17Gain.process(audio, audio_adjusted, s);
 	
 	m_USRP.addData(&TAG_USRP_DATA, 1U);
 	m_USRP.addData(audio_adjusted, 160);
@@ -161,9 +151,7 @@ void CModeConv::putM17(uint8_t* data)
 	if(s == 160){
 		::memcpy(codec2, &data[44], 8);
 		m_c2->codec2_decode(audio, codec2);
-		for(int i = 0; i < 160; ++i){
-			audio_adjusted[i] = m_m17Attenuate ? audio[i] / m_m17GainMultiplier : audio[i] * m_m17GainMultiplier;
-		}
+		m_m17Gain.process(audio, audio_adjusted, 160U);
 	}
 	else{
 		p = &audio_adjusted[160U];
@@ -19,6 +19,7 @@
  */
 
 #include "RingBuffer.h"
+#include "PCMGain.h"
 #include "codec2/codec2.h"
 
 const uint8_t TAG_HEADER = 0x00U;
@@ -50,7 +51,9 @@ public:
 	~CModeConv();
 
 	void setUSRPGainAdjDb(std::string dbstring);
+	void setUSRPAGC(bool enabled);
 	void setM17GainAdjDb(std::string dbstring);
+	void setM17AGC(bool enabled);
 	void putUSRP(int16_t* data);
 	void putUSRPHeader();
 	void putUSRPEOT();
@@ -65,10 +68,8 @@ private:
 	CRingBuffer<uint8_t> m_M17;
 	CRingBuffer<int16_t> m_USRP;
 	CCodec2 *m_c2;
-	uint16_t m_m17GainMultiplier;
-	bool m_m17Attenuate;
-	uint16_t m_usrpGainMultiplier;
-	bool m_usrpAttenuate;
+	CPCMGain m_m17Gain;
+	CPCMGain m_usrpGain;
 };
 
 #endif
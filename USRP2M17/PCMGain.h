@@ -0,0 +1,53 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(PCMGAIN_H)
+#define PCMGAIN_H
+
+#include <cstdint>
+#include <string>
+
+// Fixed point gain with saturation for PCM frames, with an optional AGC
+// that also limits the peaks.
+class CPCMGain {
+public:
+	CPCMGain();
+	~CPCMGain();
+
+	// The gain in dB is taken as a power ratio, as the old integer
+	// multipliers did, so existing GainAdjustdB settings keep their level.
+	void setGain(const std::string& db);
+
+	// With AGC the configured gain is the maximum gain
+	void setAGC(bool enabled);
+
+	// in and out may be the same buffer
+	void process(const int16_t* in, int16_t* out, unsigned int n);
+
+private:
+	float        m_gain;
+	bool         m_agc;
+	float        m_agcGain;
+	int16_t      m_mult;		// the gain is m_mult / 2^m_shift
+	unsigned int m_shift;
+
+	void setMultiplier(float gain);
+	void updateAGC(const int16_t* in, unsigned int n);
+};
+
+#endif
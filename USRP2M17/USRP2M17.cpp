@@ -247,6 +247,7 @@ int CUSRP2M17::run()
 	bool m17_debug               = m_conf.getM17Debug();
 	
 	m_conv.setM17GainAdjDb(m_conf.getM17GainAdjDb());
+	m_conv.setM17AGC(m_conf.getM17AGC());
 	
 	uint16_t streamid = 0;
 	uint8_t m17_src[10];
@@ -271,6 +272,7 @@ int CUSRP2M17::run()
 	bool usrp_debug               = m_conf.getUSRPDebug();
 	
 	m_conv.setUSRPGainAdjDb(m_conf.getUSRPGainAdjDb());
+	m_conv.setUSRPAGC(m_conf.getUSRPAGC());
 	
 	m_usrpNetwork = new CUSRPNetwork(usrp_address, usrp_dstPort, usrp_localPort, usrp_debug);
 	
@@ -16,12 +16,15 @@
  *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
  */
 
+
 #include "Log.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
 #else
 #include <sys/time.h>
+#include <pthread.h>
+#include <unistd.h>
 #endif
 
 #include <cstdio>
@@ -30,6 +33,22 @@
 #include <ctime>
 #include <cassert>
 #include <cstring>
+#include <atomic>
+
+// A line is formatted by the caller into a slot of a ring shared by all threads, and
+// written out by a thread of its own, so that a caller never waits for the file or
+// the display. When the ring is full the line is dropped and counted. The writer sleeps
+// until a caller wakes it, which only costs the caller anything while it is asleep.
+const unsigned int LOG_SLOTS       = 2048U;		// A power of two
+const unsigned int LOG_TEXT_LENGTH = 300U;
+
+struct CLogSlot {
+	std::atomic<unsigned int> m_sequence;
+	unsigned int              m_level;
+	time_t                    m_seconds;
+	unsigned int              m_milliseconds;
+	char                      m_text[LOG_TEXT_LENGTH];
+};
 
 static unsigned int m_fileLevel = 2U;
 static std::string m_filePath;
@@ -43,15 +62,57 @@ static struct tm m_tm;
 
 static char LEVELS[] = " DMIWEF";
 
-static bool LogOpen()
+static CLogSlot*                 m_slots = NULL;
+static std::atomic<unsigned int> m_enqueue(0U);
+static unsigned int              m_dequeue = 0U;
+static std::atomic<unsigned int> m_dropped(0U);
+static std::atomic<unsigned int> m_maxCall(0U);
+static std::atomic<bool>         m_running(false);
+static std::atomic<bool>         m_stop(false);
+static std::atomic<bool>         m_waiting(false);
+
+#if defined(_WIN32) || defined(_WIN64)
+static HANDLE          m_thread;
+static HANDLE          m_wakeup = NULL;
+#else
+static pthread_t       m_thread;
+static pthread_mutex_t m_wakeupMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  m_wakeup      = PTHREAD_COND_INITIALIZER;
+#endif
+
+// The date and time of the last second written, only used by the writer
+static time_t m_second = -1;
+static char   m_stamp[40U];
+
+static unsigned long long getTime(time_t& seconds, unsigned int& milliseconds)
 {
-	if (m_fileLevel == 0U)
-		return true;
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
 
-	time_t now;
-	::time(&now);
+	ULARGE_INTEGER now;
+	now.LowPart  = ft.dwLowDateTime;
+	now.HighPart = ft.dwHighDateTime;
 
-	struct tm* tm = ::gmtime(&now);
+	// From 100ns units since 1601 to microseconds since 1970
+	unsigned long long us = (now.QuadPart - 116444736000000000ULL) / 10ULL;
+#else
+	struct timeval now;
+	::gettimeofday(&now, NULL);
+
+	unsigned long long us = (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_usec;
+#endif
+
+	seconds      = time_t(us / 1000000ULL);
+	milliseconds = (unsigned int)((us % 1000000ULL) / 1000ULL);
+
+	return us;
+}
+
+static bool LogOpen(const struct tm* tm)
+{
+	if (m_fileLevel == 0U)
+		return true;
 
 	if (tm->tm_mday == m_tm.tm_mday && tm->tm_mon == m_tm.tm_mon && tm->tm_year == m_tm.tm_year) {
 		if (m_fpLog != NULL)
@@ -74,63 +135,322 @@ static bool LogOpen()
     return m_fpLog != NULL;
 }
 
+static bool LogOpen()
+{
+	time_t now;
+	::time(&now);
+
+	return ::LogOpen(::gmtime(&now));
+}
+
+// The date and time are formatted once a second, and the file is changed with the date
+static void LogWrite(unsigned int level, time_t seconds, unsigned int milliseconds, const char* text)
+{
+	if (seconds != m_second) {
+		struct tm* tm = ::gmtime(&seconds);
+
+		::sprintf(m_stamp, "%04d-%02d-%02d %02d:%02d:%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec);
+		m_second = seconds;
+
+		if (m_fileLevel != 0U)
+			::LogOpen(tm);
+	}
+
+	if (level >= m_fileLevel && m_fileLevel != 0U && m_fpLog != NULL)
+		::fprintf(m_fpLog, "%c: %s.%03u %s\n", LEVELS[level], m_stamp, milliseconds, text);
+
+	if (level >= m_displayLevel && m_displayLevel != 0U)
+		::fprintf(stdout, "%c: %s.%03u %s\n", LEVELS[level], m_stamp, milliseconds, text);
+}
+
+static void LogFlush()
+{
+	if (m_fpLog != NULL)
+		::fflush(m_fpLog);
+
+	::fflush(stdout);
+}
+
+// Writes the lines in the ring, returns how many there were
+static unsigned int LogDrain()
+{
+	unsigned int count = 0U;
+
+	for (;;) {
+		CLogSlot& slot = m_slots[m_dequeue & (LOG_SLOTS - 1U)];
+		if (slot.m_sequence.load(std::memory_order_acquire) != m_dequeue + 1U)
+			break;
+
+		::LogWrite(slot.m_level, slot.m_seconds, slot.m_milliseconds, slot.m_text);
+
+		slot.m_sequence.store(m_dequeue + LOG_SLOTS, std::memory_order_release);
+		m_dequeue++;
+		count++;
+	}
+
+	unsigned int dropped = m_dropped.exchange(0U);
+	if (dropped > 0U) {
+		char text[50U];
+		::sprintf(text, "%u log lines were dropped", dropped);
+
+		time_t seconds;
+		unsigned int milliseconds;
+		getTime(seconds, milliseconds);
+
+		::LogWrite(4U, seconds, milliseconds, text);
+		count++;
+	}
+
+	return count;
+}
+
+static bool LogPending()
+{
+	const CLogSlot& slot = m_slots[m_dequeue & (LOG_SLOTS - 1U)];
+
+	return slot.m_sequence.load(std::memory_order_acquire) == m_dequeue + 1U || m_dropped.load() > 0U;
+}
+
+// The writer says that it is going to sleep before it looks at the ring for the last time, and a
+// caller looks for a sleeping writer after it has added its line, so a line is never left waiting.
+// The writer still looks once a second, as a line dropped from a full ring wakes nobody.
+static void LogWait()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	m_waiting.store(true);
+
+	if (!::LogPending() && !m_stop.load())
+		::WaitForSingleObject(m_wakeup, 1000UL);
+
+	m_waiting.store(false);
+#else
+	::pthread_mutex_lock(&m_wakeupMutex);
+
+	m_waiting.store(true);
+
+	if (!::LogPending() && !m_stop.load()) {
+		struct timeval now;
+		::gettimeofday(&now, NULL);
+
+		struct timespec until;
+		until.tv_sec  = now.tv_sec + 1;
+		until.tv_nsec = now.tv_usec * 1000L;
+
+		::pthread_cond_timedwait(&m_wakeup, &m_wakeupMutex, &until);
+	}
+
+	m_waiting.store(false);
+
+	::pthread_mutex_unlock(&m_wakeupMutex);
+#endif
+}
+
+static void LogWake()
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (!m_waiting.load())
+		return;
+
+#if defined(_WIN32) || defined(_WIN64)
+	::SetEvent(m_wakeup);
+#else
+	::pthread_mutex_lock(&m_wakeupMutex);
+	::pthread_cond_signal(&m_wakeup);
+	::pthread_mutex_unlock(&m_wakeupMutex);
+#endif
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+static DWORD __stdcall LogEntry(LPVOID)
+#else
+static void* LogEntry(void*)
+#endif
+{
+	for (;;) {
+		// Whatever was logged before LogFinalise() is still written
+		bool stop = m_stop.load();
+
+		if (::LogDrain() > 0U)
+			::LogFlush();
+
+		if (stop)
+			break;
+
+		::LogWait();
+	}
+
+#if defined(_WIN32) || defined(_WIN64)
+	return 0UL;
+#else
+	return NULL;
+#endif
+}
+
 bool LogInitialise(const std::string& filePath, const std::string& fileRoot, unsigned int fileLevel, unsigned int displayLevel)
 {
 	m_filePath     = filePath;
 	m_fileRoot     = fileRoot;
 	m_fileLevel    = fileLevel;
 	m_displayLevel = displayLevel;
-    return ::LogOpen();
+
+	bool ret = ::LogOpen();
+	if (!ret || m_running)
+		return ret;
+
+	if (m_slots == NULL) {
+		m_slots = new CLogSlot[LOG_SLOTS];
+		for (unsigned int i = 0U; i < LOG_SLOTS; i++)
+			m_slots[i].m_sequence.store(i);
+	}
+
+	m_stop = false;
+
+	// Without the writer thread the lines are written by the caller
+#if defined(_WIN32) || defined(_WIN64)
+	if (m_wakeup == NULL)
+		m_wakeup = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (m_wakeup == NULL)
+		return true;
+
+	m_thread = ::CreateThread(NULL, 0, &LogEntry, NULL, 0, NULL);
+	m_running = m_thread != NULL;
+#else
+	m_running = ::pthread_create(&m_thread, NULL, &LogEntry, NULL) == 0;
+#endif
+
+	return true;
 }
 
 void LogFinalise()
 {
-    if (m_fpLog != NULL)
-        ::fclose(m_fpLog);
+	if (m_running) {
+		m_stop = true;
+		::LogWake();
+
+#if defined(_WIN32) || defined(_WIN64)
+		::WaitForSingleObject(m_thread, INFINITE);
+		::CloseHandle(m_thread);
+#else
+		::pthread_join(m_thread, NULL);
+#endif
+
+		m_running = false;
+
+		// Lines added while the writer was stopping
+		if (::LogDrain() > 0U)
+			::LogFlush();
+
+		Log(1U, "The longest call to the logger took %u us", m_maxCall.load());
+	}
+
+	if (m_fpLog != NULL)
+		::fclose(m_fpLog);
+
+	m_fpLog = NULL;
 }
 
-void Log(unsigned int level, const char* fmt, ...)
+unsigned long long LogGetCPUTime()
 {
-    assert(fmt != NULL);
+	if (!m_running)
+		return 0ULL;
 
-	char buffer[300U];
 #if defined(_WIN32) || defined(_WIN64)
-	SYSTEMTIME st;
-	::GetSystemTime(&st);
+	FILETIME creation, exit, kernel, user;
+	if (!::GetThreadTimes(m_thread, &creation, &exit, &kernel, &user))
+		return 0ULL;
 
-	::sprintf(buffer, "%c: %04u-%02u-%02u %02u:%02u:%02u.%03u ", LEVELS[level], st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+	ULARGE_INTEGER k, u;
+	k.LowPart  = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart  = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+
+	return (k.QuadPart + u.QuadPart) * 100ULL;
 #else
-	struct timeval now;
-	::gettimeofday(&now, NULL);
+	clockid_t id;
+	if (::pthread_getcpuclockid(m_thread, &id) != 0)
+		return 0ULL;
 
-	struct tm* tm = ::gmtime(&now.tv_sec);
+	struct timespec now;
+	if (::clock_gettime(id, &now) != 0)
+		return 0ULL;
 
-	::sprintf(buffer, "%c: %04d-%02d-%02d %02d:%02d:%02d.%03lu ", LEVELS[level], tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, now.tv_usec / 1000U);
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
 #endif
+}
+
+void Log(unsigned int level, const char* fmt, ...)
+{
+    assert(fmt != NULL);
+
+	if ((level < m_fileLevel || m_fileLevel == 0U) && (level < m_displayLevel || m_displayLevel == 0U) && level != 6U)
+		return;
+
+	time_t seconds;
+	unsigned int milliseconds;
+	unsigned long long start = getTime(seconds, milliseconds);
 
 	va_list vl;
 	va_start(vl, fmt);
 
-	::vsprintf(buffer + ::strlen(buffer), fmt, vl);
+	if (!m_running || level == 6U) {
+		if (level == 6U)		// Fatal, the lines before it are written first
+			::LogFinalise();
 
-	va_end(vl);
+		char buffer[LOG_TEXT_LENGTH];
+		::vsnprintf(buffer, LOG_TEXT_LENGTH, fmt, vl);
 
-	if (level >= m_fileLevel && m_fileLevel != 0U) {
-		bool ret = ::LogOpen();
-		if (!ret)
+		va_end(vl);
+
+		if (level >= m_fileLevel && m_fileLevel != 0U && !::LogOpen())
 			return;
 
-		::fprintf(m_fpLog, "%s\n", buffer);
-		::fflush(m_fpLog);
+		::LogWrite(level, seconds, milliseconds, buffer);
+		::LogFlush();
+
+		if (level == 6U) {		// Fatal
+			if (m_fpLog != NULL)
+				::fclose(m_fpLog);
+			exit(1);
+		}
+
+		return;
 	}
 
-	if (level >= m_displayLevel && m_displayLevel != 0U) {
-		::fprintf(stdout, "%s\n", buffer);
-		::fflush(stdout);
+	unsigned int pos = m_enqueue.load(std::memory_order_relaxed);
+
+	CLogSlot* slot;
+	for (;;) {
+		slot = &m_slots[pos & (LOG_SLOTS - 1U)];
+
+		int diff = int(slot->m_sequence.load(std::memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (m_enqueue.compare_exchange_weak(pos, pos + 1U, std::memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			va_end(vl);
+			m_dropped++;
+			return;
+		} else {
+			pos = m_enqueue.load(std::memory_order_relaxed);
+		}
 	}
 
-	if (level == 6U) {		// Fatal
-        ::fclose(m_fpLog);
-        exit(1);
-    }
+	slot->m_level        = level;
+	slot->m_seconds      = seconds;
+	slot->m_milliseconds = milliseconds;
+	::vsnprintf(slot->m_text, LOG_TEXT_LENGTH, fmt, vl);
+
+	va_end(vl);
+
+	slot->m_sequence.store(pos + 1U, std::memory_order_release);
+
+	::LogWake();
+
+	unsigned int elapsed = (unsigned int)(getTime(seconds, milliseconds) - start);
+
+	unsigned int max = m_maxCall.load(std::memory_order_relaxed);
+	while (elapsed > max && !m_maxCall.compare_exchange_weak(max, elapsed, std::memory_order_relaxed))
+		;
 }
@@ -33,4 +33,7 @@ extern void Log(unsigned int level, const char* fmt, ...);
 extern bool LogInitialise(const std::string& filePath, const std::string& fileRoot, unsigned int fileLevel, unsigned int displayLevel);
 extern void LogFinalise();
 
+// The CPU time used by the thread writing the log, in nanoseconds
+extern unsigned long long LogGetCPUTime();
+
 #endif
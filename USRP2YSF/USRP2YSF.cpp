@@ -112,6 +112,7 @@ CUSRP2YSF::CUSRP2YSF(const std::string& configFile) :
 m_callsign(),
 m_usrpcs(),
 m_conf(configFile),
+m_ysfBuilder(NULL),
 m_conv(),
 m_usrpFrame(NULL),
 m_usrpFrames(0U)
@@ -239,6 +240,10 @@ int CUSRP2YSF::run()
 	m_ysfNetwork = new CYSFNetwork(ysf_localAddress, ysf_localPort, m_callsign, debug);
 	m_ysfNetwork->setDestination(ysf_dstAddress, ysf_dstPort);
 
+	m_ysfBuilder = new CYSFFrameBuilder(m_ysfNetwork->getCallsign(), m_conf.getYsfRadioID());
+	m_ysfBuilder->setFICH(m_conf.getFICHCallSign(), m_conf.getFICHCallMode(), m_conf.getFICHFrameTotal(), m_conf.getFICHMessageRoute(), m_conf.getFICHVOIP(), m_conf.getFICHDataType(), m_conf.getFICHSQLType(), m_conf.getFICHSQLCode());
+	m_ysfBuilder->setDT(m_conf.getYsfDT1(), m_conf.getYsfDT2());
+
 	ret = m_ysfNetwork->open();
 	if (!ret) {
 		::LogError("Cannot open the YSF network port");
@@ -405,40 +410,8 @@ int CUSRP2YSF::run()
 			if(ysfFrameType == TAG_HEADER) {
 				ysf_cnt = 0U;
 
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_usrpcs.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = 0U; // Net frame counter
-
-				::memcpy(m_ysfFrame + 35U, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
-				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
-				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH);
- 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_usrpcs.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->setCall(m_usrpcs, m_usrpcs);
+				m_ysfBuilder->getHeader(m_ysfFrame);
 
 				m_ysfNetwork->write(m_ysfFrame);
 
@@ -446,111 +419,14 @@ int CUSRP2YSF::run()
 				//ysfWatch.start();
 			}
 			else if (ysfFrameType == TAG_EOT) {
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_usrpcs.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = ysf_cnt; // Net frame counter
-
-				::memcpy(m_ysfFrame + 35U, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
- 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_usrpcs.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->getTerminator(m_ysfFrame, ysf_cnt);
 
 				m_ysfNetwork->write(m_ysfFrame);
 			}
 			else if (ysfFrameType == TAG_DATA) {
-
-				CYSFFICH fich;
-				CYSFPayload ysfPayload;
-				unsigned char dch[10U];
-
-				unsigned int fn = (ysf_cnt - 1U) % (m_conf.getFICHFrameTotal() + 1);
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_usrpcs.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-
-				::memcpy(m_ysfFrame + 35U, YSF_SYNC_BYTES, YSF_SYNC_LENGTH_BYTES);
-
-				switch (fn) {
-					case 0:
-						memset(dch, '*', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);
-						break;
-					case 1:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_usrpcs.c_str());
-						break;
-					case 2:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_usrpcs.c_str());
-						break;
-					case 5:
-						memset(dch, ' ', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);	// Rem3/4
- 						break;
-					case 6: {
-							unsigned char dt1[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT1().size() && i < 10U; i++)
-								dt1[i] = m_conf.getYsfDT1()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt1);
-						}
-						break;
-					case 7: {
-							unsigned char dt2[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT2().size() && i < 10U; i++)
-								dt2[i] = m_conf.getYsfDT2()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt2);
-						}
-						break;
-					default:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
-				}
-
-				// Set the FICH
-				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
-				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				// Net frame counter
-				m_ysfFrame[34U] = (ysf_cnt & 0x7FU) << 1;
+				// Only encodes again when the callsign has changed
+				m_ysfBuilder->setCall(m_usrpcs, m_usrpcs);
+				m_ysfBuilder->getData(m_ysfFrame, ysf_cnt);
 
 				// Send data
 				m_ysfNetwork->write(m_ysfFrame);
@@ -576,6 +452,7 @@ int CUSRP2YSF::run()
 	m_usrpNetwork->close();
 	m_ysfNetwork->close();
 	delete m_ysfNetwork;
+	delete m_ysfBuilder;
 	delete m_usrpNetwork;
 
 	::LogFinalise();
@@ -25,6 +25,7 @@
 #include "USRPNetwork.h"
 #include "YSFPayload.h"
 #include "YSFNetwork.h"
+#include "YSFFrameBuilder.h"
 #include "YSFFICH.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
@@ -50,6 +51,7 @@ private:
 	std::string      m_usrpcs;
 	CConf            m_conf;
 	CYSFNetwork*     m_ysfNetwork;
+	CYSFFrameBuilder* m_ysfBuilder;
 	CUSRPNetwork*    m_usrpNetwork;
 	CModeConv        m_conv;
 	uint8_t*         m_usrpFrame;
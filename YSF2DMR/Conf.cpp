@@ -35,7 +35,8 @@ enum SECTION {
   SECTION_DMR_NETWORK,
   SECTION_DMRID_LOOKUP,
   SECTION_LOG,
-  SECTION_APRS_FI
+  SECTION_APRS_FI,
+  SECTION_METRICS
 };
 
 CConf::CConf(const std::string& file) :
@@ -85,6 +86,8 @@ m_dmrNetworkOptions(),
 m_dmrNetworkDebug(false),
 m_dmrNetworkJitterEnabled(true),
 m_dmrNetworkJitter(500U),
+m_dmrNetworkSlot1(false),
+m_dmrNetworkSlot2(true),
 m_dmrNetworkEnableUnlink(true),
 m_dmrNetworkIDUnlink(4000U),
 m_dmrNetworkPCUnlink(false),
@@ -100,8 +103,14 @@ m_aprsPort(0U),
 m_aprsPassword(),
 m_aprsCallsign(),
 m_aprsAPIKey(),
+m_aprsAPIServer("api.aprs.fi"),
+m_aprsAPIPort(80U),
 m_aprsRefresh(120),
-m_aprsDescription()
+m_aprsDescription(),
+m_metricsEnabled(false),
+m_metricsAddress("127.0.0.1"),
+m_metricsPort(9100U),
+m_metricsSummaryTime(0U)
 {
 }
 
@@ -137,6 +146,8 @@ bool CConf::read()
 		  section = SECTION_LOG;
 	  else if (::strncmp(buffer, "[aprs.fi]", 5U) == 0)
 		  section = SECTION_APRS_FI;	  
+	  else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+		  section = SECTION_METRICS;
 	  else
         section = SECTION_NONE;
 
@@ -264,6 +275,10 @@ bool CConf::read()
 			m_dmrNetworkJitterEnabled = ::atoi(value) == 1;
 		else if (::strcmp(key, "Jitter") == 0)
 			m_dmrNetworkJitter = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Slot1") == 0)
+			m_dmrNetworkSlot1 = ::atoi(value) == 1;
+		else if (::strcmp(key, "Slot2") == 0)
+			m_dmrNetworkSlot2 = ::atoi(value) == 1;
 		else if (::strcmp(key, "EnableUnlink") == 0)
 			m_dmrNetworkEnableUnlink = ::atoi(value) == 1;
 		else if (::strcmp(key, "TGUnlink") == 0)
@@ -304,10 +319,23 @@ bool CConf::read()
 			m_aprsPassword = value;
 		else if (::strcmp(key, "APIKey") == 0)
 			m_aprsAPIKey = value;
+		else if (::strcmp(key, "APIServer") == 0)
+			m_aprsAPIServer = value;
+		else if (::strcmp(key, "APIPort") == 0)
+			m_aprsAPIPort = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "Refresh") == 0)
 			m_aprsRefresh = (unsigned int)::atoi(value);		
 		else if (::strcmp(key, "Description") == 0)
 			m_aprsDescription = value;	
+	} else if (section == SECTION_METRICS) {
+		if (::strcmp(key, "Enable") == 0)
+			m_metricsEnabled = ::atoi(value) == 1;
+		else if (::strcmp(key, "Address") == 0)
+			m_metricsAddress = value;
+		else if (::strcmp(key, "Port") == 0)
+			m_metricsPort = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "SummaryTime") == 0)
+			m_metricsSummaryTime = (unsigned int)::atoi(value);
 	}
   }
 
@@ -531,6 +559,16 @@ std::string CConf::getAPRSAPIKey() const
 	return m_aprsAPIKey;
 }
 
+std::string CConf::getAPRSAPIServer() const
+{
+	return m_aprsAPIServer;
+}
+
+unsigned int CConf::getAPRSAPIPort() const
+{
+	return m_aprsAPIPort;
+}
+
 unsigned int CConf::getAPRSRefresh() const
 {
 	return m_aprsRefresh;
@@ -581,6 +619,16 @@ unsigned int CConf::getDMRNetworkJitter() const
 	return m_dmrNetworkJitter;
 }
 
+bool CConf::getDMRNetworkSlot1() const
+{
+	return m_dmrNetworkSlot1;
+}
+
+bool CConf::getDMRNetworkSlot2() const
+{
+	return m_dmrNetworkSlot2;
+}
+
 bool CConf::getDMRNetworkEnableUnlink() const
 {
 	return m_dmrNetworkEnableUnlink;
@@ -635,3 +683,23 @@ std::string CConf::getLogFileRoot() const
 {
   return m_logFileRoot;
 }
+
+bool CConf::getMetricsEnabled() const
+{
+  return m_metricsEnabled;
+}
+
+std::string CConf::getMetricsAddress() const
+{
+  return m_metricsAddress;
+}
+
+unsigned int CConf::getMetricsPort() const
+{
+  return m_metricsPort;
+}
+
+unsigned int CConf::getMetricsSummaryTime() const
+{
+  return m_metricsSummaryTime;
+}
@@ -82,6 +82,8 @@ public:
   bool         getDMRNetworkDebug() const;
   bool         getDMRNetworkJitterEnabled() const;
   unsigned int getDMRNetworkJitter() const;
+  bool         getDMRNetworkSlot1() const;
+  bool         getDMRNetworkSlot2() const;
   bool         getDMRNetworkEnableUnlink() const;
   unsigned int getDMRNetworkIDUnlink() const;
   bool         getDMRNetworkPCUnlink() const;
@@ -105,9 +107,17 @@ public:
   std::string  getAPRSPassword() const;
   std::string  getAPRSCallsign() const;
   std::string  getAPRSAPIKey() const;
+  std::string  getAPRSAPIServer() const;
+  unsigned int getAPRSAPIPort() const;
   unsigned int getAPRSRefresh() const;
   std::string  getAPRSDescription() const;
 
+  // The Metrics section
+  bool         getMetricsEnabled() const;
+  std::string  getMetricsAddress() const;
+  unsigned int getMetricsPort() const;
+  unsigned int getMetricsSummaryTime() const;
+
 private:
   std::string  m_file;
   std::string  m_callsign;
@@ -157,6 +167,8 @@ private:
   bool         m_dmrNetworkDebug;
   bool         m_dmrNetworkJitterEnabled;
   unsigned int m_dmrNetworkJitter;
+  bool         m_dmrNetworkSlot1;
+  bool         m_dmrNetworkSlot2;
   bool         m_dmrNetworkEnableUnlink;
   unsigned int m_dmrNetworkIDUnlink;
   bool         m_dmrNetworkPCUnlink;
@@ -177,8 +189,15 @@ private:
   std::string  m_aprsPassword;
   std::string  m_aprsCallsign;
   std::string  m_aprsAPIKey;
+  std::string  m_aprsAPIServer;
+  unsigned int m_aprsAPIPort;
   unsigned int m_aprsRefresh;
   std::string  m_aprsDescription;
+
+  bool         m_metricsEnabled;
+  std::string  m_metricsAddress;
+  unsigned int m_metricsPort;
+  unsigned int m_metricsSummaryTime;
 };
 
 #endif
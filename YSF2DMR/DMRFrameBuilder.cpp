@@ -0,0 +1,128 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DMRFrameBuilder.h"
+#include "DMREmbeddedData.h"
+#include "DMRSlotType.h"
+#include "DMRFullLC.h"
+#include "DMREMB.h"
+#include "Sync.h"
+
+#include <cassert>
+#include <cstring>
+
+// The sync, or the EMB and embedded LC, sit between the two halves of the voice
+const unsigned int DMR_MIDDLE_START  = 13U;
+const unsigned int DMR_MIDDLE_LENGTH = 7U;
+
+CDMRFrameBuilder::CDMRFrameBuilder(unsigned int colorCode) :
+m_colorCode(colorCode),
+m_flco(FLCO_GROUP),
+m_srcId(0U),
+m_dstId(0U),
+m_valid(false)
+{
+	::memset(m_header, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	::memset(m_terminator, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	::memset(m_voice, 0x00U, DMR_VOICE_BURSTS * DMR_MIDDLE_LENGTH);
+
+	// The first burst only carries the sync, whatever the LC
+	unsigned char data[DMR_FRAME_LENGTH_BYTES];
+	::memset(data, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	CSync::addDMRAudioSync(data, false);
+	::memcpy(m_voice[0U], data + DMR_MIDDLE_START, DMR_MIDDLE_LENGTH);
+}
+
+CDMRFrameBuilder::~CDMRFrameBuilder()
+{
+}
+
+void CDMRFrameBuilder::setLC(FLCO flco, unsigned int srcId, unsigned int dstId)
+{
+	if (m_valid && flco == m_flco && srcId == m_srcId && dstId == m_dstId)
+		return;
+
+	m_flco  = flco;
+	m_srcId = srcId;
+	m_dstId = dstId;
+	m_valid = true;
+
+	CDMRLC lc(flco, srcId, dstId);
+
+	encodeLC(m_header, lc, DT_VOICE_LC_HEADER);
+	encodeLC(m_terminator, lc, DT_TERMINATOR_WITH_LC);
+
+	CDMREmbeddedData embeddedLC;
+	embeddedLC.setLC(lc);
+
+	CDMREMB emb;
+	emb.setColorCode(m_colorCode);
+
+	for (unsigned int n = 1U; n < DMR_VOICE_BURSTS; n++) {
+		unsigned char data[DMR_FRAME_LENGTH_BYTES];
+		::memset(data, 0x00U, DMR_FRAME_LENGTH_BYTES);
+
+		unsigned char lcss = embeddedLC.getData(data, n);
+
+		emb.setLCSS(lcss);
+		emb.getData(data);
+
+		::memcpy(m_voice[n], data + DMR_MIDDLE_START, DMR_MIDDLE_LENGTH);
+	}
+}
+
+void CDMRFrameBuilder::getHeader(unsigned char* data) const
+{
+	assert(data != NULL);
+	assert(m_valid);
+
+	::memcpy(data, m_header, DMR_FRAME_LENGTH_BYTES);
+}
+
+void CDMRFrameBuilder::getTerminator(unsigned char* data) const
+{
+	assert(data != NULL);
+	assert(m_valid);
+
+	::memcpy(data, m_terminator, DMR_FRAME_LENGTH_BYTES);
+}
+
+void CDMRFrameBuilder::getVoice(unsigned char* data, unsigned int n) const
+{
+	assert(data != NULL);
+	assert(n < DMR_VOICE_BURSTS);
+
+	const unsigned char* voice = m_voice[n];
+	for (unsigned int i = 0U; i < DMR_MIDDLE_LENGTH; i++)
+		data[i + DMR_MIDDLE_START] = (data[i + DMR_MIDDLE_START] & ~SYNC_MASK[i]) | voice[i];
+}
+
+void CDMRFrameBuilder::encodeLC(unsigned char* data, const CDMRLC& lc, unsigned char dataType) const
+{
+	assert(data != NULL);
+
+	CSync::addDMRDataSync(data, false);
+
+	CDMRSlotType slotType;
+	slotType.setColorCode(m_colorCode);
+	slotType.setDataType(dataType);
+	slotType.getData(data);
+
+	CDMRFullLC fullLC;
+	fullLC.encode(lc, data, dataType);
+}
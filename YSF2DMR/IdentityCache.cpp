@@ -0,0 +1,123 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "IdentityCache.h"
+
+#include <cassert>
+#include <cstring>
+
+CIdentity::CIdentity() :
+m_id(0U),
+m_callsign()
+{
+	::memset(m_encoded, 0x00U, IDENTITY_ENCODED_LENGTH);
+}
+
+CIdentityCache::CIdentityCache(unsigned int size) :
+m_entries(NULL),
+m_size(size),
+m_count(0U),
+m_hits(0U),
+m_misses(0U)
+{
+	assert(size > 0U);
+
+	m_entries = new CIdentityEntry[size];
+
+	for (unsigned int i = 0U; i < size; i++) {
+		m_entries[i].m_valid  = false;
+		m_entries[i].m_stream = 0U;
+		m_entries[i].m_length = 0U;
+		m_entries[i].m_used   = 0U;
+	}
+}
+
+CIdentityCache::~CIdentityCache()
+{
+	delete[] m_entries;
+}
+
+bool CIdentityCache::find(unsigned int stream, const unsigned char* source, unsigned int length, CIdentity& identity)
+{
+	assert(source != NULL);
+
+	if (length > IDENTITY_SOURCE_LENGTH)
+		length = IDENTITY_SOURCE_LENGTH;
+
+	for (unsigned int i = 0U; i < m_size; i++) {
+		CIdentityEntry& entry = m_entries[i];
+
+		if (entry.m_valid && entry.m_stream == stream && entry.m_length == length && ::memcmp(entry.m_source, source, length) == 0) {
+			entry.m_used = ++m_count;
+			identity = entry.m_identity;
+			m_hits++;
+			return true;
+		}
+	}
+
+	m_misses++;
+
+	return false;
+}
+
+void CIdentityCache::add(unsigned int stream, const unsigned char* source, unsigned int length, const CIdentity& identity)
+{
+	assert(source != NULL);
+
+	if (length > IDENTITY_SOURCE_LENGTH)
+		length = IDENTITY_SOURCE_LENGTH;
+
+	// Reuse the entry for this stream, or else a free or the least recently used one
+	CIdentityEntry* entry = NULL;
+	for (unsigned int i = 0U; i < m_size; i++) {
+		CIdentityEntry& e = m_entries[i];
+
+		if (e.m_valid && e.m_stream == stream) {
+			entry = &e;
+			break;
+		}
+
+		if (entry == NULL || !e.m_valid || (entry->m_valid && e.m_used < entry->m_used))
+			entry = &e;
+	}
+
+	entry->m_valid    = true;
+	entry->m_stream   = stream;
+	entry->m_length   = length;
+	entry->m_used     = ++m_count;
+	entry->m_identity = identity;
+	::memcpy(entry->m_source, source, length);
+}
+
+void CIdentityCache::remove(unsigned int stream)
+{
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (m_entries[i].m_stream == stream)
+			m_entries[i].m_valid = false;
+	}
+}
+
+unsigned int CIdentityCache::getHits() const
+{
+	return m_hits;
+}
+
+unsigned int CIdentityCache::getMisses() const
+{
+	return m_misses;
+}
@@ -0,0 +1,457 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Metrics.h"
+#include "UDPSocket.h"
+#include "StopWatch.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <new>
+
+#if defined(_WIN32) || defined(_WIN64)
+typedef int ssize_t;
+#else
+#include <cerrno>
+#endif
+
+// A scraper that goes away mid response must not raise SIGPIPE, that would end the bridge
+#if defined(MSG_NOSIGNAL)
+const int METRICS_SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int METRICS_SEND_FLAGS = 0;
+#endif
+
+CMetric::CMetric(const std::string& name, const std::string& help, const char* type) :
+m_name(name),
+m_help(help),
+m_type(type)
+{
+	assert(type != NULL);
+}
+
+CMetric::~CMetric()
+{
+}
+
+std::string CMetric::getFamily() const
+{
+	return m_name.substr(0U, m_name.find('{'));
+}
+
+void CMetric::writeHeader(std::string& text) const
+{
+	std::string family = getFamily();
+
+	text += "# HELP " + family + " " + m_help + "\n";
+	text += "# TYPE " + family + " " + m_type + "\n";
+}
+
+unsigned int CMetric::shard()
+{
+	static std::atomic<unsigned int> next(0U);
+	static thread_local unsigned int shard = next++ % METRICS_SHARDS;
+
+	return shard;
+}
+
+CMetricShard* CMetric::createShards(unsigned int count, unsigned char*& buffer)
+{
+	buffer = new unsigned char[count * sizeof(CMetricShard) + METRICS_CACHE_LINE];
+
+	uintptr_t start = (reinterpret_cast<uintptr_t>(buffer) + METRICS_CACHE_LINE - 1U) & ~uintptr_t(METRICS_CACHE_LINE - 1U);
+	CMetricShard* shards = reinterpret_cast<CMetricShard*>(start);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		new (shards + i) CMetricShard;
+
+		for (unsigned int j = 0U; j < METRICS_SHARD_SIZE; j++)
+			shards[i].m_values[j].store(0U);
+	}
+
+	return shards;
+}
+
+CMetricCounter::CMetricCounter(const std::string& name, const std::string& help, const std::atomic<unsigned long long>* source) :
+CMetric(name, help, "counter"),
+m_buffer(NULL),
+m_shards(NULL),
+m_source(source)
+{
+	m_shards = createShards(METRICS_SHARDS, m_buffer);
+}
+
+CMetricCounter::~CMetricCounter()
+{
+	delete[] m_buffer;
+}
+
+unsigned long long CMetricCounter::get() const
+{
+	if (m_source != NULL)
+		return m_source->load(std::memory_order_relaxed);
+
+	unsigned long long value = 0U;
+	for (unsigned int i = 0U; i < METRICS_SHARDS; i++)
+		value += m_shards[i].m_values[0U].load(std::memory_order_relaxed);
+
+	return value;
+}
+
+void CMetricCounter::write(std::string& text) const
+{
+	char buffer[30U];
+	::sprintf(buffer, " %llu\n", get());
+
+	text += m_name + buffer;
+}
+
+CMetricGauge::CMetricGauge(const std::string& name, const std::string& help) :
+CMetric(name, help, "gauge"),
+m_value(0)
+{
+}
+
+CMetricGauge::~CMetricGauge()
+{
+}
+
+long long CMetricGauge::get() const
+{
+	return m_value.load(std::memory_order_relaxed);
+}
+
+void CMetricGauge::write(std::string& text) const
+{
+	char buffer[30U];
+	::sprintf(buffer, " %lld\n", get());
+
+	text += m_name + buffer;
+}
+
+CMetricHistogram::CMetricHistogram(const std::string& name, const std::string& help, const unsigned int* bounds, unsigned int count) :
+CMetric(name, help, "histogram"),
+m_bounds(bounds, bounds + count),
+m_stride(0U),
+m_buffer(NULL),
+m_shards(NULL)
+{
+	assert(bounds != NULL);
+
+	// A count for each bucket, then the number of values and their sum
+	m_stride = (count + 2U + METRICS_SHARD_SIZE - 1U) / METRICS_SHARD_SIZE;
+	m_shards = createShards(METRICS_SHARDS * m_stride, m_buffer);
+}
+
+CMetricHistogram::~CMetricHistogram()
+{
+	delete[] m_buffer;
+}
+
+void CMetricHistogram::observe(unsigned int value)
+{
+	CMetricShard* shard = m_shards + CMetric::shard() * m_stride;
+
+	unsigned int n = 0U;
+	while (n < m_bounds.size() && value > m_bounds[n])
+		n++;
+
+	if (n < m_bounds.size())
+		shard[n / METRICS_SHARD_SIZE].m_values[n % METRICS_SHARD_SIZE].fetch_add(1U, std::memory_order_relaxed);
+
+	n = m_bounds.size();
+	shard[n / METRICS_SHARD_SIZE].m_values[n % METRICS_SHARD_SIZE].fetch_add(1U, std::memory_order_relaxed);
+
+	n++;
+	shard[n / METRICS_SHARD_SIZE].m_values[n % METRICS_SHARD_SIZE].fetch_add(value, std::memory_order_relaxed);
+}
+
+unsigned long long CMetricHistogram::get(unsigned int shard, unsigned int n) const
+{
+	return m_shards[shard * m_stride + n / METRICS_SHARD_SIZE].m_values[n % METRICS_SHARD_SIZE].load(std::memory_order_relaxed);
+}
+
+void CMetricHistogram::write(std::string& text) const
+{
+	// The bucket label goes in with any labels of the histogram
+	std::string family = getFamily();
+	std::string labels = m_name.substr(family.size());
+	if (!labels.empty())
+		labels = labels.substr(1U, labels.size() - 2U) + ",";
+
+	char buffer[50U];
+
+	// The buckets are cumulative in the text format
+	unsigned long long total = 0U;
+	for (unsigned int n = 0U; n < m_bounds.size(); n++) {
+		for (unsigned int i = 0U; i < METRICS_SHARDS; i++)
+			total += get(i, n);
+
+		::sprintf(buffer, "le=\"%u\"} %llu\n", m_bounds[n], total);
+		text += family + "_bucket{" + labels + buffer;
+	}
+
+	unsigned long long count = 0U;
+	unsigned long long sum   = 0U;
+	for (unsigned int i = 0U; i < METRICS_SHARDS; i++) {
+		count += get(i, m_bounds.size());
+		sum   += get(i, m_bounds.size() + 1U);
+	}
+
+	::sprintf(buffer, "le=\"+Inf\"} %llu\n", count);
+	text += family + "_bucket{" + labels + buffer;
+
+	labels = m_name.substr(family.size());
+
+	::sprintf(buffer, " %llu\n", sum);
+	text += family + "_sum" + labels + buffer;
+
+	::sprintf(buffer, " %llu\n", count);
+	text += family + "_count" + labels + buffer;
+}
+
+CMetrics::CMetrics(const std::string& prefix) :
+CThread(),
+m_prefix(prefix),
+m_metrics(),
+m_fd(-1),
+m_started(false),
+m_stop(false)
+{
+}
+
+CMetrics::~CMetrics()
+{
+	for (std::vector<CMetric*>::iterator it = m_metrics.begin(); it != m_metrics.end(); ++it)
+		delete *it;
+}
+
+CMetricCounter* CMetrics::addCounter(const std::string& name, const std::string& help)
+{
+	CMetricCounter* counter = new CMetricCounter(m_prefix + name, help);
+	m_metrics.push_back(counter);
+
+	return counter;
+}
+
+CMetricCounter* CMetrics::addCounter(const std::string& name, const std::string& help, const std::atomic<unsigned long long>& source)
+{
+	CMetricCounter* counter = new CMetricCounter(m_prefix + name, help, &source);
+	m_metrics.push_back(counter);
+
+	return counter;
+}
+
+CMetricGauge* CMetrics::addGauge(const std::string& name, const std::string& help)
+{
+	CMetricGauge* gauge = new CMetricGauge(m_prefix + name, help);
+	m_metrics.push_back(gauge);
+
+	return gauge;
+}
+
+CMetricHistogram* CMetrics::addHistogram(const std::string& name, const std::string& help, const unsigned int* bounds, unsigned int count)
+{
+	CMetricHistogram* histogram = new CMetricHistogram(m_prefix + name, help, bounds, count);
+	m_metrics.push_back(histogram);
+
+	return histogram;
+}
+
+bool CMetrics::open(const std::string& address, unsigned int port)
+{
+	assert(port > 0U);
+
+	m_fd = ::socket(PF_INET, SOCK_STREAM, 0);
+	if (m_fd < 0) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot create the metrics socket, err=%d", ::GetLastError());
+#else
+		LogError("Cannot create the metrics socket, err=%d", errno);
+#endif
+		return false;
+	}
+
+	int reuse = 1;
+	::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse, sizeof(reuse));
+
+	struct sockaddr_in addr;
+	::memset(&addr, 0x00, sizeof(struct sockaddr_in));
+	addr.sin_family      = AF_INET;
+	addr.sin_port        = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if (!address.empty()) {
+		addr.sin_addr = CUDPSocket::lookup(address);
+		if (addr.sin_addr.s_addr == INADDR_NONE) {
+			LogError("The metrics address is invalid - %s", address.c_str());
+			stop();
+			return false;
+		}
+	}
+
+	if (::bind(m_fd, (sockaddr*)&addr, sizeof(struct sockaddr_in)) == -1 || ::listen(m_fd, 4) == -1) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot bind the metrics socket, err=%d", ::GetLastError());
+#else
+		LogError("Cannot bind the metrics socket, err=%d", errno);
+#endif
+		stop();
+		return false;
+	}
+
+	LogMessage("Serving the metrics on %s:%u", address.empty() ? "*" : address.c_str(), port);
+
+	m_started = run();
+
+	return m_started;
+}
+
+void CMetrics::entry()
+{
+	while (!m_stop) {
+		fd_set readFds;
+		FD_ZERO(&readFds);
+#if defined(_WIN32) || defined(_WIN64)
+		FD_SET((unsigned int)m_fd, &readFds);
+#else
+		FD_SET(m_fd, &readFds);
+#endif
+
+		struct timeval tv;
+		tv.tv_sec  = 1L;
+		tv.tv_usec = 0L;
+
+		if (::select(m_fd + 1, &readFds, NULL, NULL, &tv) <= 0)
+			continue;
+
+		int fd = ::accept(m_fd, NULL, NULL);
+		if (fd < 0)
+			continue;
+
+#if defined(SO_NOSIGPIPE)
+		int noSigPipe = 1;
+		::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, (char *)&noSigPipe, sizeof(noSigPipe));
+#endif
+
+		serve(fd);
+
+#if defined(_WIN32) || defined(_WIN64)
+		::closesocket(fd);
+#else
+		::close(fd);
+#endif
+	}
+}
+
+// A scraper sends one request per connection, whatever the path the metrics are returned
+void CMetrics::serve(int fd)
+{
+	fd_set readFds;
+	FD_ZERO(&readFds);
+#if defined(_WIN32) || defined(_WIN64)
+	FD_SET((unsigned int)fd, &readFds);
+#else
+	FD_SET(fd, &readFds);
+#endif
+
+	struct timeval tv;
+	tv.tv_sec  = 1L;
+	tv.tv_usec = 0L;
+
+	if (::select(fd + 1, &readFds, NULL, NULL, &tv) <= 0)
+		return;
+
+	char request[1024U];
+	ssize_t len = ::recv(fd, request, sizeof(request) - 1U, 0);
+	if (len <= 0)
+		return;
+
+	request[len] = 0x00;
+
+	std::string response;
+	if (::strncmp(request, "GET ", 4U) == 0) {
+		std::string body = getText();
+
+		char header[150U];
+		::sprintf(header, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %u\r\nConnection: close\r\n\r\n", (unsigned int)body.size());
+
+		response = header + body;
+	} else {
+		response = "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+	}
+
+	const char* p = response.c_str();
+	size_t remaining = response.size();
+	while (remaining > 0U) {
+		ssize_t n = ::send(fd, p, remaining, METRICS_SEND_FLAGS);
+		if (n <= 0)
+			return;
+
+		p += n;
+		remaining -= n;
+	}
+}
+
+std::string CMetrics::getText() const
+{
+	std::string text;
+	text.reserve(4096U);
+
+	std::string family;
+	for (std::vector<CMetric*>::const_iterator it = m_metrics.begin(); it != m_metrics.end(); ++it) {
+		// The labelled metrics of a family follow one another, under a single header
+		if ((*it)->getFamily() != family) {
+			family = (*it)->getFamily();
+			(*it)->writeHeader(text);
+		}
+
+		(*it)->write(text);
+	}
+
+	return text;
+}
+
+void CMetrics::stop()
+{
+	if (m_started) {
+		m_stop = true;
+		wait();
+
+		m_started = false;
+	}
+
+	if (m_fd < 0)
+		return;
+
+#if defined(_WIN32) || defined(_WIN64)
+	::closesocket(m_fd);
+#else
+	::close(m_fd);
+#endif
+
+	m_fd = -1;
+}
+
+unsigned long long CMetrics::getMicroseconds()
+{
+	return CStopWatch::getMicroseconds();
+}
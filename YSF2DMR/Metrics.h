@@ -0,0 +1,162 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef	Metrics_H
+#define	Metrics_H
+
+#include "Thread.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+// Each thread updates a shard of its own, on a cache line of its own, and
+// the shards are only added together when the metrics are read
+const unsigned int METRICS_SHARDS     = 8U;
+const unsigned int METRICS_CACHE_LINE = 64U;
+const unsigned int METRICS_SHARD_SIZE = 8U;		// Values in a cache line
+
+// Bounds for histograms of times in microseconds
+const unsigned int METRICS_MICROSECONDS[]     = { 10U, 50U, 100U, 500U, 1000U, 5000U, 10000U, 50000U };
+const unsigned int METRICS_MICROSECONDS_COUNT = 8U;
+
+// Bounds for histograms of frame latencies in microseconds, up to a few frame times
+const unsigned int METRICS_LATENCY[]     = { 100U, 1000U, 5000U, 10000U, 20000U, 40000U, 60000U, 100000U, 200000U, 500000U, 1000000U };
+const unsigned int METRICS_LATENCY_COUNT = 11U;
+
+// new[] does not keep to the alignment, so the shards come from createShards()
+struct alignas(METRICS_CACHE_LINE) CMetricShard {
+	std::atomic<unsigned long long> m_values[METRICS_SHARD_SIZE];
+};
+
+class CMetric {
+public:
+	// The name may carry labels, as in packets_total{network="YSF",direction="in"}
+	CMetric(const std::string& name, const std::string& help, const char* type);
+	virtual ~CMetric();
+
+	std::string getFamily() const;
+
+	void writeHeader(std::string& text) const;
+
+	virtual void write(std::string& text) const = 0;
+
+protected:
+	std::string m_name;
+	std::string m_help;
+	const char* m_type;
+
+	static unsigned int shard();
+
+	// Zeroed shards, the buffer is the one to delete[]
+	static CMetricShard* createShards(unsigned int count, unsigned char*& buffer);
+};
+
+// A counter either counts itself or reports one kept by another class
+class CMetricCounter : public CMetric {
+public:
+	CMetricCounter(const std::string& name, const std::string& help, const std::atomic<unsigned long long>* source = NULL);
+	virtual ~CMetricCounter();
+
+	void inc(unsigned long long n = 1U)
+	{
+		m_shards[shard()].m_values[0U].fetch_add(n, std::memory_order_relaxed);
+	}
+
+	unsigned long long get() const;
+
+	virtual void write(std::string& text) const;
+
+private:
+	unsigned char*                         m_buffer;
+	CMetricShard*                          m_shards;
+	const std::atomic<unsigned long long>* m_source;
+};
+
+class CMetricGauge : public CMetric {
+public:
+	CMetricGauge(const std::string& name, const std::string& help);
+	virtual ~CMetricGauge();
+
+	void set(long long value)
+	{
+		m_value.store(value, std::memory_order_relaxed);
+	}
+
+	long long get() const;
+
+	virtual void write(std::string& text) const;
+
+private:
+	std::atomic<long long> m_value;
+};
+
+// The bounds are the upper limits of the buckets, in increasing order, a
+// value above the last one only counts towards +Inf
+class CMetricHistogram : public CMetric {
+public:
+	CMetricHistogram(const std::string& name, const std::string& help, const unsigned int* bounds, unsigned int count);
+	virtual ~CMetricHistogram();
+
+	void observe(unsigned int value);
+
+	virtual void write(std::string& text) const;
+
+private:
+	std::vector<unsigned int> m_bounds;
+	unsigned int              m_stride;		// Shards per histogram shard
+	unsigned char*            m_buffer;
+	CMetricShard*             m_shards;
+
+	unsigned long long get(unsigned int shard, unsigned int n) const;
+};
+
+// Owns the metrics of a program and serves them in the Prometheus text format
+// over HTTP. The metrics are always kept, only the listener is optional.
+class CMetrics : public CThread {
+public:
+	CMetrics(const std::string& prefix);
+	virtual ~CMetrics();
+
+	// All of the metrics are added before open()
+	CMetricCounter*   addCounter(const std::string& name, const std::string& help);
+	CMetricCounter*   addCounter(const std::string& name, const std::string& help, const std::atomic<unsigned long long>& source);
+	CMetricGauge*     addGauge(const std::string& name, const std::string& help);
+	CMetricHistogram* addHistogram(const std::string& name, const std::string& help, const unsigned int* bounds, unsigned int count);
+
+	bool open(const std::string& address, unsigned int port);
+
+	virtual void entry();
+
+	std::string getText() const;
+
+	void stop();
+
+	static unsigned long long getMicroseconds();
+
+private:
+	std::string           m_prefix;
+	std::vector<CMetric*> m_metrics;
+	int                   m_fd;
+	bool                  m_started;
+	bool                  m_stop;
+
+	void serve(int fd);
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "Golay24128.h"
 #include "YSFConvolution.h"
 #include "CRC.h"
+#include "StopWatch.h"
 #include "Utils.h"
 
 #include "Log.h"
@@ -469,7 +470,15 @@ CModeConv::CModeConv() :
 m_ysfN(0U),
 m_dmrN(0U),
 m_YSF(5000U, "DMR2YSF"),
-m_DMR(5000U, "YSF2DMR")
+m_DMR(5000U, "YSF2DMR"),
+m_YSFTimes(5000U / 14U + 2U, "DMR2YSF times"),
+m_DMRTimes(5000U / 10U + 2U, "YSF2DMR times"),
+m_ysfInput(),
+m_dmrInput(),
+m_ysfTrace(),
+m_dmrTrace(),
+m_ysfTaken(0ULL),
+m_dmrTaken(0ULL)
 {
 }
 
@@ -477,10 +486,13 @@ CModeConv::~CModeConv()
 {
 }
 
-void CModeConv::putDMR(unsigned char* bytes)
+void CModeConv::putDMR(unsigned char* bytes, unsigned long long received)
 {
 	assert(bytes != NULL);
 
+	m_ysfInput.m_received = received;
+	m_ysfInput.m_read     = CStopWatch::getMicroseconds();
+
 	unsigned int a1 = 0U, a2 = 0U, a3 = 0U;
 	unsigned int MASK = 0x800000U;
 	for (unsigned int i = 0U; i < 24U; i++, MASK >>= 1) {
@@ -535,6 +547,8 @@ void CModeConv::putDMR(unsigned char* bytes)
 	putAMBE2YSF(a1, b1, c1);
 	putAMBE2YSF(a2, b2, c2);
 	putAMBE2YSF(a3, b3, c3);
+
+	m_ysfInput.m_received = 0ULL;
 }
 
 void CModeConv::putAMBE2YSF(unsigned int a, unsigned int b, unsigned int dat_c)
@@ -590,17 +604,17 @@ void CModeConv::putAMBE2YSF(unsigned int a, unsigned int b, unsigned int dat_c)
 		WRITE_BIT(ysfFrame, n, s);
 	}
 
-	m_YSF.addData(&TAG_DATA, 1U);
-	m_YSF.addData(ysfFrame, 13U);
+	addYSF(TAG_DATA, ysfFrame);
 	//CUtils::dump(1U, "VCH V/D type 2:", ysfFrame, 13U);
-	
-	m_ysfN += 1U;
 }
 
-void CModeConv::putYSF(unsigned char* data)
+void CModeConv::putYSF(unsigned char* data, unsigned long long received)
 {
 	assert(data != NULL);
 
+	m_dmrInput.m_received = received;
+	m_dmrInput.m_read     = CStopWatch::getMicroseconds();
+
 	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
 
 	unsigned int offset = 40U; // DCH(0)
@@ -650,6 +664,8 @@ void CModeConv::putYSF(unsigned char* data)
 		
 		putAMBE2DMR(dat_a, dat_b, dat_c);
 	}
+
+	m_dmrInput.m_received = 0ULL;
 }
 
 void CModeConv::putAMBE2DMR(unsigned int dat_a, unsigned int dat_b, unsigned int dat_c)
@@ -679,22 +695,15 @@ void CModeConv::putAMBE2DMR(unsigned int dat_a, unsigned int dat_b, unsigned int
 		WRITE_BIT(v_dmr, cPos, dat_c & MASK);
 	}
 
-	m_DMR.addData(&TAG_DATA, 1U);
-	m_DMR.addData(v_dmr, 9U);
-
+	addDMR(TAG_DATA, v_dmr);
 	//CUtils::dump(1U, "DMR Voice:", v_dmr, 9U);
-	
-	m_dmrN += 1U;
 }
 
 void CModeConv::putDummyYSF()
 {
 	// We have a total of 5 VCH sections
 	for (unsigned int j = 0U; j < 5U; j++) {
-		m_DMR.addData(&TAG_DATA, 1U);
-		m_DMR.addData(DMR_SILENCE, 9U);
-
-		m_dmrN += 1U;
+		addDMR(TAG_DATA, DMR_SILENCE);
 	}
 }
 
@@ -704,9 +713,7 @@ void CModeConv::putDMRHeader()
 
 	::memset(vch, 0, 13U);
 
-	m_YSF.addData(&TAG_HEADER, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	addYSF(TAG_HEADER, vch);
 }
 
 void CModeConv::putDMREOT()
@@ -717,14 +724,10 @@ void CModeConv::putDMREOT()
 	
 	unsigned int fill = 5U - (m_ysfN % 5U);
 	for (unsigned int i = 0U; i < fill; i++) {
-		m_YSF.addData(&TAG_DATA, 1U);
-		m_YSF.addData(YSF_SILENCE, 13U);
-		m_ysfN += 1U;
+		addYSF(TAG_DATA, YSF_SILENCE);
 	}
 
-	m_YSF.addData(&TAG_EOT, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	addYSF(TAG_EOT, vch);
 }
 
 void CModeConv::putYSFHeader()
@@ -733,9 +736,7 @@ void CModeConv::putYSFHeader()
 
 	::memset(v_dmr, 0U, 9U);
 
-	m_DMR.addData(&TAG_HEADER, 1U);
-	m_DMR.addData(v_dmr, 9U);
-	m_dmrN += 1U;
+	addDMR(TAG_HEADER, v_dmr);
 }
 
 void CModeConv::putYSFEOT()
@@ -746,14 +747,10 @@ void CModeConv::putYSFEOT()
 	
 	unsigned int fill = 3U - (m_dmrN % 3U);
 	for (unsigned int i = 0U; i < fill; i++) {
-		m_DMR.addData(&TAG_DATA, 1U);
-		m_DMR.addData(DMR_SILENCE, 9U);
-		m_dmrN += 1U;
+		addDMR(TAG_DATA, DMR_SILENCE);
 	}
 
-	m_DMR.addData(&TAG_EOT, 1U);
-	m_DMR.addData(v_dmr, 9U);
-	m_dmrN += 1U;
+	addDMR(TAG_EOT, v_dmr);
 }
 
 unsigned int CModeConv::getDMR(unsigned char* data)
@@ -770,6 +767,10 @@ unsigned int CModeConv::getDMR(unsigned char* data)
 			m_DMR.getData(tag, 1U);
 			m_DMR.getData(data, 9U);
 			m_dmrN -= 1U;
+
+			m_DMRTimes.getData(&m_dmrTrace, 1U);
+			takeTrace(m_dmrTrace, m_dmrTrace.m_queued, m_dmrTaken);
+
 			return tag[0U];
 		}
 	}
@@ -792,6 +793,11 @@ unsigned int CModeConv::getDMR(unsigned char* data)
 		m_DMR.getData(data + 24U, 9U);
 		m_dmrN -= 1U;
 
+		CLatencyTrace traces[3U];
+		m_DMRTimes.getData(traces, 3U);
+		m_dmrTrace = traces[0U];
+		takeTrace(m_dmrTrace, traces[2U].m_queued, m_dmrTaken);
+
 		return TAG_DATA;
 	}
 	else
@@ -813,6 +819,10 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 			m_YSF.getData(tag, 1U);
 			m_YSF.getData(data, 13U);
 			m_ysfN -= 1U;
+
+			m_YSFTimes.getData(&m_ysfTrace, 1U);
+			takeTrace(m_ysfTrace, m_ysfTrace.m_queued, m_ysfTaken);
+
 			return tag[0U];
 		}
 	}
@@ -843,8 +853,79 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 		m_YSF.getData(data, 13U);
 		m_ysfN -= 1U;
 
+		CLatencyTrace traces[5U];
+		m_YSFTimes.getData(traces, 5U);
+		m_ysfTrace = traces[0U];
+		takeTrace(m_ysfTrace, traces[4U].m_queued, m_ysfTaken);
+
 		return TAG_DATA;
 	}
 	else
 		return TAG_NODATA;
 }
+
+unsigned int CModeConv::getYSFDepth() const
+{
+	return m_YSF.dataSize() / 14U;
+}
+
+unsigned int CModeConv::getDMRDepth() const
+{
+	return m_DMR.dataSize() / 10U;
+}
+
+const CLatencyTrace& CModeConv::getYSFTrace() const
+{
+	return m_ysfTrace;
+}
+
+const CLatencyTrace& CModeConv::getDMRTrace() const
+{
+	return m_dmrTrace;
+}
+
+void CModeConv::addYSF(unsigned char tag, const unsigned char* data)
+{
+	CLatencyTrace trace = m_ysfInput;
+	trace.m_queued = CStopWatch::getMicroseconds();
+
+	// A frame is only queued with its time, so that the two buffers stay in step
+	if (!m_YSF.hasSpace(14U) || !m_YSFTimes.hasSpace(1U)) {
+		LogError("The DMR2YSF buffer is full, a frame is dropped");
+		return;
+	}
+
+	m_YSF.addData(&tag, 1U);
+	m_YSF.addData(data, 13U);
+	m_YSFTimes.addData(&trace, 1U);
+
+	m_ysfN += 1U;
+}
+
+void CModeConv::addDMR(unsigned char tag, const unsigned char* data)
+{
+	CLatencyTrace trace = m_dmrInput;
+	trace.m_queued = CStopWatch::getMicroseconds();
+
+	if (!m_DMR.hasSpace(10U) || !m_DMRTimes.hasSpace(1U)) {
+		LogError("The YSF2DMR buffer is full, a frame is dropped");
+		return;
+	}
+
+	m_DMR.addData(&tag, 1U);
+	m_DMR.addData(data, 9U);
+	m_DMRTimes.addData(&trace, 1U);
+
+	m_dmrN += 1U;
+}
+
+void CModeConv::takeTrace(CLatencyTrace& trace, unsigned long long queued, unsigned long long& taken)
+{
+	unsigned long long now = CStopWatch::getMicroseconds();
+
+	// A frame is ready once all of it is queued and the frame before it has been taken
+	trace.m_ready = queued > taken ? queued : taken;
+	trace.m_taken = now;
+
+	taken = now;
+}
@@ -24,16 +24,25 @@
 #if !defined(MODECONV_H)
 #define MODECONV_H
 
+// The times that a voice frame passed each stage of the bridge, from CStopWatch::getMicroseconds()
+struct CLatencyTrace {
+	unsigned long long m_received;		// Arrival from the network, zero for a frame made up by the bridge
+	unsigned long long m_read;			// Passed to the converter
+	unsigned long long m_queued;		// Converted and queued
+	unsigned long long m_ready;			// Complete and at the head of the queue
+	unsigned long long m_taken;			// Taken off the queue to be sent
+};
+
 class CModeConv {
 public:
 	CModeConv();
 	~CModeConv();
 
-	void putDMR(unsigned char* bytes);
+	void putDMR(unsigned char* bytes, unsigned long long received = 0ULL);
 	void putDMRHeader();
 	void putDMREOT();
 
-	void putYSF(unsigned char* bytes);
+	void putYSF(unsigned char* bytes, unsigned long long received = 0ULL);
 	void putDummyYSF();
 	void putYSFHeader();
 	void putYSFEOT();
@@ -41,13 +50,32 @@ public:
 	unsigned int getYSF(unsigned char* bytes);
 	unsigned int getDMR(unsigned char* bytes);
 
+	// The times of the frame last returned by getYSF() or getDMR()
+	const CLatencyTrace& getYSFTrace() const;
+	const CLatencyTrace& getDMRTrace() const;
+
+	// The number of frames waiting
+	unsigned int getYSFDepth() const;
+	unsigned int getDMRDepth() const;
+
 private:
 	void putAMBE2YSF(unsigned int a, unsigned int b, unsigned int dat_c);
 	void putAMBE2DMR(unsigned int dat_a, unsigned int dat_b, unsigned int dat_c);
+	void addYSF(unsigned char tag, const unsigned char* data);
+	void addDMR(unsigned char tag, const unsigned char* data);
+	void takeTrace(CLatencyTrace& trace, unsigned long long queued, unsigned long long& taken);
 	unsigned int m_ysfN;
 	unsigned int m_dmrN;
 	CRingBuffer<unsigned char> m_YSF;
 	CRingBuffer<unsigned char> m_DMR;
+	CRingBuffer<CLatencyTrace> m_YSFTimes;
+	CRingBuffer<CLatencyTrace> m_DMRTimes;
+	CLatencyTrace m_ysfInput;
+	CLatencyTrace m_dmrInput;
+	CLatencyTrace m_ysfTrace;
+	CLatencyTrace m_dmrTrace;
+	unsigned long long m_ysfTaken;
+	unsigned long long m_dmrTaken;
 
 };
 
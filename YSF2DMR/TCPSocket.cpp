@@ -230,3 +230,8 @@ void CTCPSocket::close()
 		m_fd = -1;
 	}
 }
+
+int CTCPSocket::getFd() const
+{
+	return m_fd;
+}
@@ -49,6 +49,8 @@ public:
 
 	void close();
 
+	int  getFd() const;
+
 private:
 	std::string    m_address;
 	unsigned short m_port;
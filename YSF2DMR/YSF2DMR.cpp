@@ -37,8 +37,8 @@ const unsigned char dt2_temp[] = {0x00, 0x00, 0x00, 0x00, 0x6C, 0x20, 0x1C, 0x20
 #define DMR_FRAME_PER       55U
 #define YSF_FRAME_PER       90U
 
-#define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
+#define DMR_SLOT_WATCHDOG   25U		// Missing frames, 1.5s as for the network watchdog
 
 #if defined(_WIN32) || defined(_WIN64)
 const char* DEFAULT_INI_FILE = "YSF2DMR.ini";
@@ -111,7 +111,9 @@ m_conf(configFile),
 m_wiresX(NULL),
 m_dmrNetwork(NULL),
 m_ysfNetwork(NULL),
+m_ysfBuilder(NULL),
 m_lookup(NULL),
+m_ysfIdentities(),
 m_conv(),
 m_colorcode(1U),
 m_srcHS(1U),
@@ -132,7 +134,7 @@ m_dtmf(NULL),
 m_APRS(NULL),
 m_dmrFrames(0U),
 m_ysfFrames(0U),
-m_EmbeddedLC(),
+m_dmrBuilder(NULL),
 m_TGList(),
 m_dmrflco(FLCO_GROUP),
 m_dmrinfo(false),
@@ -145,8 +147,31 @@ m_xlxReflectors(NULL),
 m_xlxrefl(0U),
 m_remoteGateway(false),
 m_hangTime(1000U),
-m_firstSync(false)
+m_firstSync(false),
+m_slot1(false),
+m_slot2(true),
+m_rxSlot(0U),
+m_txSlot(2U),
+m_metrics(NULL),
+m_fichErrors(NULL),
+m_dmrLogins(NULL),
+m_ysfQueue(NULL),
+m_dmrQueue(NULL),
+m_slot1Jitter(NULL),
+m_slot2Jitter(NULL),
+m_ysfConvertTime(NULL),
+m_dmrConvertTime(NULL),
+m_ysfLatency(),
+m_dmrLatency(),
+m_profiler(NULL),
+m_fichStage(0U),
+m_convertStage(0U),
+m_lcStage(0U),
+m_networkStage(0U)
 {
+	m_slotDstId[0U]  = m_slotDstId[1U]  = m_slotDstId[2U]  = 0U;
+	m_slotMissing[0U] = m_slotMissing[1U] = m_slotMissing[2U] = 0U;
+
 	m_ysfFrame = new unsigned char[200U];
 	m_dmrFrame = new unsigned char[50U];
 
@@ -264,11 +289,15 @@ int CYSF2DMR::run()
 
 	std::string fileName    = m_conf.getDMRXLXFile();
 	m_xlxReflectors = new CReflectors(fileName, 60U);
-	m_xlxReflectors->load();
+	m_xlxReflectors->read();
 
 	m_ysfNetwork = new CYSFNetwork(localAddress, localPort, m_callsign, debug);
 	m_ysfNetwork->setDestination(dstAddress, dstPort);
 
+	m_ysfBuilder = new CYSFFrameBuilder(m_ysfNetwork->getCallsign(), m_conf.getYsfRadioID());
+	m_ysfBuilder->setFICH(m_conf.getFICHCallSign(), m_conf.getFICHCallMode(), m_conf.getFICHFrameTotal(), m_conf.getFICHMessageRoute(), m_conf.getFICHVOIP(), m_conf.getFICHDataType(), m_conf.getFICHSQLType(), m_conf.getFICHSQLCode());
+	m_ysfBuilder->setDT(m_conf.getYsfDT1(), m_conf.getYsfDT2());
+
 	LogInfo("General Parameters");
 	LogInfo("    Remote Gateway: %s", m_remoteGateway ? "yes" : "no");
 	LogInfo("    Hang Time: %u ms", m_hangTime);
@@ -286,6 +315,8 @@ int CYSF2DMR::run()
 		::LogFinalise();
 		return 1;
 	}
+
+	m_dmrBuilder = new CDMRFrameBuilder(m_colorcode);
 	
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
@@ -294,6 +325,8 @@ int CYSF2DMR::run()
 	m_lookup->read();
 	m_dropUnknown = m_conf.getDMRDropUnknown();
 
+	createMetrics();
+
 	if (m_dmrpc)
 		m_dmrflco = FLCO_USER_USER;
 	else
@@ -320,7 +353,7 @@ int CYSF2DMR::run()
 
 	if (m_conf.getAPRSEnabled()) {
 		createGPS();
-		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh());
+		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh(), m_conf.getAPRSAPIServer(), m_conf.getAPRSAPIPort());
 	}
 	
 	CStopWatch TGChange;
@@ -346,6 +379,8 @@ int CYSF2DMR::run()
 
 	unsigned int tglistOpt = 0; 
 
+	bool dmrConnected = false;
+
 	for (; end == 0;) {
 		unsigned char buffer[2000U];
 
@@ -401,7 +436,11 @@ int CYSF2DMR::run()
 
 		while (m_ysfNetwork->read(buffer) > 0U) {
 			CYSFFICH fich;
+			m_profiler->begin(m_fichStage);
 			bool valid = fich.decode(buffer + 35U);
+			m_profiler->end(m_fichStage);
+			if (!valid)
+				m_fichErrors->inc();
 
 			if (valid) {
 				unsigned char fi = fich.getFI();
@@ -579,12 +618,12 @@ int CYSF2DMR::run()
 							std::string ysfDst = ysfPayload.getDest();
 							LogMessage("Received YSF Header: Src: %s Dst: %s", ysfSrc.c_str(), ysfDst.c_str());
 							
-							m_dmrNetwork->reset(2U);	// OE1KBC fix
+							m_dmrNetwork->reset(getTxSlot(m_dstid));	// OE1KBC fix
 							
 							m_srcid = findYSFID(ysfSrc, true);
 							if (m_dropUnknown == 0 || m_srcid != 0) {
 								ysfWatchdog.start();
-								m_dmrNetwork->reset(2U);	// OE1KBC fix
+								m_dmrNetwork->reset(getTxSlot(m_dstid));	// OE1KBC fix
 								 m_conv.putYSFHeader();
 								m_ysfFrames = 0U;
 							}
@@ -594,6 +633,8 @@ int CYSF2DMR::run()
 							}
 						}
 					} else if (fi == YSF_FI_TERMINATOR) {
+						m_ysfIdentities.remove(0U);
+
 						if (m_dropUnknown == 0 || m_srcid != 0) {
 							ysfWatchdog.stop();
 							int extraFrames = (m_hangTime / 100U) - m_ysfFrames - 2U;
@@ -606,7 +647,11 @@ int CYSF2DMR::run()
 					} else if (fi == YSF_FI_COMMUNICATIONS) {
 						if (m_dropUnknown == 0 || m_srcid != 0) {
 							ysfWatchdog.start();
-							m_conv.putYSF(buffer + 35U);
+							unsigned long long start = CMetrics::getMicroseconds();
+							m_profiler->begin(m_convertStage);
+							m_conv.putYSF(buffer + 35U, m_ysfNetwork->getReceived());
+							m_profiler->end(m_convertStage);
+							m_ysfConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 							m_ysfFrames++;
 						}
 					}
@@ -631,8 +676,9 @@ int CYSF2DMR::run()
 			if(dmrFrameType == TAG_HEADER) {
 				CDMRData rx_dmrdata;
 				dmr_cnt = 0U;
+				m_txSlot = getTxSlot(m_dstid);
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_srcid);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -642,20 +688,12 @@ int CYSF2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
+				// Header, from the LC of the call
+				m_profiler->begin(m_lcStage);
+				m_dmrBuilder->setLC(m_dmrflco, m_srcid, m_dstid);
+				m_profiler->end(m_lcStage);
 
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-	
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
+				m_dmrBuilder->getHeader(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -676,10 +714,9 @@ int CYSF2DMR::run()
 				if (n_dmr) {
 					for (unsigned int i = 0U; i < fill; i++) {
 
-						CDMREMB emb;
 						CDMRData rx_dmrdata;
 
-						rx_dmrdata.setSlotNo(2U);
+						rx_dmrdata.setSlotNo(m_txSlot);
 						rx_dmrdata.setSrcId(m_srcid);
 						rx_dmrdata.setDstId(m_dstid);
 						rx_dmrdata.setFLCO(m_dmrflco);
@@ -691,13 +728,8 @@ int CYSF2DMR::run()
 
 						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
 
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
+						// Add the EMB and embedded LC
+						m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
 
 						rx_dmrdata.setData(m_dmrFrame);
 				
@@ -709,7 +741,7 @@ int CYSF2DMR::run()
 					}
 				}
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_srcid);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -719,19 +751,12 @@ int CYSF2DMR::run()
 				rx_dmrdata.setRSSI(0U);
 				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
+				// Terminator, from the LC of the call
+				m_profiler->begin(m_lcStage);
+				m_dmrBuilder->setLC(m_dmrflco, m_srcid, m_dstid);
+				m_profiler->end(m_lcStage);
 
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-	
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+				m_dmrBuilder->getTerminator(m_dmrFrame);
 				
 				rx_dmrdata.setData(m_dmrFrame);
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
@@ -740,11 +765,10 @@ int CYSF2DMR::run()
 				dmrWatch.start();
 			}
 			else if(dmrFrameType == TAG_DATA) {
-				CDMREMB emb;
 				CDMRData rx_dmrdata;
 				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
 
-				rx_dmrdata.setSlotNo(2U);
+				rx_dmrdata.setSlotNo(m_txSlot);
 				rx_dmrdata.setSrcId(m_srcid);
 				rx_dmrdata.setDstId(m_dstid);
 				rx_dmrdata.setFLCO(m_dmrflco);
@@ -755,27 +779,26 @@ int CYSF2DMR::run()
 			
 				if (!n_dmr) {
 					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
+					// Any change of the LC is sent from this superframe
+					m_profiler->begin(m_lcStage);
+					m_dmrBuilder->setLC(m_dmrflco, m_srcid, m_dstid);
+					m_profiler->end(m_lcStage);
 				}
 				else {
 					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
 				}
 
+				// Add the sync, or the EMB and embedded LC
+				m_dmrBuilder->getVoice(m_dmrFrame, n_dmr);
+
 				rx_dmrdata.setData(m_dmrFrame);
 				
 				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
+				m_profiler->begin(m_networkStage);
 				m_dmrNetwork->write(rx_dmrdata);
+				m_profiler->end(m_networkStage);
+
+				traceLatency(m_conv.getDMRTrace(), m_ysfLatency);
 
 				dmr_cnt++;
 				dmrWatch.start();
@@ -783,6 +806,34 @@ int CYSF2DMR::run()
 		}
 
 		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int slotNo = tx_dmrdata.getSlotNo();
+
+			if (!tx_dmrdata.isMissing() && tx_dmrdata.getFLCO() == FLCO_GROUP)
+				m_slotDstId[slotNo] = tx_dmrdata.getDstId();
+
+			// There is a single conversion to the other mode, the first slot to start a call keeps it,
+			// and a call on the other slot is picked up by its late entry once that call has ended
+			if (m_rxSlot == 0U && !tx_dmrdata.isMissing()) {
+				m_rxSlot = slotNo;
+				m_slotMissing[slotNo] = 0U;
+			}
+
+			if (slotNo != m_rxSlot) {
+				// The buffer of the other slot is still reset when its call ends, or when it stops without a terminator
+				if (tx_dmrdata.isMissing())
+					m_slotMissing[slotNo]++;
+				else
+					m_slotMissing[slotNo] = 0U;
+
+				bool ended = !tx_dmrdata.isMissing() && tx_dmrdata.getDataType() == DT_TERMINATOR_WITH_LC;
+				if (ended || m_slotMissing[slotNo] >= DMR_SLOT_WATCHDOG) {
+					m_dmrNetwork->reset(slotNo);
+					m_slotMissing[slotNo] = 0U;
+				}
+
+				continue;
+			}
+
 			unsigned int SrcId = tx_dmrdata.getSrcId();
 			unsigned int DstId = tx_dmrdata.getDstId();
 			
@@ -794,7 +845,8 @@ int CYSF2DMR::run()
 
 				if(DataType == DT_TERMINATOR_WITH_LC) {
 					if (m_dmrFrames == 0U) {
-						m_dmrNetwork->reset(2U);
+						m_dmrNetwork->reset(m_rxSlot);
+						m_rxSlot = 0U;
 						networkWatchdog.stop();
 						m_dmrinfo = false;
 						m_firstSync = false;
@@ -807,7 +859,8 @@ int CYSF2DMR::run()
 						unlinkReceived = true;
 
 					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -899,7 +952,11 @@ int CYSF2DMR::run()
 						m_dmrinfo = true;
 					}
 
-					m_conv.putDMR(dmr_frame); // Add DMR frame for YSF conversion
+					unsigned long long start = CMetrics::getMicroseconds();
+					m_profiler->begin(m_convertStage);
+					m_conv.putDMR(dmr_frame, m_dmrNetwork->getReceived()); // Add DMR frame for YSF conversion
+					m_profiler->end(m_convertStage);
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 			}
@@ -907,14 +964,19 @@ int CYSF2DMR::run()
 				if(DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
 					unsigned char dmr_frame[50];
 					tx_dmrdata.getData(dmr_frame);
-					m_conv.putDMR(dmr_frame); // Add DMR frame for YSF conversion
+					unsigned long long start = CMetrics::getMicroseconds();
+					m_profiler->begin(m_convertStage);
+					m_conv.putDMR(dmr_frame, m_dmrNetwork->getReceived()); // Add DMR frame for YSF conversion
+					m_profiler->end(m_convertStage);
+					m_dmrConvertTime->observe((unsigned int)(CMetrics::getMicroseconds() - start));
 					m_dmrFrames++;
 				}
 
 				networkWatchdog.clock(ms);
 				if (networkWatchdog.hasExpired()) {
 					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
+					m_dmrNetwork->reset(m_rxSlot);
+					m_rxSlot = 0U;
 					networkWatchdog.stop();
 					m_dmrFrames = 0U;
 					m_dmrinfo = false;
@@ -930,39 +992,9 @@ int CYSF2DMR::run()
 			if(ysfFrameType == TAG_HEADER) {
 				ysf_cnt = 0U;
 
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = 0U; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
- 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->setCall(m_netSrc, m_netDst);
+
+				m_ysfBuilder->getHeader(m_ysfFrame);
 
 				m_ysfNetwork->write(m_ysfFrame);
 
@@ -970,113 +1002,22 @@ int CYSF2DMR::run()
 				ysfWatch.start();
 			}
 			else if (ysfFrameType == TAG_EOT) {
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = ysf_cnt; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
- 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
+				m_ysfBuilder->getTerminator(m_ysfFrame, ysf_cnt);
 
 				m_ysfNetwork->write(m_ysfFrame);
 			}
 			else if (ysfFrameType == TAG_DATA) {
-				CYSFFICH fich;
-				CYSFPayload ysfPayload;
-				unsigned char dch[10U];
-
-				unsigned int fn = (ysf_cnt - 1U) % (m_conf.getFICHFrameTotal() + 1);
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-
-				// Add the YSF Sync
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				switch (fn) {
-					case 0:
-						memset(dch, '*', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);
-						break;
-					case 1:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_netSrc.c_str());
-						break;
-					case 2:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (unsigned char*)m_netDst.c_str());
-						break;
-					case 5:
-						memset(dch, ' ', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
- 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);	// Rem3/4
- 						break;
-					case 6: {
-							unsigned char dt1[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT1().size() && i < 10U; i++)
-								dt1[i] = m_conf.getYsfDT1()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt1);
-						}
-						break;
-					case 7: {
-							unsigned char dt2[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT2().size() && i < 10U; i++)
-								dt2[i] = m_conf.getYsfDT2()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt2);
-						}
-						break;
-					default:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
-				}
+				// Only encodes again when a late entry has changed the names
+				m_ysfBuilder->setCall(m_netSrc, m_netDst);
 
-				// Set the FICH
-				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
- 				fich.setBN(0U);
- 				fich.setBT(0U);
- 				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
- 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
- 				fich.encode(m_ysfFrame + 35U);
-
-				// Net frame counter
-				m_ysfFrame[34U] = (ysf_cnt & 0x7FU) << 1;
+				m_ysfBuilder->getData(m_ysfFrame, ysf_cnt);
 
 				// Send data to MMDVMHost
+				m_profiler->begin(m_networkStage);
 				m_ysfNetwork->write(m_ysfFrame);
+				m_profiler->end(m_networkStage);
+
+				traceLatency(m_conv.getYSFTrace(), m_dmrLatency);
 
 				ysf_cnt++;
 				ysfWatch.start();
@@ -1085,8 +1026,22 @@ int CYSF2DMR::run()
 
 		stopWatch.start();
 
+		m_profiler->begin(m_networkStage);
 		m_ysfNetwork->clock(ms);
 		m_dmrNetwork->clock(ms);
+		m_profiler->end(m_networkStage);
+
+		bool connected = m_dmrNetwork->isConnected();
+		if (connected && !dmrConnected)
+			m_dmrLogins->inc();
+		dmrConnected = connected;
+
+		m_ysfQueue->set(m_conv.getYSFDepth());
+		m_dmrQueue->set(m_conv.getDMRDepth());
+		m_slot1Jitter->set(m_dmrNetwork->getJitterDepth(1U));
+		m_slot2Jitter->set(m_dmrNetwork->getJitterDepth(2U));
+
+		m_profiler->clock(ms);
 
 		if (m_wiresX != NULL)
 			m_wiresX->clock(ms);
@@ -1106,15 +1061,16 @@ int CYSF2DMR::run()
 			for (int i = 0U; i < extraFrames; i++)
 				m_conv.putDummyYSF();
 			ysfWatchdog.stop();
+			m_ysfIdentities.remove(0U);
 		}
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
-
 		if (ms < 5U)
 			CThread::sleep(5U);
 	}
 
+	// The metrics refer to the networks
+	m_metrics->stop();
+
 	m_ysfNetwork->close();
 	m_dmrNetwork->close();
 	
@@ -1129,21 +1085,77 @@ int CYSF2DMR::run()
 	}
 	
 	delete m_dmrNetwork;
+	delete m_dmrBuilder;
 	delete m_ysfNetwork;
+	delete m_ysfBuilder;
 
 	if (m_wiresX != NULL) {
 		delete m_wiresX;
 		delete m_dtmf;
 	}
 
-	if (m_xlxReflectors != NULL)
+	if (m_xlxReflectors != NULL) {
+		m_xlxReflectors->stop();
 		delete m_xlxReflectors;
+	}
+
+	LogMessage("Identity cache, YSF sources: %u hits, %u misses", m_ysfIdentities.getHits(), m_ysfIdentities.getMisses());
+
+	delete m_metrics;
+	delete m_profiler;
 
 	::LogFinalise();
 
 	return 0;
 }
 
+void CYSF2DMR::createMetrics()
+{
+	m_metrics = new CMetrics("ysf2dmr_");
+
+	// FEC of the YSF FICH, conversion of the AMBE, and the DMR LC with its BPTC and embedded forms,
+	// only measured when the metrics are served or summarised in the log
+	m_profiler     = new CProfiler(m_conf.getMetricsEnabled() || m_conf.getMetricsSummaryTime() > 0U, m_conf.getMetricsSummaryTime());
+	m_fichStage    = m_profiler->addStage("fich");
+	m_convertStage = m_profiler->addStage("convert");
+	m_lcStage      = m_profiler->addStage("lc");
+	m_networkStage = m_profiler->addStage("network");
+
+	m_metrics->addCounter("packets_total{network=\"YSF\",direction=\"in\"}", "Data packets through each network", m_ysfNetwork->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"YSF\",direction=\"out\"}", "Data packets through each network", m_ysfNetwork->getPacketsOut());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"in\"}", "Data packets through each network", m_dmrNetwork->getPacketsIn());
+	m_metrics->addCounter("packets_total{network=\"DMR\",direction=\"out\"}", "Data packets through each network", m_dmrNetwork->getPacketsOut());
+
+	m_ysfConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"YSF-DMR\"}", "Time taken to convert a voice frame, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+	m_dmrConvertTime = m_metrics->addHistogram("convert_microseconds{direction=\"DMR-YSF\"}", "Time taken to convert a voice frame, the count is the number of frames", METRICS_MICROSECONDS, METRICS_MICROSECONDS_COUNT);
+
+	m_fichErrors = m_metrics->addCounter("fich_errors_total", "YSF frames whose FICH could not be corrected");
+
+	m_ysfQueue    = m_metrics->addGauge("queue_frames{queue=\"YSF\"}", "Frames waiting in the converter or the jitter buffers");
+	m_dmrQueue    = m_metrics->addGauge("queue_frames{queue=\"DMR\"}", "Frames waiting in the converter or the jitter buffers");
+	m_slot1Jitter = m_metrics->addGauge("queue_frames{queue=\"DMR Slot 1\"}", "Frames waiting in the converter or the jitter buffers");
+	m_slot2Jitter = m_metrics->addGauge("queue_frames{queue=\"DMR Slot 2\"}", "Frames waiting in the converter or the jitter buffers");
+
+	m_metrics->addCounter("lookups_total{result=\"hit\"}", "DMR Id lookups", m_lookup->getHits());
+	m_metrics->addCounter("lookups_total{result=\"miss\"}", "DMR Id lookups", m_lookup->getMisses());
+
+	m_dmrLogins = m_metrics->addCounter("dmr_logins_total", "Logins to the DMR network, including each reconnect");
+
+	// DMR frames wait in the jitter buffer rather than the network buffer
+	const char* ysfStages[] = { "receive", "convert", "queue", "pacing", "send", "total" };
+	const char* dmrStages[] = { "jitter", "convert", "queue", "pacing", "send", "total" };
+
+	for (unsigned int i = 0U; i < LATENCY_STAGES; i++) {
+		m_ysfLatency[i] = m_metrics->addHistogram(std::string("latency_microseconds{direction=\"YSF-DMR\",stage=\"") + ysfStages[i] + "\"}", "Time taken by each stage from receiving a voice frame to sending it on", METRICS_LATENCY, METRICS_LATENCY_COUNT);
+		m_dmrLatency[i] = m_metrics->addHistogram(std::string("latency_microseconds{direction=\"DMR-YSF\",stage=\"") + dmrStages[i] + "\"}", "Time taken by each stage from receiving a voice frame to sending it on", METRICS_LATENCY, METRICS_LATENCY_COUNT);
+	}
+
+	m_profiler->addMetrics(m_metrics);
+
+	if (m_conf.getMetricsEnabled())
+		m_metrics->open(m_conf.getMetricsAddress(), m_conf.getMetricsPort());
+}
+
 void CYSF2DMR::createGPS()
 {
 	std::string hostname = m_conf.getAPRSServer();
@@ -1192,7 +1204,7 @@ void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco
 	CDMRLC dmrLC = CDMRLC(dmr_flco, srcid, dstid);
 
 	// Build DMR header
-	dmrdata.setSlotNo(2U);
+	dmrdata.setSlotNo(getTxSlot(dstid));
 	dmrdata.setSrcId(srcid);
 	dmrdata.setDstId(dstid);
 	dmrdata.setFLCO(dmr_flco);
@@ -1245,26 +1257,36 @@ void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco
 
 unsigned int CYSF2DMR::findYSFID(std::string cs, bool showdst)
 {
-	std::string cstrim;
 	bool dmrpc = false;
 
-	int first = cs.find_first_not_of(' ');
-	int mid1 = cs.find_last_of('-');
-	int mid2 = cs.find_last_of('/');
-	int last = cs.find_last_not_of(' ');
+	// YSF has no stream id, the entry is dropped at the end of each transmission instead
+	CIdentity identity;
+	if (!m_ysfIdentities.find(0U, (const unsigned char*)cs.c_str(), cs.size(), identity)) {
+		std::string cstrim;
+
+		int first = cs.find_first_not_of(' ');
+		int mid1 = cs.find_last_of('-');
+		int mid2 = cs.find_last_of('/');
+		int last = cs.find_last_not_of(' ');
 	
-	if (mid1 == -1 && mid2 == -1 && first == -1 && last == -1)
-		cstrim = "N0CALL";
-	else if (mid1 == -1 && mid2 == -1)
-		cstrim = cs.substr(first, (last - first + 1));
-	else if (mid1 > first)
-		cstrim = cs.substr(first, (mid1 - first));
-	else if (mid2 > first)
-		cstrim = cs.substr(first, (mid2 - first));
-	else
-		cstrim = "N0CALL";
+		if (mid1 == -1 && mid2 == -1 && first == -1 && last == -1)
+			cstrim = "N0CALL";
+		else if (mid1 == -1 && mid2 == -1)
+			cstrim = cs.substr(first, (last - first + 1));
+		else if (mid1 > first)
+			cstrim = cs.substr(first, (mid1 - first));
+		else if (mid2 > first)
+			cstrim = cs.substr(first, (mid2 - first));
+		else
+			cstrim = "N0CALL";
 
-	unsigned int id = m_lookup->findID(cstrim);
+		identity.m_id       = m_lookup->findID(cstrim);
+		identity.m_callsign = cstrim;
+		m_ysfIdentities.add(0U, (const unsigned char*)cs.c_str(), cs.size(), identity);
+	}
+
+	const std::string& cstrim = identity.m_callsign;
+	unsigned int id = identity.m_id;
 
 	if (m_dmrflco == FLCO_USER_USER)
 		dmrpc = true;
@@ -1301,6 +1323,24 @@ std::string CYSF2DMR::getSrcYSF(const unsigned char* buffer)
 	return trimmed;
 }
 
+void CYSF2DMR::traceLatency(const CLatencyTrace& trace, CMetricHistogram** latency)
+{
+	assert(latency != NULL);
+
+	// Only frames that came from the network are traced, not the silence and fill made up here
+	if (trace.m_received == 0ULL)
+		return;
+
+	unsigned long long sent = CMetrics::getMicroseconds();
+
+	latency[0U]->observe((unsigned int)(trace.m_read - trace.m_received));
+	latency[1U]->observe((unsigned int)(trace.m_queued - trace.m_read));
+	latency[2U]->observe((unsigned int)(trace.m_ready - trace.m_queued));
+	latency[3U]->observe((unsigned int)(trace.m_taken - trace.m_ready));
+	latency[4U]->observe((unsigned int)(sent - trace.m_taken));
+	latency[5U]->observe((unsigned int)(sent - trace.m_received));
+}
+
 bool CYSF2DMR::createDMRNetwork()
 {
 	std::string address  = m_conf.getDMRNetworkAddress();
@@ -1311,9 +1351,9 @@ bool CYSF2DMR::createDMRNetwork()
 	std::string password = m_conf.getDMRNetworkPassword();
 	bool debug           = m_conf.getDMRNetworkDebug();
 	unsigned int jitter  = m_conf.getDMRNetworkJitter();
-	bool slot1           = false;
-	bool slot2           = true;
-	bool duplex          = false;
+	bool slot1           = m_conf.getDMRNetworkSlot1();
+	bool slot2           = m_conf.getDMRNetworkSlot2() || !slot1;
+	bool duplex          = slot1;		// Slot 1 is only carried by a duplex hotspot
 	HW_TYPE hwType       = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -1332,11 +1372,11 @@ bool CYSF2DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (pcUnlink)
@@ -1373,6 +1413,11 @@ bool CYSF2DMR::createDMRNetwork()
 	else
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
+	LogMessage("    Slots: %s", slot1 && slot2 ? "1 and 2" : (slot1 ? "1" : "2"));
+
+	m_slot1  = slot1;
+	m_slot2  = slot2;
+	m_txSlot = getTxSlot(m_dstid);
 
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
@@ -1418,6 +1463,15 @@ bool CYSF2DMR::createDMRNetwork()
 	return true;
 }
 
+unsigned int CYSF2DMR::getTxSlot(unsigned int dstId) const
+{
+	// A talkgroup goes out on the slot it was last heard on, anything else on slot 2 when it is carried
+	if (m_slot1 && m_slot2 && m_slotDstId[1U] == dstId && m_slotDstId[2U] != dstId)
+		return 1U;
+
+	return m_slot2 ? 2U : 1U;
+}
+
 void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -1426,7 +1480,7 @@ void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 
 	CDMRData data;
 
-	data.setSlotNo(XLX_SLOT);
+	data.setSlotNo(getTxSlot(dstId));
 	data.setFLCO(FLCO_USER_USER);
 	data.setSrcId(srcId);
 	data.setDstId(dstId);
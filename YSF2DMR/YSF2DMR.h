@@ -25,17 +25,22 @@
 #include "ModeConv.h"
 #include "DMRNetwork.h"
 #include "DMREmbeddedData.h"
+#include "DMRFrameBuilder.h"
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
 #include "DMRLookup.h"
+#include "IdentityCache.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
 #include "Version.h"
 #include "YSFPayload.h"
 #include "YSFNetwork.h"
+#include "YSFFrameBuilder.h"
 #include "YSFFICH.h"
 #include "Reflectors.h"
+#include "Metrics.h"
+#include "Profiler.h"
 #include "Thread.h"
 #include "Timer.h"
 #include "Sync.h"
@@ -50,6 +55,9 @@
 
 #include <string>
 
+// Receive or jitter buffer, convert, queue, pacing, send and the total
+const unsigned int LATENCY_STAGES = 6U;
+
 enum TG_STATUS {
 	NONE,
 	WAITING_UNLINK,
@@ -72,7 +80,9 @@ private:
 	CWiresX*         m_wiresX;
 	CDMRNetwork*     m_dmrNetwork;
 	CYSFNetwork*     m_ysfNetwork;
+	CYSFFrameBuilder* m_ysfBuilder;
 	CDMRLookup*      m_lookup;
+	CIdentityCache   m_ysfIdentities;
 	CModeConv        m_conv;
 	unsigned int     m_colorcode;
 	unsigned int     m_srcHS;
@@ -93,7 +103,7 @@ private:
 	CAPRSReader*     m_APRS;
 	unsigned int     m_dmrFrames;
 	unsigned int     m_ysfFrames;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRFrameBuilder* m_dmrBuilder;
 	std::string      m_TGList;
 	FLCO             m_dmrflco;
 	bool             m_dmrinfo;
@@ -107,10 +117,35 @@ private:
 	bool             m_remoteGateway;
 	unsigned int     m_hangTime;
 	bool             m_firstSync;
+	bool             m_slot1;
+	bool             m_slot2;
+	unsigned int     m_rxSlot;				// The slot being converted, zero when idle
+	unsigned int     m_txSlot;
+	unsigned int     m_slotDstId[3U];			// The talkgroup last heard on each slot
+	unsigned int     m_slotMissing[3U];			// Missing frames in a row on a slot that is not converted
 	bool             m_dropUnknown;
+	CMetrics*        m_metrics;
+	CMetricCounter*  m_fichErrors;
+	CMetricCounter*  m_dmrLogins;
+	CMetricGauge*    m_ysfQueue;
+	CMetricGauge*    m_dmrQueue;
+	CMetricGauge*    m_slot1Jitter;
+	CMetricGauge*    m_slot2Jitter;
+	CMetricHistogram* m_ysfConvertTime;
+	CMetricHistogram* m_dmrConvertTime;
+	CMetricHistogram* m_ysfLatency[LATENCY_STAGES];
+	CMetricHistogram* m_dmrLatency[LATENCY_STAGES];
+	CProfiler*       m_profiler;
+	unsigned int     m_fichStage;
+	unsigned int     m_convertStage;
+	unsigned int     m_lcStage;
+	unsigned int     m_networkStage;
 
 	bool createDMRNetwork();
+	unsigned int getTxSlot(unsigned int dstId) const;
 	void createGPS();
+	void createMetrics();
+	void traceLatency(const CLatencyTrace& trace, CMetricHistogram** latency);
 	void SendDummyDMR(unsigned int srcid, unsigned int dstid, FLCO dmr_flco);
 	unsigned int findYSFID(std::string cs, bool showdst);
 	std::string getSrcYSF(const unsigned char* source);
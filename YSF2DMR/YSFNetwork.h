@@ -25,6 +25,7 @@
 
 #include <cstdint>
 #include <string>
+#include <atomic>
 
 class CYSFNetwork {
 public:
@@ -46,10 +47,17 @@ public:
 
 	unsigned int read(unsigned char* data);
 
+	// When the frame last returned by read() arrived, from CStopWatch::getMicroseconds()
+	unsigned long long getReceived() const;
+
 	void clock(unsigned int ms);
 
 	void close();
 
+	// Data frames through the network, for the metrics
+	const std::atomic<unsigned long long>& getPacketsIn() const;
+	const std::atomic<unsigned long long>& getPacketsOut() const;
+
 private:
 	std::string                m_callsign;
 	CUDPSocket                 m_socket;
@@ -59,6 +67,9 @@ private:
 	unsigned char*             m_poll;
 	unsigned char*             m_unlink;
 	CRingBuffer<unsigned char> m_buffer;
+	std::atomic<unsigned long long> m_packetsIn;
+	std::atomic<unsigned long long> m_packetsOut;
+	unsigned long long         m_received;
 };
 
 #endif
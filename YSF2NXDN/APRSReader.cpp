@@ -52,20 +52,36 @@ int gettimeofday(struct timeval * tp, struct timezone * tzp)
 
 const unsigned int APRS_TIMEOUT = 10U;
 
-CAPRSReader::CAPRSReader(std::string ApiKey,int refres_time) :
+// Each callsign is asked for with six SSIDs and aprs.fi takes up to 20 names in one query
+const unsigned int APRS_BATCH_LENGTH = 3U;
+const unsigned int APRS_QUEUE_LENGTH = 20U;
+const unsigned int APRS_CACHE_SIZE   = 1000U;
+
+// Seconds before the callsigns of a failed query are asked for again
+const unsigned int APRS_RETRY_TIME   = 30U;
+
+const char* const APRS_SSIDS[] = {"-Y", "-7", "-8", "-9", "-14", ""};
+const unsigned int APRS_SSID_COUNT = 6U;
+
+static unsigned int getSeconds()
+{
+	struct timeval timeinfo;
+	gettimeofday(&timeinfo, 0);
+
+	return timeinfo.tv_sec;
+}
+
+CAPRSReader::CAPRSReader(std::string ApiKey, int refres_time, const std::string& server, unsigned int port) :
 CThread(),
 m_ApiKey(ApiKey),
-m_cs(),
+m_server(server),
+m_port(port),
 m_stop(false),
-m_new_callsign(false),
 m_refres_time(refres_time),
-m_lat_table(),
-m_lon_table(),
-m_time_table()
+m_mutex(),
+m_positions(),
+m_queue()
 {
-	m_lat_table.clear();
-	m_lon_table.clear();
-	m_time_table.clear();
 	run();
 }
 
@@ -79,13 +95,19 @@ void CAPRSReader::entry()
 	LogMessage("Started the APRS Reader lookup thread");
 
 	while (!m_stop) {
-		
-		while(!m_new_callsign)
-			sleep(1000U);
-		
-		load_call();
-		
-		m_new_callsign = false;
+		std::vector<std::string> callsigns;
+
+		m_mutex.lock();
+		while (!m_queue.empty() && callsigns.size() < APRS_BATCH_LENGTH) {
+			callsigns.push_back(m_queue.front());
+			m_queue.pop_front();
+		}
+		m_mutex.unlock();
+
+		if (callsigns.empty())
+			sleep(100U);
+		else
+			load_calls(callsigns);
 	}
 
 	LogMessage("Stopped the APRS Reader lookup thread");
@@ -94,6 +116,8 @@ void CAPRSReader::entry()
 void CAPRSReader::stop()
 {
 	m_stop = true;
+
+	wait();
 }
 
 void CAPRSReader::formatGPS(unsigned char *buffer, int latitude, int longitude)
@@ -173,127 +197,149 @@ void CAPRSReader::formatGPS(unsigned char *buffer, int latitude, int longitude)
 	*(buffer + 19U) = crc;
 }
 
-bool CAPRSReader::load_call() 
+bool CAPRSReader::load_calls(const std::vector<std::string>& callsigns)
 {
-	struct timeval timeinfo;
-	unsigned long epoch;
-
-	int longitude = 0;
-	int latitude = 0;
-	
 	unsigned char buffer[10000];
 	int nDataLength;
 	std::string website_HTML;
 
 	// get information
-	// LogMessage("Searching %s", callsign.c_str());
 	// website url
-	std::string url = "/api/get?name=" + m_cs + "-Y," + m_cs + "-7," + m_cs + "-8," + m_cs + "-9,";
-	url = url + m_cs + "-14," + m_cs + "&what=loc&apikey=" + m_ApiKey + "&format=json";
+	std::string names;
+	for (std::vector<std::string>::const_iterator it = callsigns.begin(); it != callsigns.end(); ++it) {
+		for (unsigned int i = 0U; i < APRS_SSID_COUNT; i++) {
+			if (!names.empty())
+				names += ",";
+			names += *it + APRS_SSIDS[i];
+		}
+	}
+
+	std::string url = "/api/get?name=" + names + "&what=loc&apikey=" + m_ApiKey + "&format=json";
 	//HTTP GET
-	std::string get_http = "GET " + url + " HTTP/1.1\r\nHost: api.aprs.fi\r\nUser-Agent: YSF2DMR/0.12\r\n\r\n";		
-	CTCPSocket sockfd("api.aprs.fi", 80);
+	std::string get_http = "GET " + url + " HTTP/1.1\r\nHost: " + m_server + "\r\nUser-Agent: YSF2DMR/0.12\r\nConnection: close\r\n\r\n";
+	CTCPSocket sockfd(m_server, m_port);
 
 	bool ret = sockfd.open();
-	if (!ret){
-		LogMessage("Could not connect to api.aprs.fi");
-		return false;
+	if (ret) {
+		// send GET / HTTP
+		ret = sockfd.write((const unsigned char*)get_http.c_str(), strlen(get_http.c_str()));
+
+		// recieve html, the server closes the connection at the end of the reply
+		while (ret && website_HTML.size() < 100000U && (nDataLength = sockfd.read(buffer, 10000, APRS_TIMEOUT)) > 0)
+			website_HTML.append((char*)buffer, nDataLength);
+
+		sockfd.close();
 	}
 
-	// send GET / HTTP
-	sockfd.write((const unsigned char*)get_http.c_str(), strlen(get_http.c_str()));
-
-	// recieve html
-	while ((nDataLength = sockfd.read(buffer, 10000, APRS_TIMEOUT)) > 0){
-		int i = 0;
-		char tmp_str[20];
-		for (i = 0; i < nDataLength; i++) {
-			if (i > 5 && buffer[i - 4] == '\"' && buffer[i - 3] == 'l' && buffer[i - 2] == 'a' && buffer[i - 1] == 't' && buffer[i] == '\"'){
-				::memcpy(tmp_str, buffer + i + 3, 8U);
-				tmp_str[8] = 0;
-				//LogMessage("Latitude: %s", tmp_str);
-				latitude = (int)(atof(tmp_str) * 1000);
-				m_lat_table[m_cs] = latitude;
-			}
-			if (i > 5 && buffer[i - 4] == '\"' && buffer[i - 3] == 'l' && buffer[i - 2] == 'n' && buffer[i - 1] == 'g' && buffer[i] == '\"'){
-				::memcpy(tmp_str,buffer + i + 3, 8U);
-				tmp_str[8] = 0;
-				//LogMessage("Longitude: %s", tmp_str);
-				longitude = (int)(atof(tmp_str) * 1000);
-				m_lon_table[m_cs] = longitude;
-			}
-			
-			if ((latitude != 0) && (longitude != 0))
-				break;
-		}
-		if ((latitude != 0) && (longitude != 0))
+	ret = ret && website_HTML.find("\"result\":\"ok\"") != std::string::npos;
+
+	// Each entry starts with its name, followed by its position
+	std::unordered_map<std::string, std::pair<int, int> > found;
+
+	std::string::size_type pos = website_HTML.find("\"name\":\"");
+	while (ret && pos != std::string::npos) {
+		std::string::size_type start = pos + 8U;
+		std::string::size_type end = website_HTML.find('\"', start);
+		if (end == std::string::npos)
 			break;
+
+		std::string name = website_HTML.substr(start, end - start);
+		std::string::size_type next = website_HTML.find("\"name\":\"", end);
+
+		std::string::size_type lat = website_HTML.find("\"lat\":\"", end);
+		std::string::size_type lng = website_HTML.find("\"lng\":\"", end);
+
+		if (lat < next && lng < next) {
+			int latitude  = (int)(atof(website_HTML.c_str() + lat + 7U) * 1000);
+			int longitude = (int)(atof(website_HTML.c_str() + lng + 7U) * 1000);
+
+			// The first position found for any of the SSIDs of a callsign is the one used
+			std::string cs = name.substr(0U, name.find('-'));
+			if (latitude != 0 && longitude != 0 && found.count(cs) == 0U)
+				found[cs] = std::make_pair(latitude, longitude);
+		}
+
+		pos = next;
 	}
 
-	sockfd.close();
+	if (!ret)
+		LogMessage("Could not get the GPS positions from %s", m_server.c_str());
 
-	gettimeofday(&timeinfo, 0);
-	epoch = timeinfo.tv_sec;
-	m_time_table[m_cs] = epoch;
+	unsigned int now = getSeconds();
 
-	if (latitude == 0 || longitude == 0) {
-		m_lat_table[m_cs] = 0;
-		m_lon_table[m_cs] = 0;
-		LogMessage("GPS Position of %s not found", m_cs.c_str());
-		return false;
+	m_mutex.lock();
+
+	for (std::vector<std::string>::const_iterator it = callsigns.begin(); it != callsigns.end(); ++it) {
+		CAPRSPosition& position = m_positions[*it];
+		position.m_pending = false;
+
+		if (!ret) {
+			// Keep any position we had, and try again soon
+			position.m_expiry = now + APRS_RETRY_TIME;
+			continue;
+		}
+
+		position.m_expiry = now + m_refres_time;
+
+		std::unordered_map<std::string, std::pair<int, int> >::const_iterator entry = found.find(*it);
+		if (entry == found.end()) {
+			position.m_latitude  = 0;
+			position.m_longitude = 0;
+			LogMessage("GPS Position of %s not found", it->c_str());
+		} else {
+			position.m_latitude  = entry->second.first;
+			position.m_longitude = entry->second.second;
+			LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", it->c_str(), (float)position.m_latitude / 1000.0, (float)position.m_longitude / 1000.0);
+		}
 	}
-	else {
-		LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", m_cs.c_str(), (float)latitude / 1000.0, (float)longitude / 1000.0);
-		return true;
+
+	m_mutex.unlock();
+
+	return ret;
+}
+
+// Called with the mutex held
+void CAPRSReader::request(const std::string& cs, unsigned int now)
+{
+	if (m_queue.size() >= APRS_QUEUE_LENGTH)
+		return;
+
+	if (m_positions.size() >= APRS_CACHE_SIZE) {
+		for (std::unordered_map<std::string, CAPRSPosition>::iterator it = m_positions.begin(); it != m_positions.end();) {
+			if (!it->second.m_pending && now >= it->second.m_expiry)
+				it = m_positions.erase(it);
+			else
+				++it;
+		}
 	}
+
+	m_positions[cs].m_pending = true;
+	m_queue.push_back(cs);
 }
 
 bool CAPRSReader::findCall(std::string cs, int *latitude, int *longitude)
 {
-	bool not_found = false;
-	struct timeval timeinfo;
-	unsigned int epoch, tempo;
+	unsigned int now = getSeconds();
 
-	try {
-		*latitude = m_lat_table.at(cs);
-	} catch (...) {
-		not_found = true;
-	}
+	m_mutex.lock();
 
-	try {
-		*longitude = m_lon_table.at(cs);
-	} catch (...) {
-		not_found = true;
+	std::unordered_map<std::string, CAPRSPosition>::const_iterator it = m_positions.find(cs);
+	if (it == m_positions.end()) {
+		request(cs, now);
+		m_mutex.unlock();
+		return false;
 	}
 
-	if (m_new_callsign) {
-		if (not_found)
-			return false;
-		else if ((*latitude != 0) && (*longitude != 0))
-			return true;
-		else
-			return false;
-	} 
+	*latitude  = it->second.m_latitude;
+	*longitude = it->second.m_longitude;
 
-	if (not_found) {
-		m_new_callsign = true;
-		m_cs = cs;
-		return false;
+	// The old position is used until the new one arrives
+	if (!it->second.m_pending && now >= it->second.m_expiry) {
+		//LogMessage("Location expired");
+		request(cs, now);
 	}
-	else {
-		gettimeofday(&timeinfo, 0);
-		epoch = timeinfo.tv_sec;
-		tempo = m_time_table.at(cs);
-
-		if (epoch > (tempo + m_refres_time)) {
-			//LogMessage("Location expired");
-			m_new_callsign = true;
-			m_cs = cs;
-		}
 
-		if ((*latitude != 0) && (*longitude != 0))
-			return true;
-		else
-			return false;
-	}
+	m_mutex.unlock();
+
+	return (*latitude != 0) && (*longitude != 0);
 }
@@ -25,11 +25,31 @@
 #include "Mutex.h"
 
 #include <string>
+#include <vector>
+#include <deque>
 #include <unordered_map>
 
+class CAPRSPosition {
+public:
+	CAPRSPosition() :
+	m_latitude(0),
+	m_longitude(0),
+	m_expiry(0U),
+	m_pending(false)
+	{
+	}
+
+	int          m_latitude;
+	int          m_longitude;
+	unsigned int m_expiry;
+	bool         m_pending;
+};
+
+// Positions are looked up on the reader thread and kept until they expire. The callsigns
+// asked for while a lookup is running are queued, and sent to aprs.fi in one query.
 class CAPRSReader : public CThread  {
 public:
-	CAPRSReader(std::string ApiKey, int refres_time);
+	CAPRSReader(std::string ApiKey, int refres_time, const std::string& server = "api.aprs.fi", unsigned int port = 80U);
 	virtual ~CAPRSReader();
 
 	virtual void entry();
@@ -37,17 +57,19 @@ public:
 	bool findCall(std::string cs, int *latitude, int *longitude);
     void formatGPS(unsigned char *buffer, int latitude, int longitude);
 	void stop();
-	bool load_call();
 
 private:
 	std::string m_ApiKey;
-	std::string m_cs;
+	std::string m_server;
+	unsigned int m_port;
 	bool m_stop;
-	bool m_new_callsign;
 	unsigned int  m_refres_time;
-	std::unordered_map<std::string, int> m_lat_table;
-	std::unordered_map<std::string, int> m_lon_table;
-	std::unordered_map<std::string, unsigned int> m_time_table;
+	CMutex m_mutex;
+	std::unordered_map<std::string, CAPRSPosition> m_positions;
+	std::deque<std::string> m_queue;
+
+	void request(const std::string& cs, unsigned int now);
+	bool load_calls(const std::vector<std::string>& callsigns);
 };
 
 #endif
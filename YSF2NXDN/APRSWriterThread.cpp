@@ -18,6 +18,7 @@
  */
 
 #include "APRSWriterThread.h"
+#include "StopWatch.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -26,20 +27,45 @@
 #include <cctype>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/select.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // #define	DUMP_TX
 
 const unsigned int CALLSIGN_LENGTH = 8U;
 
 const unsigned int APRS_TIMEOUT = 10U;
 
+// An APRS-IS line is no longer than 512 bytes, including the CR LF
+const unsigned int APRS_QUEUE_LENGTH   = 20U;
+const unsigned int APRS_MESSAGE_LENGTH = 512U;
+
+// The reconnect delay doubles after each failure, in seconds
+const unsigned int APRS_MIN_BACKOFF = 5U;
+const unsigned int APRS_MAX_BACKOFF = 320U;
+
+// Seconds between packets from the same source
+const unsigned int APRS_RATE_LIMIT = 10U;
+
 CAPRSWriterThread::CAPRSWriterThread(const std::string& callsign, const std::string& password, const std::string& address, unsigned int port) :
 CThread(),
 m_username(callsign),
 m_password(password),
 m_socket(address, port),
-m_queue(20U, "APRS Queue"),
+m_slots(NULL),
+m_head(0U),
+m_count(0U),
+m_mutex(),
+m_lastPacket(),
+m_sent(0U),
+m_dropped(0U),
+m_limited(0U),
 m_exit(false),
 m_connected(false),
 m_APRSReadCallback(NULL),
@@ -51,9 +77,7 @@ m_clientName("YSF2DMR")
 	assert(!address.empty());
 	assert(port > 0U);
 
-	m_username.resize(CALLSIGN_LENGTH, ' ');
-	m_username.erase(std::find_if(m_username.rbegin(), m_username.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), m_username.end());
-	std::transform(m_username.begin(), m_username.end(), m_username.begin(), ::toupper);
+	init();
 }
 
 CAPRSWriterThread::CAPRSWriterThread(const std::string& callsign, const std::string& password, const std::string& address, unsigned int port, const std::string& filter, const std::string& clientName) :
@@ -61,7 +85,14 @@ CThread(),
 m_username(callsign),
 m_password(password),
 m_socket(address, port),
-m_queue(20U, "APRS Queue"),
+m_slots(NULL),
+m_head(0U),
+m_count(0U),
+m_mutex(),
+m_lastPacket(),
+m_sent(0U),
+m_dropped(0U),
+m_limited(0U),
 m_exit(false),
 m_connected(false),
 m_APRSReadCallback(NULL),
@@ -73,16 +104,45 @@ m_clientName(clientName)
 	assert(!address.empty());
 	assert(port > 0U);
 
-	m_username.resize(CALLSIGN_LENGTH, ' ');
-	m_username.erase(std::find_if(m_username.rbegin(), m_username.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), m_username.end());
-	std::transform(m_username.begin(), m_username.end(), m_username.begin(), ::toupper);
+	init();
 }
 
 CAPRSWriterThread::~CAPRSWriterThread()
 {
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_wakeup[0U] != -1) {
+		::close(m_wakeup[0U]);
+		::close(m_wakeup[1U]);
+	}
+#endif
+
+	delete[] m_slots;
+
 	m_username.clear();
 }
 
+void CAPRSWriterThread::init()
+{
+	m_username.resize(CALLSIGN_LENGTH, ' ');
+	m_username.erase(std::find_if(m_username.rbegin(), m_username.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), m_username.end());
+	std::transform(m_username.begin(), m_username.end(), m_username.begin(), ::toupper);
+
+	m_slots = new char[APRS_QUEUE_LENGTH * APRS_MESSAGE_LENGTH];
+
+	m_wakeup[0U] = -1;
+	m_wakeup[1U] = -1;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (::pipe(m_wakeup) == 0) {
+		::fcntl(m_wakeup[0U], F_SETFL, O_NONBLOCK);
+		::fcntl(m_wakeup[1U], F_SETFL, O_NONBLOCK);
+	} else {
+		m_wakeup[0U] = -1;
+		m_wakeup[1U] = -1;
+	}
+#endif
+}
+
 bool CAPRSWriterThread::start()
 {
 	run();
@@ -94,66 +154,75 @@ void CAPRSWriterThread::entry()
 {
 	LogMessage("Starting the APRS Writer thread");
 
-	m_connected = connect();
+	unsigned int backoff = APRS_MIN_BACKOFF;
 
 	try {
 		while (!m_exit) {
 			if (!m_connected) {
 				m_connected = connect();
 
-				if (!m_connected){
-					LogError("Reconnect attempt to the APRS server has failed");
-					sleep(10000UL);		// 10 secs
+				if (!m_connected) {
+					LogError("Reconnect attempt to the APRS server has failed, retrying in %u seconds", backoff);
+
+					// Packets written meanwhile are kept, only stop() ends the wait early
+					CStopWatch stopWatch;
+					stopWatch.start();
+					while (!m_exit && stopWatch.elapsed() < backoff * 1000U)
+						waitForEvent(backoff * 1000U - stopWatch.elapsed());
+
+					backoff = std::min(backoff * 2U, APRS_MAX_BACKOFF);
+					continue;
 				}
+
+				backoff = APRS_MIN_BACKOFF;
 			}
 
-			if (m_connected) {
-				if (!m_queue.isEmpty()){
-					char* p = NULL;
-					m_queue.getData(&p, 1U);
+			char p[APRS_MESSAGE_LENGTH + 2U];
+			while (m_connected && getPacket(p)) {
+				LogMessage("APRS ==> %s", p);
 
-					LogMessage("APRS ==> %s", p);
+				::strcat(p, "\r\n");
 
-					::strcat(p, "\r\n");
+				bool ret = m_socket.write((unsigned char*)p, ::strlen(p));
+				if (!ret) {
+					m_connected = false;
+					m_socket.close();
+					LogError("Connection to the APRS thread has failed");
+				}
 
-					bool ret = m_socket.write((unsigned char*)p, ::strlen(p));
-					if (!ret) {
-						m_connected = false;
-						m_socket.close();
-						LogError("Connection to the APRS thread has failed");
-					}
+				m_mutex.lock();
+				if (ret)
+					m_sent++;
+				else
+					m_dropped++;
+				m_mutex.unlock();
+			}
 
-					delete[] p;
-				}
-				{
-					std::string line;
-					int length = m_socket.readLine(line, APRS_TIMEOUT);
-
-					if (length < 0) {
-						m_connected = false;
-						m_socket.close();
-						LogError("Error when reading from the APRS server");
-					}
-
-					if(length > 0 && line.at(0U) != '#'//check if we have something and if that something is an APRS frame
-					    && m_APRSReadCallback != NULL)//do we have someone wanting an APRS Frame?
-					{	
-						//wxLogMessage(wxT("Received APRS Frame : ") + line);
-						m_APRSReadCallback(std::string(line));
-					}
+			if (!m_connected || m_exit)
+				continue;
+
+			// Sleep until there is a packet to send or a line from the server
+			if (waitForEvent(0U)) {
+				std::string line;
+				int length = m_socket.readLine(line, APRS_TIMEOUT);
+
+				if (length < 0) {
+					m_connected = false;
+					m_socket.close();
+					LogError("Error when reading from the APRS server");
 				}
 
+				if(length > 0 && line.at(0U) != '#'//check if we have something and if that something is an APRS frame
+				    && m_APRSReadCallback != NULL)//do we have someone wanting an APRS Frame?
+				{	
+					//wxLogMessage(wxT("Received APRS Frame : ") + line);
+					m_APRSReadCallback(std::string(line));
+				}
 			}
 		}
 
 		if (m_connected)
 			m_socket.close();
-
-		while (!m_queue.isEmpty()) {
-			char* p = NULL;
-			m_queue.getData(&p, 1U);
-			delete[] p;
-		}
 	}
 	catch (std::exception& e) {
 		LogError("Exception raised in the APRS Writer thread - \"%s\"", e.what());
@@ -162,6 +231,8 @@ void CAPRSWriterThread::entry()
 		LogError("Unknown exception raised in the APRS Writer thread");
 	}
 
+	LogMessage("APRS Writer, %u packets sent, %u dropped, %u rate limited, %u still queued", getSent(), getDropped(), getLimited(), getQueued());
+
 	LogMessage("Stopping the APRS Writer thread");
 }
 
@@ -174,15 +245,144 @@ void CAPRSWriterThread::write(const char* data)
 {
 	assert(data != NULL);
 
-	if (!m_connected)
+	unsigned int len = ::strlen(data);
+	if (len >= APRS_MESSAGE_LENGTH - 2U) {
+		LogWarning("APRS packet of %u bytes is too long, dropped", len);
 		return;
+	}
 
-	unsigned int len = ::strlen(data);
+	std::string source(data, ::strcspn(data, ">"));
+	time_t now = ::time(NULL);
+
+	m_mutex.lock();
+
+	std::unordered_map<std::string, time_t>::iterator it = m_lastPacket.find(source);
+	if (it != m_lastPacket.end() && now >= it->second && now - it->second < time_t(APRS_RATE_LIMIT)) {
+		m_limited++;
+		m_mutex.unlock();
+		return;
+	}
 
-	char* p = new char[len + 5U];
-	::strcpy(p, data);
+	// Forget the sources that are no longer being limited
+	if (m_lastPacket.size() >= 100U) {
+		for (it = m_lastPacket.begin(); it != m_lastPacket.end();) {
+			if (now < it->second || now - it->second >= time_t(APRS_RATE_LIMIT))
+				it = m_lastPacket.erase(it);
+			else
+				++it;
+		}
+	}
+
+	m_lastPacket[source] = now;
+
+	if (m_count == APRS_QUEUE_LENGTH) {
+		m_head = (m_head + 1U) % APRS_QUEUE_LENGTH;
+		m_count--;
+		m_dropped++;
+	}
 
-	m_queue.addData(&p, 1U);
+	unsigned int slot = (m_head + m_count) % APRS_QUEUE_LENGTH;
+	::memcpy(m_slots + slot * APRS_MESSAGE_LENGTH, data, len + 1U);
+	m_count++;
+
+	m_mutex.unlock();
+
+	wakeUp();
+}
+
+bool CAPRSWriterThread::getPacket(char* data)
+{
+	assert(data != NULL);
+
+	m_mutex.lock();
+
+	if (m_count == 0U) {
+		m_mutex.unlock();
+		return false;
+	}
+
+	::strcpy(data, m_slots + m_head * APRS_MESSAGE_LENGTH);
+	m_head = (m_head + 1U) % APRS_QUEUE_LENGTH;
+	m_count--;
+
+	m_mutex.unlock();
+
+	return true;
+}
+
+// Waits for a wake up or, when connected, for a line from the server. With no
+// timeout it waits for as long as it takes. Returns true when there is a line to read.
+bool CAPRSWriterThread::waitForEvent(unsigned int ms)
+{
+	int fd = m_connected ? m_socket.getFd() : -1;
+
+#if defined(_WIN32) || defined(_WIN64)
+	if (ms == 0U || ms > 100U)
+		ms = 100U;
+
+	if (fd == -1) {
+		sleep(ms);
+		return false;
+	}
+
+	fd_set readFds;
+	FD_ZERO(&readFds);
+	FD_SET((unsigned int)fd, &readFds);
+
+	timeval tv;
+	tv.tv_sec  = 0;
+	tv.tv_usec = ms * 1000;
+
+	if (::select(fd + 1, &readFds, NULL, NULL, &tv) <= 0)
+		return false;
+
+	return FD_ISSET((unsigned int)fd, &readFds) != 0;
+#else
+	fd_set readFds;
+	FD_ZERO(&readFds);
+
+	int max = -1;
+	if (m_wakeup[0U] != -1) {
+		FD_SET(m_wakeup[0U], &readFds);
+		max = m_wakeup[0U];
+	}
+
+	if (fd != -1) {
+		FD_SET(fd, &readFds);
+		max = std::max(max, fd);
+	}
+
+	// Without a wake up pipe the queue is checked every 100ms
+	if (m_wakeup[0U] == -1 && (ms == 0U || ms > 100U))
+		ms = 100U;
+
+	timeval tv;
+	tv.tv_sec  = ms / 1000U;
+	tv.tv_usec = (ms % 1000U) * 1000U;
+
+	int ret = ::select(max + 1, &readFds, NULL, NULL, ms == 0U ? NULL : &tv);
+	if (ret <= 0)
+		return false;
+
+	if (m_wakeup[0U] != -1 && FD_ISSET(m_wakeup[0U], &readFds)) {
+		char buffer[100U];
+		while (::read(m_wakeup[0U], buffer, 100U) > 0)
+			;
+	}
+
+	return fd != -1 && FD_ISSET(fd, &readFds);
+#endif
+}
+
+void CAPRSWriterThread::wakeUp()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_wakeup[1U] != -1) {
+		char c = 0x00;
+		ssize_t ret = ::write(m_wakeup[1U], &c, 1U);
+		(void)ret;
+	}
+#endif
 }
 
 bool CAPRSWriterThread::isConnected() const
@@ -190,10 +390,48 @@ bool CAPRSWriterThread::isConnected() const
 	return m_connected;
 }
 
+unsigned int CAPRSWriterThread::getQueued()
+{
+	m_mutex.lock();
+	unsigned int count = m_count;
+	m_mutex.unlock();
+
+	return count;
+}
+
+unsigned int CAPRSWriterThread::getSent()
+{
+	m_mutex.lock();
+	unsigned int sent = m_sent;
+	m_mutex.unlock();
+
+	return sent;
+}
+
+unsigned int CAPRSWriterThread::getDropped()
+{
+	m_mutex.lock();
+	unsigned int dropped = m_dropped;
+	m_mutex.unlock();
+
+	return dropped;
+}
+
+unsigned int CAPRSWriterThread::getLimited()
+{
+	m_mutex.lock();
+	unsigned int limited = m_limited;
+	m_mutex.unlock();
+
+	return limited;
+}
+
 void CAPRSWriterThread::stop()
 {
 	m_exit = true;
 
+	wakeUp();
+
 	wait();
 }
 
@@ -20,13 +20,17 @@
 #define	APRSWriterThread_H
 
 #include "TCPSocket.h"
-#include "RingBuffer.h"
 #include "Thread.h"
+#include "Mutex.h"
 
 #include <string>
+#include <unordered_map>
+#include <ctime>
 
 typedef void (*ReadAPRSFrameCallback)(const std::string&);
 
+// Packets are copied into a fixed set of slots and the thread is woken to send them. They are
+// kept while the server is unreachable, the oldest being dropped when the slots are all in use.
 class CAPRSWriterThread : public CThread {
 public:
 	CAPRSWriterThread(const std::string& callsign, const std::string& password, const std::string& address, unsigned int port);
@@ -45,18 +49,35 @@ public:
 
 	void setReadAPRSCallback(ReadAPRSFrameCallback cb);
 
+	unsigned int getQueued();
+	unsigned int getSent();
+	unsigned int getDropped();
+	unsigned int getLimited();
+
 private:
 	std::string            m_username;
 	std::string            m_password;
 	CTCPSocket             m_socket;
-	CRingBuffer<char*>     m_queue;
+	char*                  m_slots;
+	unsigned int           m_head;
+	unsigned int           m_count;
+	CMutex                 m_mutex;
+	int                    m_wakeup[2U];
+	std::unordered_map<std::string, time_t> m_lastPacket;
+	unsigned int           m_sent;
+	unsigned int           m_dropped;
+	unsigned int           m_limited;
 	bool                   m_exit;
 	bool                   m_connected;
 	ReadAPRSFrameCallback  m_APRSReadCallback;
 	std::string            m_filter;
 	std::string            m_clientName;
 
+	void init();
 	bool connect();
+	bool getPacket(char* data);
+	bool waitForEvent(unsigned int ms);
+	void wakeUp();
 };
 
 #endif
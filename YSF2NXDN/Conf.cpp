@@ -58,6 +58,7 @@ m_fichSQLCode(0U),
 m_ysfDT1(),
 m_ysfDT2(),
 m_ysfRadioID("*****"),
+m_ysfSettings(),
 m_daemon(false),
 m_rxFrequency(0U),
 m_txFrequency(0U),
@@ -84,6 +85,8 @@ m_aprsServer(),
 m_aprsPort(0U),
 m_aprsPassword(),
 m_aprsAPIKey(),
+m_aprsAPIServer("api.aprs.fi"),
+m_aprsAPIPort(80U),
 m_aprsRefresh(120),
 m_aprsDescription()
 {
@@ -248,6 +251,10 @@ bool CConf::read()
 			m_aprsPassword = value;
 		else if (::strcmp(key, "APIKey") == 0)
 			m_aprsAPIKey = value;
+		else if (::strcmp(key, "APIServer") == 0)
+			m_aprsAPIServer = value;
+		else if (::strcmp(key, "APIPort") == 0)
+			m_aprsAPIPort = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "Refresh") == 0)
 			m_aprsRefresh = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "Description") == 0)
@@ -257,6 +264,8 @@ bool CConf::read()
 
   ::fclose(fp);
 
+  setYSFSettings();
+
   return true;
 }
 
@@ -385,6 +394,35 @@ std::string CConf::getYsfRadioID()
   	return m_ysfRadioID;
 }
 
+const CYSFSettings& CConf::getYSFSettings() const
+{
+	return m_ysfSettings;
+}
+
+void CConf::setYSFSettings()
+{
+	m_ysfSettings.m_callSign     = m_fichCallSign;
+	m_ysfSettings.m_callMode     = m_fichCallMode;
+	m_ysfSettings.m_frameTotal   = m_fichFrameTotal;
+	m_ysfSettings.m_messageRoute = m_fichMessageRoute;
+	m_ysfSettings.m_voip         = m_fichVOIP != 0U;
+	m_ysfSettings.m_dataType     = m_fichDataType;
+	m_ysfSettings.m_sql          = m_fichSQLType != 0U;
+	m_ysfSettings.m_sqlCode      = m_fichSQLCode;
+
+	::memset(m_ysfSettings.m_radioID, ' ', 5U);
+	for (unsigned int i = 0U; i < m_ysfRadioID.size() && i < 5U; i++)
+		m_ysfSettings.m_radioID[i] = m_ysfRadioID[i];
+
+	::memset(m_ysfSettings.m_dt1, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT1.size() && i < 10U; i++)
+		m_ysfSettings.m_dt1[i] = m_ysfDT1[i];
+
+	::memset(m_ysfSettings.m_dt2, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT2.size() && i < 10U; i++)
+		m_ysfSettings.m_dt2[i] = m_ysfDT2[i];
+}
+
 bool CConf::getDaemon() const
 {
 	return m_daemon;
@@ -485,6 +523,16 @@ std::string CConf::getAPRSAPIKey() const
 	return m_aprsAPIKey;
 }
 
+std::string CConf::getAPRSAPIServer() const
+{
+	return m_aprsAPIServer;
+}
+
+unsigned int CConf::getAPRSAPIPort() const
+{
+	return m_aprsAPIPort;
+}
+
 unsigned int CConf::getAPRSRefresh() const
 {
 	return m_aprsRefresh;
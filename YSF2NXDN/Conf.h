@@ -23,6 +23,22 @@
 #include <string>
 #include <vector>
 
+// The YSF settings used by the per-frame code, typed and padded as they go on air. It is
+// copied out of the file by read(), so the frames are built without strings being made.
+struct CYSFSettings {
+  unsigned char m_callSign;
+  unsigned char m_callMode;
+  unsigned char m_frameTotal;
+  unsigned char m_messageRoute;
+  bool          m_voip;
+  unsigned char m_dataType;
+  bool          m_sql;
+  unsigned char m_sqlCode;
+  unsigned char m_radioID[5U];
+  unsigned char m_dt1[10U];
+  unsigned char m_dt2[10U];
+};
+
 class CConf
 {
 public:
@@ -59,6 +75,7 @@ public:
   std::vector<unsigned char> getYsfDT1();
   std::vector<unsigned char> getYsfDT2();
   std::string  getYsfRadioID();
+  const CYSFSettings& getYSFSettings() const;
   bool         getDaemon() const;
 
   // The NXDN Network section
@@ -87,6 +104,8 @@ public:
   unsigned int getAPRSPort() const;
   std::string  getAPRSPassword() const;
   std::string  getAPRSAPIKey() const;
+  std::string  getAPRSAPIServer() const;
+  unsigned int getAPRSAPIPort() const;
   unsigned int getAPRSRefresh() const;  
   std::string  getAPRSDescription() const;  
 
@@ -112,6 +131,7 @@ private:
   std::vector<unsigned char> m_ysfDT1;
   std::vector<unsigned char> m_ysfDT2;
   std::string  m_ysfRadioID;
+  CYSFSettings  m_ysfSettings;
   bool         m_daemon;
 
   unsigned int m_rxFrequency;
@@ -143,9 +163,13 @@ private:
   unsigned int m_aprsPort;
   std::string  m_aprsPassword;
   std::string  m_aprsAPIKey;
+  std::string  m_aprsAPIServer;
+  unsigned int m_aprsAPIPort;
   unsigned int m_aprsRefresh;
   std::string  m_aprsDescription;
 
+
+  void setYSFSettings();
 };
 
 #endif
@@ -0,0 +1,135 @@
+/*
+ *   Copyright (C) 2026 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "FileWatcher.h"
+#include "Log.h"
+
+#include <cstring>
+#include <cerrno>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+
+CFileWatcher::CFileWatcher(const std::string& filename) :
+m_directory("."),
+m_name(filename),
+m_fd(-1),
+m_wd(-1)
+{
+	std::string::size_type pos = filename.find_last_of('/');
+	if (pos != std::string::npos) {
+		m_directory = pos == 0U ? std::string("/") : filename.substr(0U, pos);
+		m_name      = filename.substr(pos + 1U);
+	}
+}
+
+CFileWatcher::~CFileWatcher()
+{
+	close();
+}
+
+bool CFileWatcher::open()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return false;
+#else
+	m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd < 0) {
+		LogWarning("Cannot watch %s/%s for changes, errno=%d", m_directory.c_str(), m_name.c_str(), errno);
+		return false;
+	}
+
+	// IN_CLOSE_WRITE for a file rewritten in place, IN_MOVED_TO for one renamed over the old one
+	m_wd = ::inotify_add_watch(m_fd, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (m_wd < 0) {
+		LogWarning("Cannot watch %s/%s for changes, errno=%d", m_directory.c_str(), m_name.c_str(), errno);
+		close();
+		return false;
+	}
+
+	return true;
+#endif
+}
+
+bool CFileWatcher::isOpen() const
+{
+	return m_fd >= 0;
+}
+
+bool CFileWatcher::hasChanged()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return false;
+#else
+	if (m_fd < 0)
+		return false;
+
+	bool changed = false;
+
+	char buffer[4096U] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	for (;;) {
+		ssize_t len = ::read(m_fd, buffer, sizeof(buffer));
+		if (len <= 0)
+			break;
+
+		for (char* p = buffer; p < buffer + len; ) {
+			const struct inotify_event* event = (const struct inotify_event*)p;
+			if (event->len > 0U && m_name == event->name)
+				changed = true;
+
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+
+	return changed;
+#endif
+}
+
+bool CFileWatcher::wait(unsigned int ms)
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return false;
+#else
+	if (m_fd < 0)
+		return false;
+
+	struct pollfd pfd;
+	pfd.fd      = m_fd;
+	pfd.events  = POLLIN;
+	pfd.revents = 0;
+
+	if (::poll(&pfd, 1, int(ms)) <= 0)
+		return false;
+
+	return hasChanged();
+#endif
+}
+
+void CFileWatcher::close()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_fd >= 0)
+		::close(m_fd);
+#endif
+
+	m_fd = -1;
+	m_wd = -1;
+}
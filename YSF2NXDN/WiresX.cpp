@@ -27,6 +27,7 @@
 #include "Log.h"
 
 #include <algorithm>
+#include <unordered_map>
 #include <functional>
 #include <cstdio>
 #include <cstdlib>
@@ -49,6 +50,8 @@ const unsigned char DEFAULT_FICH[] = {0x20U, 0x00U, 0x01U, 0x00U};
 
 const unsigned char NET_HEADER[] = "YSFD                    ALL      ";
 
+const unsigned int WIRESX_REPLY_CACHE = 64U;
+
 CWiresX::CWiresX(const std::string& callsign, const std::string& suffix, CYSFNetwork* network, std::string tgfile, bool makeUpper) :
 m_callsign(callsign),
 m_node(),
@@ -70,7 +73,12 @@ m_start(0U),
 m_search(),
 m_category(),
 m_makeUpper(makeUpper),
-m_bufferTX(10000U, "YSF Wires-X TX Buffer")
+m_tgFile(tgfile),
+m_watcher(tgfile),
+m_watchTimer(1000U, 1U),
+m_reload(false),
+m_bufferTX(10000U, "YSF Wires-X TX Buffer"),
+m_replies()
 {
 	assert(network != NULL);
 
@@ -90,51 +98,20 @@ m_bufferTX(10000U, "YSF Wires-X TX Buffer")
 	m_csd2   = new unsigned char[20U];
 	m_csd3   = new unsigned char[20U];
 
-	// Load file with TG List
-	FILE* fp = ::fopen(tgfile.c_str(), "rt");
-	if (fp != NULL) {
-		char buffer[100U];
-		while (::fgets(buffer, 100U, fp) != NULL) {
-			if (buffer[0U] == '#')
-				continue;
-
-			char* p1 = ::strtok(buffer, ";\r\n");
-			char* p2 = ::strtok(NULL, ";\r\n");
-			char* p3 = ::strtok(NULL, "\r\n");
-
-			if (p1 != NULL && p2 != NULL && p3 != NULL) {
-				CTGReg* tgreg = new CTGReg;
-
-				std::string id_tmp = std::string(p1);
-
-				int n_zero = 7 - id_tmp.length();
-				if (n_zero < 0)
-					n_zero = 0;
-
-				tgreg->m_id = std::string(n_zero, '0') + id_tmp;
-				tgreg->m_name = std::string(p2);
-				tgreg->m_desc = std::string(p3);
-
-				if (m_makeUpper) {
-					std::transform(tgreg->m_name.begin(), tgreg->m_name.end(), tgreg->m_name.begin(), ::toupper);
-					std::transform(tgreg->m_desc.begin(), tgreg->m_desc.end(), tgreg->m_desc.begin(), ::toupper);
-				}
+	loadTGList();
 
-				tgreg->m_name.resize(16U, ' ');
-				tgreg->m_desc.resize(14U, ' ');
-
-				m_currTGList.push_back(tgreg);
-			}
-		}
-
-		::fclose(fp);
-	}
+	// An edited TG list is picked up without a restart
+	if (m_watcher.open())
+		m_watchTimer.start();
 
 	m_txWatch.start();
 }
 
 CWiresX::~CWiresX()
 {
+	for (std::vector<CTGReg*>::iterator it = m_currTGList.begin(); it != m_currTGList.end(); ++it)
+		delete *it;
+
 	delete[] m_csd3;
 	delete[] m_csd2;
 	delete[] m_csd1;
@@ -197,6 +174,8 @@ void CWiresX::setInfo(const std::string& name, unsigned int txFrequency, unsigne
 
 	for (unsigned int i = 0U; i < 10U; i++)
 		m_header[i + 14U] = m_node.at(i);
+
+	m_replies.clear();
 }
 
 
@@ -384,6 +363,20 @@ void CWiresX::clock(unsigned int ms)
 {
 	unsigned char buffer[200U];
 
+	m_watchTimer.clock(ms);
+	if (m_watchTimer.isRunning() && m_watchTimer.hasExpired()) {
+		if (m_watcher.hasChanged())
+			m_reload = true;
+		m_watchTimer.start();
+	}
+
+	// The pending replies point into the TG list, so it is only reloaded between them
+	if (m_reload && !m_timer.isRunning()) {
+		loadTGList();
+		m_category.clear();
+		m_reload = false;
+	}
+
 	m_timer.clock(ms);
 	if (m_timer.isRunning() && m_timer.hasExpired()) {
 		switch (m_status) {
@@ -426,11 +419,25 @@ void CWiresX::clock(unsigned int ms)
 	}
 }
 
-void CWiresX::createReply(const unsigned char* data, unsigned int length)
+// The frames of a reply depend only on its length and on the part of the data that each one
+// carries. A reply that was sent before is copied from the cache, and only the frames whose
+// data has changed, such as the ones holding the sequence number and the CRC, are encoded again.
+void CWiresX::createReply(const unsigned char* data, unsigned int length, const std::string& key)
 {
 	assert(data != NULL);
 	assert(length > 0U);
 
+	if (m_replies.size() >= WIRESX_REPLY_CACHE && m_replies.count(key) == 0U)
+		m_replies.clear();
+
+	CWiresXReply& reply = m_replies[key];
+	bool cached = reply.m_length == length;
+
+	if (!cached) {
+		reply.m_length = length;
+		reply.m_frames.clear();
+	}
+
 	unsigned char bt = 0U;
 
 	if (length > 260U) {
@@ -451,26 +458,37 @@ void CWiresX::createReply(const unsigned char* data, unsigned int length)
 	unsigned char ft = calculateFT(length, 0U);
 
 	unsigned char seqNo = 0U;
+	unsigned int frame = 0U;
 
 	// Write the header
 	unsigned char buffer[200U];
-	::memcpy(buffer, m_header, 34U);
-
-	CSync::addYSFSync(buffer + 35U);
 
 	CYSFFICH fich;
 	fich.load(DEFAULT_FICH);
 	fich.setFI(YSF_FI_HEADER);
 	fich.setBT(bt);
 	fich.setFT(ft);
-	fich.encode(buffer + 35U);
 
 	CYSFPayload payload;
-	payload.writeDataFRModeData1(m_csd1, buffer + 35U);
-	payload.writeDataFRModeData2(m_csd2, buffer + 35U);
+
+	if (cached) {
+		::memcpy(buffer, &reply.m_frames[0U], 155U);
+	} else {
+		::memcpy(buffer, m_header, 34U);
+
+		CSync::addYSFSync(buffer + 35U);
+
+		fich.encode(buffer + 35U);
+
+		payload.writeDataFRModeData1(m_csd1, buffer + 35U);
+		payload.writeDataFRModeData2(m_csd2, buffer + 35U);
+
+		reply.m_frames.insert(reply.m_frames.end(), buffer, buffer + 155U);
+	}
 
 	buffer[34U] = seqNo;
 	seqNo += 2U;
+	frame++;
 
 	writeData(buffer);
 
@@ -481,43 +499,60 @@ void CWiresX::createReply(const unsigned char* data, unsigned int length)
 
 	unsigned int offset = 0U;
 	while (offset < length) {
-		switch (fn) {
-		case 0U: {
-				ft = calculateFT(length, offset);
+		unsigned int used = 0U;
+		if (fn == 0U)
+			ft = calculateFT(length, offset);
+		else if (fn == 1U)
+			used = bn == 0U ? 20U : 19U;
+		else
+			used = 40U;
+
+		if (cached && ::memcmp(data + offset, reply.m_data.data() + offset, used) == 0) {
+			::memcpy(buffer, &reply.m_frames[frame * 155U], 155U);
+			offset += used;
+		} else {
+			switch (fn) {
+			case 0U:
 				payload.writeDataFRModeData1(m_csd1, buffer + 35U);
 				payload.writeDataFRModeData2(m_csd2, buffer + 35U);
-			}
-			break;
-		case 1U:
-			payload.writeDataFRModeData1(m_csd3, buffer + 35U);
-			if (bn == 0U) {
+				break;
+			case 1U:
+				payload.writeDataFRModeData1(m_csd3, buffer + 35U);
+				if (bn == 0U) {
+					payload.writeDataFRModeData2(data + offset, buffer + 35U);
+					offset += 20U;
+				} else {
+					// All subsequent entries start with 0x00U
+					unsigned char temp[20U];
+					::memcpy(temp + 1U, data + offset, 19U);
+					temp[0U] = 0x00U;
+					payload.writeDataFRModeData2(temp, buffer + 35U);
+					offset += 19U;
+				}
+				break;
+			default:
+				payload.writeDataFRModeData1(data + offset, buffer + 35U);
+				offset += 20U;
 				payload.writeDataFRModeData2(data + offset, buffer + 35U);
 				offset += 20U;
-			} else {
-				// All subsequent entries start with 0x00U
-				unsigned char temp[20U];
-				::memcpy(temp + 1U, data + offset, 19U);
-				temp[0U] = 0x00U;
-				payload.writeDataFRModeData2(temp, buffer + 35U);
-				offset += 19U;
+				break;
 			}
-			break;
-		default:
-			payload.writeDataFRModeData1(data + offset, buffer + 35U);
-			offset += 20U;
-			payload.writeDataFRModeData2(data + offset, buffer + 35U);
-			offset += 20U;
-			break;
-		}
 
-		fich.setFT(ft);
-		fich.setFN(fn);
-		fich.setBT(bt);
-		fich.setBN(bn);
-		fich.encode(buffer + 35U);
+			fich.setFT(ft);
+			fich.setFN(fn);
+			fich.setBT(bt);
+			fich.setBN(bn);
+			fich.encode(buffer + 35U);
+
+			if (cached)
+				::memcpy(&reply.m_frames[frame * 155U], buffer, 155U);
+			else
+				reply.m_frames.insert(reply.m_frames.end(), buffer, buffer + 155U);
+		}
 
 		buffer[34U] = seqNo;
 		seqNo += 2U;
+		frame++;
 
 		writeData(buffer);
 
@@ -529,17 +564,25 @@ void CWiresX::createReply(const unsigned char* data, unsigned int length)
 	}
 
 	// Write the trailer
-	fich.setFI(YSF_FI_TERMINATOR);
-	fich.setFN(fn);
-	fich.setBN(bn);
-	fich.encode(buffer + 35U);
+	if (cached) {
+		::memcpy(buffer, &reply.m_frames[frame * 155U], 155U);
+	} else {
+		fich.setFI(YSF_FI_TERMINATOR);
+		fich.setFN(fn);
+		fich.setBN(bn);
+		fich.encode(buffer + 35U);
 
-	payload.writeDataFRModeData1(m_csd1, buffer + 35U);
-	payload.writeDataFRModeData2(m_csd2, buffer + 35U);
+		payload.writeDataFRModeData1(m_csd1, buffer + 35U);
+		payload.writeDataFRModeData2(m_csd2, buffer + 35U);
+
+		reply.m_frames.insert(reply.m_frames.end(), buffer, buffer + 155U);
+	}
 
 	buffer[34U] = seqNo | 0x01U;
 
 	writeData(buffer);
+
+	reply.m_data.assign(data, data + offset);
 }
 
 void CWiresX::writeData(const unsigned char* buffer)
@@ -646,7 +689,7 @@ void CWiresX::sendDXReply()
 
 	//CUtils::dump(1U, "DX Reply", data, 129U);
 
-	createReply(data, 129U);
+	createReply(data, 129U, "DX");
 
 	m_seqNo++;
 }
@@ -705,7 +748,7 @@ void CWiresX::sendConnectReply()
 
 	//CUtils::dump(1U, "CONNECT Reply", data, 91U);
 
-	createReply(data, 91U);
+	createReply(data, 91U, "CONNECT");
 
 	m_seqNo++;
 }
@@ -742,7 +785,7 @@ void CWiresX::sendDisconnectReply()
 
 	//CUtils::dump(1U, "DISCONNECT Reply", data, 91U);
 
-	createReply(data, 91U);
+	createReply(data, 91U, "DISCONNECT");
 
 	m_seqNo++;
 }
@@ -813,7 +856,10 @@ void CWiresX::sendAllReply()
 
 	//CUtils::dump(1U, "ALL Reply", data, offset + 2U);
 
-	createReply(data, offset + 2U);
+	char key[10U];
+	::sprintf(key, "ALL%03u", m_start);
+
+	createReply(data, offset + 2U, key);
 
 	m_seqNo++;
 }
@@ -900,7 +946,10 @@ void CWiresX::sendSearchReply()
 
 	//CUtils::dump(1U, "SEARCH Reply", data, offset + 2U);
 
-	createReply(data, offset + 2U);
+	char key[30U];
+	::sprintf(key, "SEARCH%03u%16.16s", m_start, m_search.c_str());
+
+	createReply(data, offset + 2U, key);
 
 	m_seqNo++;
 }
@@ -922,14 +971,137 @@ static bool refComparison(const CTGReg* r1, const CTGReg* r2)
 	return false;
 }
 
-CTGReg* CWiresX::findById(unsigned int id)
+// Compares the start of a name with upper case search text, in the order used by refComparison
+static int comparePrefix(const CTGReg* r, const std::string& prefix)
 {
-	for (std::vector<CTGReg*>::const_iterator it = m_currTGList.cbegin(); it != m_currTGList.cend(); ++it) {
-		if (id == (unsigned int)atoi((*it)->m_id.c_str()))
-			return *it;
+	assert(r != NULL);
+
+	for (unsigned int i = 0U; i < prefix.size(); i++) {
+		int c = ::toupper(r->m_name.at(i)) - prefix.at(i);
+		if (c != 0)
+			return c;
 	}
 
-	return NULL;
+	return 0;
+}
+
+static bool prefixLess(const CTGReg* r, const std::string& prefix)
+{
+	return comparePrefix(r, prefix) < 0;
+}
+
+static bool prefixGreater(const std::string& prefix, const CTGReg* r)
+{
+	return comparePrefix(r, prefix) > 0;
+}
+
+// Entries still in the file are updated in place and keep their place in the list, so a
+// reload only touches the TGs that were added, removed or changed
+void CWiresX::loadTGList()
+{
+	FILE* fp = ::fopen(m_tgFile.c_str(), "rt");
+	if (fp == NULL)
+		return;
+
+	std::unordered_multimap<std::string, CTGReg*> current;
+	for (std::vector<CTGReg*>::const_iterator it = m_currTGList.begin(); it != m_currTGList.end(); ++it)
+		current.insert(std::make_pair((*it)->m_id, *it));
+
+	bool initial = m_currTGList.empty();
+
+	unsigned int added   = 0U;
+	unsigned int changed = 0U;
+
+	std::vector<CTGReg*> list;
+
+	char buffer[100U];
+	while (::fgets(buffer, 100U, fp) != NULL) {
+		if (buffer[0U] == '#')
+			continue;
+
+		char* p1 = ::strtok(buffer, ";\r\n");
+		char* p2 = ::strtok(NULL, ";\r\n");
+		char* p3 = ::strtok(NULL, "\r\n");
+
+		if (p1 != NULL && p2 != NULL && p3 != NULL) {
+			std::string id_tmp = std::string(p1);
+
+			int n_zero = 7 - id_tmp.length();
+			if (n_zero < 0)
+				n_zero = 0;
+
+			CTGReg entry;
+			entry.m_id = std::string(n_zero, '0') + id_tmp;
+			entry.m_name = std::string(p2);
+			entry.m_desc = std::string(p3);
+
+			if (m_makeUpper) {
+				std::transform(entry.m_name.begin(), entry.m_name.end(), entry.m_name.begin(), ::toupper);
+				std::transform(entry.m_desc.begin(), entry.m_desc.end(), entry.m_desc.begin(), ::toupper);
+			}
+
+			entry.m_name.resize(16U, ' ');
+			entry.m_desc.resize(14U, ' ');
+
+			CTGReg* tgreg = NULL;
+
+			std::unordered_multimap<std::string, CTGReg*>::iterator it = current.find(entry.m_id);
+			if (it != current.end()) {
+				tgreg = it->second;
+				current.erase(it);
+
+				if (tgreg->m_name != entry.m_name || tgreg->m_desc != entry.m_desc) {
+					*tgreg = entry;
+					changed++;
+				}
+			} else {
+				tgreg = new CTGReg(entry);
+				added++;
+			}
+
+			list.push_back(tgreg);
+		}
+	}
+
+	::fclose(fp);
+
+	for (std::unordered_multimap<std::string, CTGReg*>::iterator it = current.begin(); it != current.end(); ++it)
+		delete it->second;
+
+	unsigned int removed = (unsigned int)current.size();
+
+	m_currTGList.swap(list);
+
+	indexTGList();
+
+	// The cached replies were built from the old list
+	m_replies.clear();
+
+	if (!initial && (added > 0U || removed > 0U || changed > 0U))
+		LogInfo("Updated the TG list, %u TGs, %u added, %u removed, %u changed", (unsigned int)m_currTGList.size(), added, removed, changed);
+}
+
+// Rebuilt whenever the TG list is loaded, so that a lookup or a search does not walk the list
+void CWiresX::indexTGList()
+{
+	m_idIndex.clear();
+
+	for (std::vector<CTGReg*>::const_iterator it = m_currTGList.begin(); it != m_currTGList.end(); ++it) {
+		// The first entry for an Id is the one that is found
+		m_idIndex.insert(std::make_pair((unsigned int)atoi((*it)->m_id.c_str()), *it));
+	}
+
+	m_nameIndex = m_currTGList;
+	std::stable_sort(m_nameIndex.begin(), m_nameIndex.end(), refComparison);
+}
+
+CTGReg* CWiresX::findById(unsigned int id)
+{
+	std::unordered_map<unsigned int, CTGReg*>::const_iterator it = m_idIndex.find(id);
+	if (it == m_idIndex.end())
+		return NULL;
+
+	return it->second;
 }
 
 std::vector<CTGReg*>& CWiresX::TGSearch(const std::string& name)
@@ -940,18 +1112,15 @@ std::vector<CTGReg*>& CWiresX::TGSearch(const std::string& name)
 	trimmed.erase(std::find_if(trimmed.rbegin(), trimmed.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), trimmed.end());
 	std::transform(trimmed.begin(), trimmed.end(), trimmed.begin(), ::toupper);
 
-	unsigned int len = trimmed.size();
+	// The names are no longer than 16 characters
+	if (trimmed.size() > 16U)
+		return m_TGSearch;
 
-	for (std::vector<CTGReg*>::iterator it = m_currTGList.begin(); it != m_currTGList.end(); ++it) {
-		std::string tgname = (*it)->m_name;
-		tgname.erase(std::find_if(tgname.rbegin(), tgname.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), tgname.end());
-		std::transform(tgname.begin(), tgname.end(), tgname.begin(), ::toupper);
-
-		if (trimmed == tgname.substr(0U, len))
-			m_TGSearch.push_back(*it);
-	}
+	// The names starting with the text are a single run in the sorted index
+	std::vector<CTGReg*>::const_iterator first = std::lower_bound(m_nameIndex.begin(), m_nameIndex.end(), trimmed, prefixLess);
+	std::vector<CTGReg*>::const_iterator last  = std::upper_bound(first, m_nameIndex.cend(), trimmed, prefixGreater);
 
-	std::sort(m_TGSearch.begin(), m_TGSearch.end(), refComparison);
+	m_TGSearch.assign(first, last);
 
 	return m_TGSearch;
 }
@@ -989,7 +1158,7 @@ void CWiresX::sendSearchNotFoundReply()
 
 	//CUtils::dump(1U, "SEARCH Reply", data, 31U);
 
-	createReply(data, 31U);
+	createReply(data, 31U, "NOTFOUND");
 
 	m_seqNo++;
 }
@@ -1058,7 +1227,7 @@ void CWiresX::sendCategoryReply()
 
 	//CUtils::dump(1U, "CATEGORY Reply", data, offset + 2U);
 
-	createReply(data, offset + 2U);
+	createReply(data, offset + 2U, "CATEGORY");
 
 	m_seqNo++;
 }
@@ -24,11 +24,13 @@
 #include "YSFNetwork.h"
 #include "Thread.h"
 #include "Timer.h"
+#include "FileWatcher.h"
 #include "StopWatch.h"
 #include "RingBuffer.h"
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 enum WX_STATUS {
 	WXS_NONE,
@@ -63,6 +65,21 @@ public:
 	std::string  m_desc;
 };
 
+// The encoded frames of a reply and the data they were built from
+class CWiresXReply {
+public:
+	CWiresXReply() :
+	m_length(0U),
+	m_data(),
+	m_frames()
+	{
+	}
+
+	unsigned int               m_length;
+	std::vector<unsigned char> m_data;
+	std::vector<unsigned char> m_frames;
+};
+
 class CWiresX {
 public:
 	CWiresX(const std::string& callsign, const std::string& suffix, CYSFNetwork* network, std::string tgfile, bool makeUpper);
@@ -104,11 +121,18 @@ private:
 	unsigned int         m_start;
 	std::string          m_search;
 	std::vector<CTGReg*> m_currTGList;
+	std::unordered_map<unsigned int, CTGReg*> m_idIndex;
+	std::vector<CTGReg*> m_nameIndex;
 	std::vector<CTGReg*> m_TGSearch;
 	std::vector<CTGReg*> m_category;
 	bool                 m_makeUpper;
+	std::string          m_tgFile;
+	CFileWatcher         m_watcher;
+	CTimer               m_watchTimer;
+	bool                 m_reload;
 	CStopWatch           m_txWatch;
 	CRingBuffer<unsigned char> m_bufferTX;
+	std::unordered_map<std::string, CWiresXReply> m_replies;
 
 	WX_STATUS processConnect(const unsigned char* source, const unsigned char* data);
 	void processDX(const unsigned char* source);
@@ -121,7 +145,10 @@ private:
 	void sendSearchNotFoundReply();
 	void sendCategoryReply();
 
-	void createReply(const unsigned char* data, unsigned int length);
+	void loadTGList();
+	void indexTGList();
+
+	void createReply(const unsigned char* data, unsigned int length, const std::string& key);
 	void writeData(const unsigned char* data);
 	unsigned char calculateFT(unsigned int length, unsigned int offset) const;
 };
@@ -290,7 +290,7 @@ int CYSF2NXDN::run()
 
 	if (m_conf.getAPRSEnabled()) {
 		createGPS();
-		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh());
+		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh(), m_conf.getAPRSAPIServer(), m_conf.getAPRSAPIPort());
 	}
 	
 	CStopWatch TGChange;
@@ -305,6 +305,9 @@ int CYSF2NXDN::run()
 	unsigned char ysf_cnt = 0;
 	unsigned char nxdn_cnt = 0;
 
+	// Read by reference, nothing is copied out of the configuration for each frame
+	const CYSFSettings& ysf = m_conf.getYSFSettings();
+
 	LogMessage("Starting YSF2NXDN-%s", VERSION);
 
 	unsigned char gps_buffer[20U];
@@ -604,23 +607,23 @@ int CYSF2NXDN::run()
 				// Set the FICH
 				CYSFFICH fich;
 				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				unsigned char csd1[20U], csd2[20U];
 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
 				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
 				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -644,23 +647,23 @@ int CYSF2NXDN::run()
 				// Set the FICH
 				CYSFFICH fich;
                                 fich.setFI(YSF_FI_HEADER);
-                                fich.setCS(m_conf.getFICHCallSign());
-                                fich.setCM(m_conf.getFICHCallMode());
+                                fich.setCS(ysf.m_callSign);
+                                fich.setCM(ysf.m_callMode);
                                 fich.setBN(0U);
                                 fich.setBT(0U);
                                 fich.setFN(0U);
-                                fich.setFT(m_conf.getFICHFrameTotal());
+                                fich.setFT(ysf.m_frameTotal);
                                 fich.setDev(0U);
-                                fich.setMR(m_conf.getFICHMessageRoute());
-                                fich.setVoIP(m_conf.getFICHVOIP());
-                                fich.setDT(m_conf.getFICHDataType());
-                                fich.setSQL(m_conf.getFICHSQLType());
-                                fich.setSQ(m_conf.getFICHSQLCode());
+                                fich.setMR(ysf.m_messageRoute);
+                                fich.setVoIP(ysf.m_voip);
+                                fich.setDT(ysf.m_dataType);
+                                fich.setSQL(ysf.m_sql);
+                                fich.setSQ(ysf.m_sqlCode);
                                 fich.encode(m_ysfFrame + 35U);
 
                                 unsigned char csd1[20U], csd2[20U];
                                 memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
-                                memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+                                memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
                                 memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
                                 memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -687,7 +690,7 @@ int CYSF2NXDN::run()
 				switch (fn) {
 					case 0:
 						memset(dch, '*', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
  						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);
 						break;
 					case 1:
@@ -698,22 +701,14 @@ int CYSF2NXDN::run()
 						break;
 					case 5:
 						memset(dch, ' ', YSF_CALLSIGN_LENGTH/2);
- 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 						memcpy(dch + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
  						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dch);	// Rem3/4
  						break;
-					case 6: {
-							unsigned char dt1[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT1().size() && i < 10U; i++)
-								dt1[i] = m_conf.getYsfDT1()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt1);
-						}
+					case 6:
+						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, ysf.m_dt1);
 						break;
-					case 7: {
-							unsigned char dt2[10U] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
-							for (unsigned int i = 0U; i < m_conf.getYsfDT2().size() && i < 10U; i++)
-								dt2[i] = m_conf.getYsfDT2()[i];
-							ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, dt2);
-						}
+					case 7:
+						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, ysf.m_dt2);
 						break;
 					default:
 						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
@@ -721,18 +716,18 @@ int CYSF2NXDN::run()
 
 				// Set the FICH
 				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
  				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				// Net frame counter
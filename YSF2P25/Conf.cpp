@@ -57,6 +57,7 @@ m_fichSQLCode(0U),
 m_ysfDT1(),
 m_ysfDT2(),
 m_ysfRadioID("*****"),
+m_ysfSettings(),
 m_daemon(false),
 m_networkDebug(false),
 m_rxFrequency(0U),
@@ -226,6 +227,8 @@ bool CConf::read()
 
   ::fclose(fp);
 
+  setYSFSettings();
+
   return true;
 }
 
@@ -339,6 +342,35 @@ std::string CConf::getYsfRadioID()
   	return m_ysfRadioID;
 }
 
+const CYSFSettings& CConf::getYSFSettings() const
+{
+	return m_ysfSettings;
+}
+
+void CConf::setYSFSettings()
+{
+	m_ysfSettings.m_callSign     = m_fichCallSign;
+	m_ysfSettings.m_callMode     = m_fichCallMode;
+	m_ysfSettings.m_frameTotal   = m_fichFrameTotal;
+	m_ysfSettings.m_messageRoute = m_fichMessageRoute;
+	m_ysfSettings.m_voip         = m_fichVOIP != 0U;
+	m_ysfSettings.m_dataType     = m_fichDataType;
+	m_ysfSettings.m_sql          = m_fichSQLType != 0U;
+	m_ysfSettings.m_sqlCode      = m_fichSQLCode;
+
+	::memset(m_ysfSettings.m_radioID, ' ', 5U);
+	for (unsigned int i = 0U; i < m_ysfRadioID.size() && i < 5U; i++)
+		m_ysfSettings.m_radioID[i] = m_ysfRadioID[i];
+
+	::memset(m_ysfSettings.m_dt1, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT1.size() && i < 10U; i++)
+		m_ysfSettings.m_dt1[i] = m_ysfDT1[i];
+
+	::memset(m_ysfSettings.m_dt2, 0x00U, 10U);
+	for (unsigned int i = 0U; i < m_ysfDT2.size() && i < 10U; i++)
+		m_ysfSettings.m_dt2[i] = m_ysfDT2[i];
+}
+
 bool CConf::getDaemon() const
 {
 	return m_daemon;
@@ -23,6 +23,22 @@
 #include <string>
 #include <vector>
 
+// The YSF settings used by the per-frame code, typed and padded as they go on air. It is
+// copied out of the file by read(), so the frames are built without strings being made.
+struct CYSFSettings {
+  unsigned char m_callSign;
+  unsigned char m_callMode;
+  unsigned char m_frameTotal;
+  unsigned char m_messageRoute;
+  bool          m_voip;
+  unsigned char m_dataType;
+  bool          m_sql;
+  unsigned char m_sqlCode;
+  unsigned char m_radioID[5U];
+  unsigned char m_dt1[10U];
+  unsigned char m_dt2[10U];
+};
+
 class CConf
 {
 public:
@@ -56,6 +72,7 @@ public:
   std::vector<unsigned char> getYsfDT1();
   std::vector<unsigned char> getYsfDT2();
   std::string  getYsfRadioID();
+  const CYSFSettings& getYSFSettings() const;
   bool         getDaemon() const;
   bool         getNetworkDebug() const;
 
@@ -100,6 +117,7 @@ private:
   std::vector<unsigned char> m_ysfDT1;
   std::vector<unsigned char> m_ysfDT2;
   std::string  m_ysfRadioID;
+  CYSFSettings  m_ysfSettings;
   bool         m_daemon;
   bool         m_networkDebug;
 
@@ -123,6 +141,8 @@ private:
   unsigned int m_logFileLevel;
   std::string  m_logFilePath;
   std::string  m_logFileRoot;
+
+  void setYSFSettings();
 };
 
 #endif
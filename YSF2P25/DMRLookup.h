@@ -21,10 +21,51 @@
 #define	DMRLookup_H
 
 #include "Thread.h"
-#include "Mutex.h"
 
+#include <cstdio>
 #include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <unordered_map>
+#include <unordered_set>
+
+// The binary Id file written by DMRIdCompile, in host byte order. The records
+// are sorted by Id for a binary search, the callsigns are found through a
+// hash and displace table so that a lookup touches only a few pages.
+const char         DMRID_MAGIC[]     = "DMRID01";
+const unsigned int DMRID_MAGIC_LENGTH = 8U;
+const unsigned int DMRID_EMPTY        = 0xFFFFFFFFU;
+
+struct CDMRIdHeader {
+	char         m_magic[DMRID_MAGIC_LENGTH];
+	unsigned int m_records;
+	unsigned int m_buckets;
+	unsigned int m_slots;
+	unsigned int m_recordOffset;
+	unsigned int m_bucketOffset;
+	unsigned int m_slotOffset;
+	unsigned int m_stringOffset;
+	unsigned int m_stringLength;
+};
+
+struct CDMRIdRecord {
+	unsigned int m_id;
+	unsigned int m_callsign;		// Offset into the string area, DMRID_EMPTY for an unused slot
+};
+
+// FNV-1a, the seed selects one of a family of hash functions
+inline unsigned int DMRIdHash(const char* text, unsigned int seed)
+{
+	unsigned int hash = 2166136261U ^ (seed * 16777619U);
+
+	for (; *text != 0x00; text++) {
+		hash ^= (unsigned char)*text;
+		hash *= 16777619U;
+	}
+
+	return hash ^ (hash >> 15);
+}
 
 class CDMRLookup : public CThread {
 public:
@@ -43,14 +84,66 @@ public:
 	void stop();
 
 private:
-	std::string                                   m_filename;
-	unsigned int                                  m_reloadTime;
-	std::unordered_map<unsigned int, std::string> m_table;
-	std::unordered_map<std::string, unsigned int> m_cstable;
-	CMutex                                        m_mutex;
-	bool                                          m_stop;
+	// A complete table is built by load() and then published, it is never modified once readers can see it.
+	// It holds either the parsed text file or a read only mapping of a binary Id file. When a reload
+	// of the text file changes only a few entries the new table holds just those changes, on top of
+	// the unchanged base table that it shares with the previous one.
+	struct CDMRLookupTable {
+		CDMRLookupTable();
+		~CDMRLookupTable();
+
+		std::unordered_map<unsigned int, std::string> m_table;
+		std::unordered_map<std::string, unsigned int> m_cstable;
+
+		std::shared_ptr<const CDMRLookupTable> m_base;
+		std::unordered_set<unsigned int>       m_removedIds;
+		std::unordered_set<std::string>        m_removedCSs;
+		size_t                                 m_count;
+
+		void*               m_map;
+		size_t              m_mapLength;
+		const CDMRIdHeader* m_header;
+		const CDMRIdRecord* m_records;
+		const unsigned int* m_buckets;
+		const CDMRIdRecord* m_slots;
+		const char*         m_strings;
+
+		size_t size() const;
+		size_t changes() const;
+		const char* getCS(unsigned int id) const;
+		bool findCS(unsigned int id, std::string& cs) const;
+		bool findID(const std::string& cs, unsigned int& id) const;
+	};
+
+	// The text file parsed into one block of callsigns, each list holds the last entry
+	// for an Id or callsign, sorted by Id or by callsign
+	struct CDMRIdText {
+		std::vector<char>         m_strings;
+		std::vector<CDMRIdRecord> m_byId;
+		std::vector<CDMRIdRecord> m_byCS;
+	};
+
+	struct CDMRIdChanges {
+		unsigned int m_added;
+		unsigned int m_removed;
+		unsigned int m_changed;
+		unsigned int m_callsigns;		// Callsigns now pointing at another Id, or none
+	};
+
+	std::string                            m_filename;
+	unsigned int                           m_reloadTime;
+	std::shared_ptr<const CDMRLookupTable> m_tables;
+	std::atomic<unsigned int>              m_maxLookup;
+	bool                                   m_stop;
 
 	bool load();
+	bool loadText(FILE* fp, CDMRIdText& text);
+	bool loadBinary(FILE* fp, CDMRLookupTable& tables);
+	void buildTables(const CDMRIdText& text, CDMRLookupTable& tables);
+	bool updateTables(const CDMRIdText& text, const std::shared_ptr<const CDMRLookupTable>& old, CDMRLookupTable& tables, CDMRIdChanges& changes);
+
+	std::shared_ptr<const CDMRLookupTable> getTables() const;
+	void lookupTime(unsigned long long start);
 };
 
 #endif
@@ -356,6 +356,9 @@ int CYSF2P25::run()
 	unsigned char ysf_cnt = 0;
 	unsigned char p25_cnt = 0;
 
+	// Read by reference, nothing is copied out of the configuration for each frame
+	const CYSFSettings& ysf = m_conf.getYSFSettings();
+
 	LogMessage("Starting YSF2P25-%s", VERSION);
 
 	for (; end == 0;) {
@@ -620,23 +623,23 @@ int CYSF2P25::run()
 				// Set the FICH
 				CYSFFICH fich;
 				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
 				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				unsigned char csd1[20U], csd2[20U];
 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
 				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
 				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -660,23 +663,23 @@ int CYSF2P25::run()
 				// Set the FICH
 				CYSFFICH fich;
 				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
  				fich.setFN(0U);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
  				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				unsigned char csd1[20U], csd2[20U];
 				memset(csd1, '*', YSF_CALLSIGN_LENGTH/2);
- 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, m_conf.getYsfRadioID().c_str(), YSF_CALLSIGN_LENGTH/2);
+ 				memcpy(csd1 + YSF_CALLSIGN_LENGTH/2, ysf.m_radioID, YSF_CALLSIGN_LENGTH/2);
 				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
 				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
 
@@ -702,18 +705,18 @@ int CYSF2P25::run()
 
 				// Set the FICH
 				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(m_conf.getFICHCallSign());
- 				fich.setCM(m_conf.getFICHCallMode());
+				fich.setCS(ysf.m_callSign);
+ 				fich.setCM(ysf.m_callMode);
  				fich.setBN(0U);
  				fich.setBT(0U);
  				fich.setFN(fn);
-				fich.setFT(m_conf.getFICHFrameTotal());
+				fich.setFT(ysf.m_frameTotal);
 				fich.setDev(0U);
-				fich.setMR(m_conf.getFICHMessageRoute());
- 				fich.setVoIP(m_conf.getFICHVOIP());
- 				fich.setDT(m_conf.getFICHDataType());
- 				fich.setSQL(m_conf.getFICHSQLType());
- 				fich.setSQ(m_conf.getFICHSQLCode());
+				fich.setMR(ysf.m_messageRoute);
+ 				fich.setVoIP(ysf.m_voip);
+ 				fich.setDT(ysf.m_dataType);
+ 				fich.setSQL(ysf.m_sql);
+ 				fich.setSQ(ysf.m_sqlCode);
 				fich.encode(m_ysfFrame + 35U);
 
 				// Net frame counter
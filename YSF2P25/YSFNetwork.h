@@ -46,6 +46,9 @@ public:
 
 	unsigned int read(unsigned char* data);
 
+	// When the frame last returned by read() arrived, from CStopWatch::getMicroseconds()
+	unsigned long long getReceived() const;
+
 	void clock(unsigned int ms);
 
 	void close();
@@ -59,6 +62,7 @@ private:
 	unsigned char*             m_poll;
 	unsigned char*             m_unlink;
 	CRingBuffer<unsigned char> m_buffer;
+	unsigned long long         m_received;
 };
 
 #endif